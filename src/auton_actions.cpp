@@ -0,0 +1,80 @@
+#include "main.h"
+#include "auton_actions.hpp"
+#include "globals.hpp"
+#include "ramsete.hpp"
+
+// The task running the scheduler, for auton_notify
+static pros::task_t scheduler_task = nullptr;
+
+// The running auton's root task. It lives here rather than in run_auton's frame
+// so that when the task running an auton is deleted part way, the next run_auton
+// can still free its coroutine frames.
+static AutonTask root_task;
+
+void run_auton(AutonTask task) {
+    // Anything still waiting is from an auton that was cut off. Its waiters live
+    // in its frames, so drop them first, then free the frames with the old root.
+    auton_scheduler.clear();
+    root_task = std::move(task);
+    scheduler_task = pros::c::task_get_current();
+
+    std::uint32_t next_tick = pros::millis();
+    auton_scheduler.poll(next_tick, false);
+    root_task.start();
+
+    while (!root_task.done()) {
+        std::uint32_t now = pros::millis();
+        if (static_cast<std::int32_t>(next_tick - now) > 0) {
+            // Sleep until the next tick, unless auton_notify() wakes us early to recheck conditions
+            if (pros::c::task_notify_take(true, next_tick - now) > 0) {
+                auton_scheduler.poll(pros::millis(), false);
+            }
+            continue;
+        }
+
+        auton_scheduler.poll(now, true);
+
+        // Skip ticks that were missed instead of bursting through them
+        next_tick += AUTON_TICK_MS;
+        if (static_cast<std::int32_t>(now - next_tick) >= 0) next_tick = now + AUTON_TICK_MS;
+    }
+
+    root_task = AutonTask();
+    scheduler_task = nullptr;
+}
+
+void forget_auton_task(pros::task_t task) {
+    if (scheduler_task == task) scheduler_task = nullptr;
+}
+
+void auton_notify() {
+    pros::task_t task = scheduler_task;
+    if (task != nullptr) pros::c::task_notify(task);
+}
+
+AutonTask drive(double inches, DriveParams params) {
+    co_await run(DriveDistance(inches, params), "drive");
+}
+
+AutonTask drive_to(double x, double y, DriveParams params) {
+    co_await run(DriveToPoint(x, y, params), "drive_to");
+}
+
+AutonTask turn_to(double degrees, DriveParams params) {
+    co_await run(TurnToHeading(degrees, params), "turn_to");
+}
+
+AutonTask follow(const char* trajectory_name, DriveParams params) {
+    const TrajectoryTable* table = find_trajectory(trajectory_name);
+    if (table == nullptr) {
+        printf("follow: no trajectory called %s\n", trajectory_name);
+        co_return;
+    }
+    co_await run(TrajectoryTracker(*table, ramsete_gains, params), trajectory_name);
+}
+
+AutonTask intake_for(std::chrono::milliseconds time, int velocity) {
+    intake_motor.move_velocity(velocity);
+    co_await sleep(time);
+    intake_motor.move_velocity(0);
+}
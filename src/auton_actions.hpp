@@ -0,0 +1,64 @@
+#ifndef AUTON_ACTIONS_HPP
+#define AUTON_ACTIONS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include "auton_runtime.hpp"
+#include "motion.hpp"
+
+// The robot side of the auton runtime: the scheduler loop and awaitable
+// versions of the motions and mechanisms.
+
+// Scheduler tick, same as the motion control rate
+constexpr std::uint32_t AUTON_TICK_MS = 10;
+
+// Runs task in the calling task until it finishes, polling the scheduler every
+// tick. Everything the task starts runs off this one loop. If the calling task
+// is deleted part way, the next run_auton frees what the auton left behind.
+void run_auton(AutonTask task);
+
+// Wakes the scheduler before the next tick to recheck wait_until conditions.
+// Safe to call from any task, does nothing if no auton is running.
+void auton_notify();
+
+// For whoever deletes a task that might be inside run_auton (RoutineCommand),
+// so auton_notify doesn't notify a deleted task
+void forget_auton_task(pros::task_t task);
+
+// Steps a motion once per scheduler tick, then finishes it like run_motion
+// (stops the drive unless it chained, adds it to the route report).
+template <typename M>
+struct MotionAwaiter : WaiterAwaiter<MotionAwaiter<M>> {
+    MotionAwaiter(M motion, const char* label) : motion(std::move(motion)), label(label) {}
+
+    bool await_ready() { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        motion.start(robot_pose.read(), auton_scheduler.now());
+        auton_scheduler.add(*this, h);
+    }
+    MotionResult await_resume() {
+        finish_motion(motion, label);
+        return motion.result();
+    }
+    bool poll(std::uint32_t now, bool tick) override { return tick && motion.step(robot_pose.read(), now); }
+
+    M motion;
+    const char* label;
+};
+
+// co_await run(DriveToPoint(...)) gives the MotionResult
+template <typename M>
+MotionAwaiter<M> run(M motion, const char* label = nullptr) {
+    return MotionAwaiter<M>(std::move(motion), label);
+}
+
+// Task versions for all(). Params are taken by value since the task outlives the call.
+AutonTask drive(double inches, DriveParams params = default_drive_params);
+AutonTask drive_to(double x, double y, DriveParams params = default_drive_params);
+AutonTask turn_to(double degrees, DriveParams params = default_turn_params);
+AutonTask follow(const char* trajectory_name, DriveParams params = default_drive_params);
+
+// Runs the intake at velocity for the given time, then stops it
+AutonTask intake_for(std::chrono::milliseconds time, int velocity = 200);
+
+#endif
@@ -0,0 +1,110 @@
+#include <atomic>
+#include <cmath>
+#include "main.h"
+#include "auton_prewarm.hpp"
+#include "auton_select.hpp"
+#include "autons.hpp"
+#include "globals.hpp"
+#include "odometry.hpp"
+
+static PrewarmState state;
+
+const PrewarmState& prewarm_state() {
+    return state;
+}
+
+// Decodes the whole table once, so a bad table shows up now instead of mid-match
+static bool check_trajectory(const TrajectoryTable& table) {
+    TrajectoryStream stream;
+    stream.reset(table);
+    TrajectorySample sample;
+    int decoded = 0;
+    while (stream.next(sample)) {
+        if (!std::isfinite(sample.x) || !std::isfinite(sample.y) || !std::isfinite(sample.theta)) return false;
+        decoded++;
+    }
+    return decoded == table.count;
+}
+
+void prewarm_auton(int auton) {
+    std::uint32_t start = pros::millis();
+    state = PrewarmState{};
+    state.auton = auton;
+
+    const AutonEntry* entry = auton_entry(auton);
+    if (entry != nullptr && entry->trajectory != nullptr) {
+        state.trajectory = find_trajectory(entry->trajectory);
+        if (state.trajectory != nullptr) {
+            state.trajectory_ok = check_trajectory(*state.trajectory);
+        } else {
+            printf("prewarm: no trajectory called %s\n", entry->trajectory);
+        }
+    }
+
+    // Zero everything the auton measures from. Odometry works from deltas, so it
+    // gets reset to the start pose too or it would see the tare as a jump.
+    left_mg.tare_position_all();
+    right_mg.tare_position_all();
+    if (use_tracking_wheels) {
+        left_tracker.reset_position();
+        right_tracker.reset_position();
+        perp_tracker.reset_position();
+    }
+    set_odometry_pose(entry != nullptr ? entry->start : Pose{});
+    state.sensors_tared = true;
+
+    state.imu_ready = !std::isnan(imu_rotation_rad());
+    state.took_ms = pros::millis() - start;
+
+    printf("prewarm: auton %d in %lu ms, trajectory %s, imu %s\n", auton, (unsigned long)state.took_ms,
+           state.trajectory == nullptr ? "none" : (state.trajectory_ok ? "ok" : "BAD"),
+           state.imu_ready ? "ready" : "NOT READY");
+}
+
+void prewarm_while_disabled() {
+    while (true) {
+        if (state.auton != selected_auton) {
+            prewarm_auton(selected_auton);
+        } else if (!state.imu_ready && !std::isnan(imu_rotation_rad())) {
+            // Still calibrating when we prewarmed, just recheck it
+            state.imu_ready = true;
+            printf("prewarm: imu ready\n");
+        }
+        pros::delay(50);
+    }
+}
+
+// --- Enable latency ---
+
+static std::atomic<std::uint64_t> enabled_us{0};
+static std::atomic<std::uint64_t> first_command_us{0};
+
+void mark_auton_enabled() {
+    first_command_us.store(0, std::memory_order_relaxed);
+    enabled_us.store(pros::micros(), std::memory_order_release);
+}
+
+void note_motor_command() {
+    // Only the first command after enable counts
+    if (first_command_us.load(std::memory_order_relaxed) != 0) return;
+    std::uint64_t expected = 0;
+    if (enabled_us.load(std::memory_order_acquire) != 0) {
+        first_command_us.compare_exchange_strong(expected, pros::micros(), std::memory_order_relaxed);
+    }
+}
+
+std::int32_t enable_latency_us() {
+    std::uint64_t first = first_command_us.load(std::memory_order_relaxed);
+    if (first == 0) return -1;
+    return static_cast<std::int32_t>(first - enabled_us.load(std::memory_order_relaxed));
+}
+
+void print_enable_latency() {
+    std::int32_t latency = enable_latency_us();
+    if (latency < 0) {
+        printf("auton: no drive command since enable\n");
+    } else {
+        printf("auton: first drive command %.2f ms after enable%s\n", latency / 1000.0,
+               state.auton == selected_auton ? "" : " (not prewarmed)");
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef AUTON_PREWARM_HPP
+#define AUTON_PREWARM_HPP
+
+#include <cstdint>
+#include "trajectory.hpp"
+
+// Auton setup done while the robot is still disabled, so autonomous() can send
+// its first motor command straight away once the field enables it.
+
+struct PrewarmState {
+    int auton = 0;                                 // selected_auton this was done for, 0 = not yet
+    const TrajectoryTable* trajectory = nullptr;   // the auton's precompiled path, if it has one
+    bool trajectory_ok = false;                    // decoded end to end without problems
+    bool sensors_tared = false;
+    bool imu_ready = false;
+    std::uint32_t took_ms = 0;
+};
+
+// Prepares the given auton (1-based, see autons.hpp): finds and checks its trajectory,
+// tares the drive and tracking encoders (resetting odometry to its start pose)
+// and checks the IMU.
+void prewarm_auton(int auton);
+
+// Runs prewarm_auton for selected_auton, and again whenever the selection
+// changes. For competition_initialize() / disabled(), which are stopped on enable.
+[[noreturn]] void prewarm_while_disabled();
+
+const PrewarmState& prewarm_state();
+
+// Enable-to-first-command latency. mark_auton_enabled() goes first thing in
+// autonomous(), note_motor_command() wherever the drive is commanded.
+void mark_auton_enabled();
+void note_motor_command();
+// -1 if no command has been sent since the last enable
+std::int32_t enable_latency_us();
+void print_enable_latency();
+
+#endif
@@ -0,0 +1,48 @@
+#include "auton_runtime.hpp"
+
+AutonScheduler auton_scheduler;
+
+void AutonScheduler::add(Waiter& w, std::coroutine_handle<> h) {
+    w.handle = h;
+    w.next = nullptr;
+    Waiter** link = &head;
+    while (*link != nullptr) link = &(*link)->next;
+    *link = &w;
+}
+
+void AutonScheduler::poll(std::uint32_t now, bool tick) {
+    current_time = now;
+
+    // Take the ready waiters out first. Resuming a coroutine can finish it and
+    // free its waiter, or add new waiters, so the list can't be walked while resuming.
+    Waiter* ready = nullptr;
+    Waiter** ready_tail = &ready;
+    Waiter** link = &head;
+    while (*link != nullptr) {
+        Waiter* w = *link;
+        if (w->poll(now, tick)) {
+            *link = w->next;
+            w->next = nullptr;
+            *ready_tail = w;
+            ready_tail = &w->next;
+        } else {
+            link = &w->next;
+        }
+    }
+
+    while (ready != nullptr) {
+        Waiter* w = ready;
+        ready = w->next;
+        w->handle.resume();
+    }
+}
+
+int AutonScheduler::waiting() const {
+    int count = 0;
+    for (Waiter* w = head; w != nullptr; w = w->next) count++;
+    return count;
+}
+
+void AutonScheduler::clear() {
+    head = nullptr;
+}
@@ -0,0 +1,228 @@
+#ifndef AUTON_RUNTIME_HPP
+#define AUTON_RUNTIME_HPP
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+// Coroutine runtime for autons, so actions can run at the same time without
+// a pros::Task (and its stack) each:
+//
+//   AutonTask my_auton() {
+//       co_await all(drive_to(24, 0), intake_for(1s));
+//       co_await wait_until([] { return lift_motor.get_position() > 400; });
+//       co_await sleep(250ms);
+//   }
+//
+// Everything that waits registers a Waiter with the scheduler and suspends.
+// The scheduler is polled from one task (run_auton in auton_actions.hpp) once
+// per control tick and resumes whatever is ready, in the order it started waiting.
+//
+// Nothing here uses PROS: the scheduler only knows the time it is given by
+// poll(), so on the host it can be driven with a made-up clock.
+
+class AutonTask {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;  // resumed when this task finishes
+        int* join_count = nullptr;             // set by all(), continuation only runs once it hits 0
+
+        AutonTask get_return_object() {
+            return AutonTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // Lazy, nothing runs until the task is awaited or started
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                promise_type& p = h.promise();
+                if (p.join_count != nullptr && --*p.join_count != 0) return std::noop_coroutine();
+                return p.continuation ? p.continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    AutonTask() = default;
+    AutonTask(AutonTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    AutonTask& operator=(AutonTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~AutonTask() {
+        if (handle) handle.destroy();
+    }
+
+    bool done() const { return !handle || handle.done(); }
+
+    // Runs the task up to its first wait. Used for the root task.
+    void start() {
+        if (handle && !handle.done()) handle.resume();
+    }
+
+    // co_await task: runs it and carries on once it's finished
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    explicit AutonTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    template <std::size_t N>
+    friend class AllAwaiter;
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Something a suspended coroutine is waiting on. Waiters live in the awaiting
+// coroutine's frame and are linked into the scheduler's list, so waiting
+// doesn't allocate.
+class Waiter {
+public:
+    virtual ~Waiter() = default;
+
+    // True once the coroutine can carry on. tick is false on an early poll
+    // (auton_notify), where only conditions should be checked and nothing stepped.
+    virtual bool poll(std::uint32_t now, bool tick) = 0;
+
+    std::coroutine_handle<> handle;
+    Waiter* next = nullptr;
+};
+
+class AutonScheduler {
+public:
+    // Starts polling w for the coroutine h
+    void add(Waiter& w, std::coroutine_handle<> h);
+
+    // Resumes every waiter that is ready at time now (ms). Anything that starts
+    // waiting while they run is first polled on the next call.
+    void poll(std::uint32_t now, bool tick = true);
+
+    // Time of the last poll, what sleep() counts from
+    std::uint32_t now() const { return current_time; }
+    bool idle() const { return head == nullptr; }
+    int waiting() const;
+
+    // Drops everything that is waiting, without resuming it. For an abandoned
+    // auton, before its tasks are destroyed (the waiters live in their frames).
+    void clear();
+
+private:
+    Waiter* head = nullptr;
+    std::uint32_t current_time = 0;
+};
+
+extern AutonScheduler auton_scheduler;
+
+// --- Awaitables ---
+
+// Common await_* for awaiters that are a Waiter
+template <typename Derived>
+struct WaiterAwaiter : Waiter {
+    bool await_ready() { return static_cast<Derived*>(this)->poll(auton_scheduler.now(), false); }
+    void await_suspend(std::coroutine_handle<> h) { auton_scheduler.add(*this, h); }
+};
+
+struct SleepAwaiter : WaiterAwaiter<SleepAwaiter> {
+    explicit SleepAwaiter(std::uint32_t wake) : wake(wake) {}
+    bool poll(std::uint32_t now, bool) override { return static_cast<std::int32_t>(now - wake) >= 0; }
+    void await_resume() {}
+
+    std::uint32_t wake;
+};
+
+// Resumes on the first tick at least ms after the last one
+inline SleepAwaiter sleep(std::chrono::milliseconds ms) {
+    return SleepAwaiter(auton_scheduler.now() + static_cast<std::uint32_t>(ms.count()));
+}
+
+template <typename Pred>
+struct WaitUntilAwaiter : WaiterAwaiter<WaitUntilAwaiter<Pred>> {
+    WaitUntilAwaiter(Pred pred, std::uint32_t deadline, bool has_deadline)
+        : pred(std::move(pred)), deadline(deadline), has_deadline(has_deadline) {}
+
+    bool poll(std::uint32_t now, bool) override {
+        met = static_cast<bool>(pred());
+        return met || (has_deadline && static_cast<std::int32_t>(now - deadline) >= 0);
+    }
+    // True if the condition was met, false if it timed out
+    bool await_resume() { return met; }
+
+    Pred pred;
+    std::uint32_t deadline;
+    bool has_deadline;
+    bool met = false;
+};
+
+// Resumes once pred() is true, checked every tick and on auton_notify()
+template <typename Pred>
+WaitUntilAwaiter<Pred> wait_until(Pred pred) {
+    return WaitUntilAwaiter<Pred>(std::move(pred), 0, false);
+}
+
+// Same, but gives up after timeout. co_await gives false if it timed out.
+template <typename Pred>
+WaitUntilAwaiter<Pred> wait_until(Pred pred, std::chrono::milliseconds timeout) {
+    return WaitUntilAwaiter<Pred>(std::move(pred), auton_scheduler.now() + static_cast<std::uint32_t>(timeout.count()),
+                                  true);
+}
+
+// Wraps any awaitable in a task so all() can run it
+inline AutonTask as_task(AutonTask task) {
+    return task;
+}
+
+template <typename Awaitable>
+    requires(!std::is_same_v<std::remove_cvref_t<Awaitable>, AutonTask>)
+AutonTask as_task(Awaitable awaitable) {
+    co_await awaitable;
+}
+
+template <std::size_t N>
+class AllAwaiter {
+public:
+    explicit AllAwaiter(std::array<AutonTask, N> tasks) : tasks(std::move(tasks)) {}
+
+    bool await_ready() const noexcept { return N == 0; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        // One extra count held until every task has been started, so a task that
+        // finishes straight away can't resume us while we're still in here
+        remaining = N + 1;
+        for (AutonTask& task : tasks) {
+            task.handle.promise().continuation = awaiting;
+            task.handle.promise().join_count = &remaining;
+            task.handle.resume();
+        }
+        return --remaining != 0;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    std::array<AutonTask, N> tasks;
+    int remaining = 0;
+};
+
+// Runs everything at once and resumes when the last one finishes. Takes tasks
+// or anything else that can be co_awaited.
+template <typename... Ts>
+AllAwaiter<sizeof...(Ts)> all(Ts&&... items) {
+    return AllAwaiter<sizeof...(Ts)>(std::array<AutonTask, sizeof...(Ts)>{as_task(std::forward<Ts>(items))...});
+}
+
+#endif
@@ -1,12 +1,14 @@
 #include "main.h"
 #include "liblvgl/lvgl.h"
 #include "autons.hpp"
+#include "command_scheduler.hpp"
 
 // Global variable
 int selected_auton = 1; 
 
-// Track if the debug run is active so we don't start it twice
-bool is_debug_running = false;
+// The autons fill the grid first, the debug button comes right after them
+static constexpr int DEBUG_BUTTON = AUTON_COUNT;
+static_assert(AUTON_COUNT <= 7, "the selector grid has room for 7 autons plus the debug button");
 
 // Styles
 static lv_style_t style_btn_default;
@@ -15,34 +17,34 @@ static lv_style_t style_debug_default;
 static lv_style_t style_debug_checked;
 static lv_obj_t * debug_label_ptr = NULL;
 
-// --- 1. THE DEBUG AUTON TASK ---
-// This is the separate thread that runs the actual robot movement
-void debug_auton_task_fn(void* param) {
+// --- 1. THE DEBUG AUTON RUN ---
+// Runs in its own task (see DebugRunCommand below) and does the actual robot movement
+static void debug_run() {
     // Put your test code here!
     printf("Debug run started!\n");
-    switch (selected_auton) {
-        case 1: left_qual_auton();   break;
-        case 2: right_qual_auton();  break;
-        case 3: skills_auton_for_qual(); break;
-        case 4: right_qual_auton_center(); break;
-        case 5: left_qual_auton_ram(); break;
-        
-        default: 
-            // Fallback if something goes wrong
-            printf("No auton selected!\n");
-            break;
-    }
+    dispatch_auton(selected_auton);
 
     printf("Debug run finished!\n");
-    if (debug_label_ptr != NULL) {
-        lv_label_set_text(debug_label_ptr, "debug test run");
+}
+
+// The debug run takes every subsystem from driver control until it finishes,
+// then the driver commands take over again
+class DebugRunCommand : public RoutineCommand {
+public:
+    DebugRunCommand() : RoutineCommand("DebugTask", debug_run) {}
+
+    void end(bool interrupted) override {
+        RoutineCommand::end(interrupted);
+        // When finished, we need to reset the text back to "debug test run"
+        // (We accept that this part might not update the UI instantly until the next click 
+        // without complex mutexes, but it's fine for simple testing)
+        if (debug_label_ptr != NULL) {
+            lv_label_set_text(debug_label_ptr, "debug test run");
+        }
     }
+};
 
-    // When finished, we need to reset the text back to "debug test run"
-    // (We accept that this part might not update the UI instantly until the next click 
-    // without complex mutexes, but it's fine for simple testing)
-    is_debug_running = false;
-}
+static DebugRunCommand debug_command;
 
 static void auton_click_cb(lv_event_t * e) {
     lv_obj_t * clicked_btn = (lv_obj_t *)lv_event_get_target(e);
@@ -50,7 +52,7 @@ static void auton_click_cb(lv_event_t * e) {
     int btn_index = lv_obj_get_index(clicked_btn);
 
     // FIX: Only update the selected_auton if it's NOT the debug button
-    if (btn_index < 7) {
+    if (btn_index < DEBUG_BUTTON) {
         selected_auton = btn_index + 1;
     }
 
@@ -58,21 +60,24 @@ static void auton_click_cb(lv_event_t * e) {
     for(uint32_t i = 0; i < child_cnt; i++) {
         lv_obj_t * btn = lv_obj_get_child(parent, i);
         
-        // We only want to remove the checked state from the OTHER auton buttons (0-6)
+        // We only want to remove the checked state from the OTHER auton buttons
         // We keep the highlight on the auton we chose so we know what the debug button will run
-        if (btn_index < 7 && i < 7) {
+        if (btn_index < DEBUG_BUTTON && i < DEBUG_BUTTON) {
             lv_obj_remove_state(btn, LV_STATE_CHECKED);
         }
         
         lv_obj_t * label = lv_obj_get_child(btn, 0);
 
-        // Debug Button (Index 7) UI Logic
-        if (i == 7) {
-            if (btn_index == 7) {
-                lv_label_set_text(label, "running...");
-                if (!is_debug_running) {
-                    is_debug_running = true;
-                    pros::Task debug_task(debug_auton_task_fn, NULL, "DebugTask");
+        // Debug Button (after the autons) UI Logic
+        if (i == DEBUG_BUTTON) {
+            if (btn_index == DEBUG_BUTTON) {
+                // Picked up by the command scheduler on the next driver control tick,
+                // scheduling it again while it runs does nothing. Refused outside
+                // driver control, so it can't start by itself later.
+                if (command_scheduler.schedule(debug_command)) {
+                    lv_label_set_text(label, "running...");
+                } else {
+                    lv_label_set_text(label, "driver control only");
                 }
             } else {
                 lv_label_set_text(label, "debug test run");
@@ -80,8 +85,8 @@ static void auton_click_cb(lv_event_t * e) {
         }
     }
 
-    // Only visually "check" the button if it's one of the first 7
-    if (btn_index < 7) {
+    // Only visually "check" the button if it's one of the autons
+    if (btn_index < DEBUG_BUTTON) {
         lv_obj_add_state(clicked_btn, LV_STATE_CHECKED);
     }
 }
@@ -128,14 +133,15 @@ void create_auton_selector() {
     lv_obj_set_style_pad_row(cont, 8, 0);
 
     // --- Buttons ---
-    for(int i = 0; i < 8; i++) {
+    // One button per registered auton, then the debug button
+    for(int i = 0; i <= DEBUG_BUTTON; i++) {
         lv_obj_t* btn = lv_button_create(cont);
         lv_obj_set_grid_cell(btn, LV_GRID_ALIGN_STRETCH, i % 4, 1, 
                                   LV_GRID_ALIGN_STRETCH, i / 4, 1);
         
         lv_obj_add_event_cb(btn, auton_click_cb, LV_EVENT_CLICKED, NULL);
 
-        if (i == 7) { 
+        if (i == DEBUG_BUTTON) { 
             lv_obj_add_style(btn, &style_debug_default, 0);
             lv_obj_add_style(btn, &style_debug_checked, LV_STATE_CHECKED);
         } else {
@@ -151,20 +157,15 @@ void create_auton_selector() {
         lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, 0);
         lv_obj_center(label); 
 
-        if (i == 7) {
+        if (i == DEBUG_BUTTON) {
             debug_label_ptr = label; 
         }
 
-        switch (i) {
-            //change to match auton name here
-            case 0: lv_label_set_text(label, "Left Qual Auton"); break;
-            case 1: lv_label_set_text(label, "Right Qual Auton"); break;
-            case 2: lv_label_set_text(label, "Skills Auton Qual"); break;
-            case 3: lv_label_set_text(label, "Right Qual Center"); break;
-            case 4: lv_label_set_text(label, "Left Qual Ram"); break;
-            case 5: lv_label_set_text(label, "Defensive Mode"); break;
-            case 6: lv_label_set_text(label, "High Speed Mode"); break;
-            case 7: lv_label_set_text(label, "debug test run"); break;
+        // Names come from the auton registry in autons.hpp
+        if (i == DEBUG_BUTTON) {
+            lv_label_set_text(label, "debug test run");
+        } else {
+            lv_label_set_text(label, auton_registry[i].label);
         }
     }
 }
\ No newline at end of file
@@ -9,6 +9,4 @@ extern int selected_auton;
 // Declaration of the UI function
 void create_auton_selector();
 
-extern bool is_debug_running;
-
 #endif
\ No newline at end of file
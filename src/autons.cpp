@@ -0,0 +1,18 @@
+#include "main.h"
+#include "autons.hpp"
+
+const AutonEntry* auton_entry(int auton) {
+    if (auton < 1 || auton > AUTON_COUNT) return nullptr;
+    return &auton_registry[auton - 1];
+}
+
+bool dispatch_auton(int auton) {
+    const AutonEntry* entry = auton_entry(auton);
+    if (entry == nullptr) {
+        printf("No auton selected!\n");
+        return false;
+    }
+    set_odometry_pose(entry->start);
+    entry->run();
+    return true;
+}
@@ -1,6 +1,8 @@
 #ifndef AUTONS_HPP
 #define AUTONS_HPP
 
+#include "odometry.hpp"
+
 //name to the auton files in src
 void skills_auton_for_qual();
 void right_qual_auton();
@@ -8,5 +10,29 @@ void left_qual_auton();
 void right_qual_auton_center();
 void left_qual_auton_ram();
 
+// Every auton, in selector order. Adding an auton is one entry here: the selector
+// buttons, autonomous(), the debug run and the prewarm all go off this list.
+struct AutonEntry {
+    const char* label;       // selector button text
+    void (*run)();
+    Pose start;              // odometry is set to this before the auton runs
+    const char* trajectory;  // precompiled path (name in paths/) to prewarm, nullptr if none
+};
+
+inline constexpr AutonEntry auton_registry[] = {
+    {"Left Qual Auton", left_qual_auton, {0, 0, 0}, "left_qual_auton"},
+    {"Right Qual Auton", right_qual_auton, {0, 0, 0}, nullptr},
+    {"Skills Auton Qual", skills_auton_for_qual, {0, 0, 0}, nullptr},
+    {"Right Qual Center", right_qual_auton_center, {0, 0, 0}, nullptr},
+    {"Left Qual Ram", left_qual_auton_ram, {0, 0, 0}, nullptr},
+};
+
+constexpr int AUTON_COUNT = sizeof(auton_registry) / sizeof(auton_registry[0]);
+
+// Entry for an auton number (1-based, like selected_auton), nullptr if there's none
+const AutonEntry* auton_entry(int auton);
+
+// Sets the start pose and runs the auton. Returns false if there's no such auton.
+bool dispatch_auton(int auton);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,196 @@
+#include "main.h"
+#include "command_scheduler.hpp"
+#include "auton_actions.hpp"
+#include "motion.hpp"
+#include "motor_outputs.hpp"
+
+CommandScheduler command_scheduler;
+
+// Guards the request queue, the only thing other tasks touch. A flag rather than
+// a pros::Mutex: PROS deletes the opcontrol task on a mode change, possibly while
+// run() holds it, and FreeRTOS never gives back a mutex held by a deleted task.
+// It's only ever held for a few instructions, so a holder that hasn't let go after
+// REQUEST_LOCK_TIMEOUT_MS is that deleted task.
+static std::atomic<bool> request_lock = false;
+constexpr std::uint32_t REQUEST_LOCK_TIMEOUT_MS = 20;
+
+// Takes the request lock, waiting up to timeout_ms. False if it didn't get it.
+static bool lock_requests(std::uint32_t timeout_ms) {
+    std::uint32_t start = pros::millis();
+    while (request_lock.exchange(true, std::memory_order_acquire)) {
+        if (pros::millis() - start >= timeout_ms) return false;
+        pros::delay(1);
+    }
+    return true;
+}
+
+static void unlock_requests() {
+    request_lock.store(false, std::memory_order_release);
+}
+
+static int subsystem_index(SubsystemBit subsystem) {
+    return __builtin_ctz(subsystem);
+}
+
+void CommandScheduler::set_default(SubsystemBit subsystem, Command* command) {
+    defaults[subsystem_index(subsystem)] = command;
+}
+
+bool CommandScheduler::queue(RequestType type, Command* command) {
+    if (!lock_requests(REQUEST_LOCK_TIMEOUT_MS)) return false;
+    // Checked under the lock so a request can't slip in after set_running(false) cleared the queue
+    bool queued = (type != RequestType::SCHEDULE || running) && request_count < MAX_REQUESTS;
+    if (queued) requests[request_count++] = {type, command};
+    unlock_requests();
+    return queued;
+}
+
+void CommandScheduler::set_running(bool running) {
+    // run() isn't being called, so if the lock is still held after the timeout
+    // it was left by the deleted opcontrol task and is taken over
+    if (!lock_requests(REQUEST_LOCK_TIMEOUT_MS)) printf("commands: request lock left held, taking it over\n");
+    this->running = running;
+    request_count = 0;
+    unlock_requests();
+    if (!running) {
+        while (active_count > 0) remove(active_count - 1, true);
+    }
+}
+
+bool CommandScheduler::schedule(Command& command) {
+    return queue(RequestType::SCHEDULE, &command);
+}
+
+bool CommandScheduler::cancel(Command& command) {
+    return queue(RequestType::CANCEL, &command);
+}
+
+bool CommandScheduler::cancel_all() {
+    return queue(RequestType::CANCEL_ALL, nullptr);
+}
+
+int CommandScheduler::index_of(const Command& command) const {
+    for (int i = 0; i < active_count; i++) {
+        if (active[i] == &command) return i;
+    }
+    return -1;
+}
+
+bool CommandScheduler::is_scheduled(const Command& command) const {
+    return index_of(command) >= 0;
+}
+
+const Command* CommandScheduler::holder(SubsystemBit subsystem) const {
+    for (int i = 0; i < active_count; i++) {
+        if (active[i]->requirements & subsystem) return active[i];
+    }
+    return nullptr;
+}
+
+void CommandScheduler::remove(int index, bool interrupted) {
+    Command* command = active[index];
+    for (int i = index; i < active_count - 1; i++) {
+        active[i] = active[i + 1];
+    }
+    active_count--;
+    held &= ~command->requirements;
+    command->end(interrupted);
+}
+
+void CommandScheduler::start(Command& command) {
+    if (is_scheduled(command)) return;
+
+    // Anything in the way has to be interruptible, otherwise the new command is refused
+    for (int i = 0; i < active_count; i++) {
+        if ((active[i]->requirements & command.requirements) && !active[i]->interruptible) {
+            printf("commands: %s refused, %s can't be interrupted\n", command.name, active[i]->name);
+            return;
+        }
+    }
+    for (int i = active_count - 1; i >= 0; i--) {
+        if (active[i]->requirements & command.requirements) remove(i, true);
+    }
+    if (active_count >= MAX_COMMANDS) {
+        printf("commands: %s refused, too many running\n", command.name);
+        return;
+    }
+
+    active[active_count++] = &command;
+    held |= command.requirements;
+    command.initialize();
+}
+
+void CommandScheduler::run() {
+    // Take the queued requests so other tasks aren't held up while they're applied
+    Request pending[MAX_REQUESTS];
+    int pending_count = 0;
+    // Requests wait for the next tick if the lock's held
+    if (lock_requests(0)) {
+        pending_count = request_count;
+        for (int i = 0; i < pending_count; i++) pending[i] = requests[i];
+        request_count = 0;
+        unlock_requests();
+    }
+
+    for (int r = 0; r < pending_count; r++) {
+        const Request& request = pending[r];
+        if (request.type == RequestType::SCHEDULE) {
+            start(*request.command);
+        } else if (request.type == RequestType::CANCEL) {
+            int index = index_of(*request.command);
+            if (index >= 0) remove(index, true);
+        } else {
+            while (active_count > 0) remove(active_count - 1, true);
+        }
+    }
+
+    // Free subsystems fall back to their default commands
+    for (int s = 0; s < SUBSYSTEM_COUNT; s++) {
+        Command* fallback = defaults[s];
+        if (fallback != nullptr && !(held & (1u << s)) && !(fallback->requirements & held)) {
+            start(*fallback);
+        }
+    }
+
+    for (int i = 0; i < active_count;) {
+        Command* command = active[i];
+        if (tick % command->period_ticks == 0) command->execute();
+        if (command->is_finished()) {
+            remove(i, false);
+        } else {
+            i++;
+        }
+    }
+    tick++;
+}
+
+void CommandScheduler::print_status() const {
+    printf("commands: %d running\n", active_count);
+    for (int i = 0; i < active_count; i++) {
+        printf("  %s, needs 0x%lx\n", active[i]->name, (unsigned long)active[i]->requirements);
+    }
+}
+
+// --- RoutineCommand ---
+
+void RoutineCommand::task_fn(void* param) {
+    RoutineCommand* command = static_cast<RoutineCommand*>(param);
+    command->routine();
+    command->done = true;
+}
+
+void RoutineCommand::initialize() {
+    done = routine == nullptr;
+    if (!done) task = pros::c::task_create(task_fn, this, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name);
+}
+
+void RoutineCommand::end(bool interrupted) {
+    if (interrupted && !done && task != nullptr) {
+        // The routine may be a coroutine auton inside run_auton
+        forget_auton_task(static_cast<pros::task_t>(task));
+        pros::c::task_delete(static_cast<pros::task_t>(task));
+    }
+    task = nullptr;
+    set_drive_voltage(0, 0);
+    motor_outputs.invalidate_all();
+}
@@ -0,0 +1,126 @@
+#ifndef COMMAND_SCHEDULER_HPP
+#define COMMAND_SCHEDULER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Command-based control of the subsystems.
+// Each command says which subsystems it needs. Scheduling a command cancels
+// whatever holds those subsystems, and a subsystem nobody holds runs its default
+// command (the driver control for it). The scheduler runs from the control loop,
+// so driver and auton take turns in one loop instead of checking a flag.
+
+enum SubsystemBit : std::uint32_t {
+    SUBSYSTEM_DRIVE = 1 << 0,
+    SUBSYSTEM_INTAKE = 1 << 1,
+    SUBSYSTEM_LIFT = 1 << 2,
+};
+
+constexpr int SUBSYSTEM_COUNT = 3;
+constexpr std::uint32_t ALL_SUBSYSTEMS = (1u << SUBSYSTEM_COUNT) - 1;
+
+class Command {
+public:
+    // period_ticks: only execute every this many scheduler ticks
+    Command(const char* name, std::uint32_t requirements, bool interruptible = true, std::uint32_t period_ticks = 1)
+        : name(name), requirements(requirements), interruptible(interruptible), period_ticks(period_ticks) {}
+    virtual ~Command() = default;
+
+    virtual void initialize() {}
+    virtual void execute() {}
+    virtual bool is_finished() { return false; }
+    // interrupted is true if it was cancelled or another command took a subsystem
+    virtual void end(bool interrupted) {}
+
+    const char* name;
+    std::uint32_t requirements;
+    bool interruptible;  // false: scheduling something that conflicts with it is refused
+    std::uint32_t period_ticks;
+};
+
+class CommandScheduler {
+public:
+    static constexpr int MAX_COMMANDS = 8;
+    static constexpr int MAX_REQUESTS = 8;
+
+    // Runs command whenever nothing else holds subsystem. Only set these before the loop starts.
+    void set_default(SubsystemBit subsystem, Command* command);
+
+    // Driver control turns the scheduler on before its loop starts, and it's
+    // turned off again in the other modes. Either way the queued requests are
+    // dropped, and turning it off ends every active command, so nothing asked
+    // for while disabled starts driving on its own at the next enable. Only call
+    // it while run() isn't being called. It's safe after PROS has deleted the
+    // opcontrol task in the middle of run().
+    void set_running(bool running);
+    bool is_running() const { return running; }
+
+    // schedule / cancel can be called from any task. They're queued and applied at
+    // the start of the next run(), so changes only ever happen between ticks.
+    // Returns false if the queue is full, or schedule while the scheduler isn't running.
+    bool schedule(Command& command);
+    bool cancel(Command& command);
+    bool cancel_all();
+
+    // One tick: applies queued requests, starts default commands for free
+    // subsystems, then executes the active commands in the order they started,
+    // ending the ones that finish.
+    void run();
+
+    bool is_scheduled(const Command& command) const;
+    // The command holding subsystem, or nullptr
+    const Command* holder(SubsystemBit subsystem) const;
+
+    void print_status() const;
+
+private:
+    enum class RequestType : std::uint8_t { SCHEDULE, CANCEL, CANCEL_ALL };
+    struct Request {
+        RequestType type;
+        Command* command;
+    };
+
+    bool queue(RequestType type, Command* command);
+    void start(Command& command);
+    void remove(int index, bool interrupted);
+    int index_of(const Command& command) const;
+
+    Command* active[MAX_COMMANDS] = {};
+    int active_count = 0;
+    Command* defaults[SUBSYSTEM_COUNT] = {};
+    std::uint32_t held = 0;  // subsystems held by active commands
+    std::uint32_t tick = 0;
+
+    Request requests[MAX_REQUESTS] = {};
+    int request_count = 0;
+    std::atomic<bool> running = false;
+};
+
+extern CommandScheduler command_scheduler;
+
+// Runs a blocking routine, like an auton, in its own task while holding its
+// subsystems. Finishes when the routine returns. If it's interrupted the task is
+// deleted where it is, so the routine shouldn't hold locks of its own.
+class RoutineCommand : public Command {
+public:
+    RoutineCommand(const char* name, void (*routine)(), std::uint32_t requirements = ALL_SUBSYSTEMS)
+        : Command(name, requirements), routine(routine) {}
+
+    // Only change the routine while the command isn't scheduled
+    void set_routine(void (*routine)()) { this->routine = routine; }
+
+    void initialize() override;
+    bool is_finished() override { return done; }
+    // Stops the drive and has motor_outputs resend everything, since the routine
+    // drove the motors directly
+    void end(bool interrupted) override;
+
+private:
+    static void task_fn(void* param);
+
+    void (*routine)();
+    void* task = nullptr;  // pros::task_t
+    std::atomic<bool> done = false;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "main.h"
+#include "control_loop.hpp"
+
+ControlLoop::ControlLoop(std::uint32_t base_period_ms) : base_period_ms(base_period_ms) {}
+
+bool ControlLoop::add(const char* name, std::uint32_t period_ms, TickFn fn) {
+    if (subsystem_count >= MAX_SUBSYSTEMS || fn == nullptr) return false;
+    if (period_ms == 0 || period_ms % base_period_ms != 0) return false;
+
+    subsystems[subsystem_count++] = {name, period_ms / base_period_ms, fn, 0};
+    return true;
+}
+
+void ControlLoop::run_once() {
+    for (int i = 0; i < subsystem_count; i++) {
+        Subsystem& s = subsystems[i];
+        if (tick % s.period_ticks != 0) continue;
+
+        std::uint64_t start = pros::micros();
+        s.fn();
+        std::uint32_t took = pros::micros() - start;
+        if (took > s.max_exec_us) s.max_exec_us = took;
+    }
+    tick++;
+}
+
+void ControlLoop::run() {
+    const std::uint32_t period_us = base_period_ms * 1000;
+    std::uint32_t wake_ms = pros::millis();
+    std::uint64_t last_start = pros::micros();
+
+    while (true) {
+        std::uint64_t start = pros::micros();
+
+        // Jitter is how far the spacing between two ticks is from the period
+        if (loop_stats.cycles > 0) {
+            std::uint64_t spacing = start - last_start;
+            std::uint32_t jitter = spacing > period_us ? spacing - period_us : period_us - spacing;
+            loop_stats.total_jitter_us += jitter;
+            loop_stats.last_jitter_us = jitter;
+            if (jitter > loop_stats.max_jitter_us) loop_stats.max_jitter_us = jitter;
+        }
+        last_start = start;
+
+        run_once();
+
+        std::uint32_t exec = pros::micros() - start;
+        loop_stats.last_exec_us = exec;
+        if (exec > loop_stats.max_exec_us) loop_stats.max_exec_us = exec;
+        if (exec > period_us) loop_stats.overruns++;
+        loop_stats.cycles++;
+
+        // delay_until returns straight away if the next wake time has already
+        // passed, which would burst through the missed ticks. Skip them instead
+        // so the loop stays on the same period boundaries.
+        std::uint32_t now = pros::millis();
+        if (now - wake_ms >= base_period_ms) {
+            std::uint32_t behind = (now - wake_ms) / base_period_ms;
+            loop_stats.skipped_ticks += behind;
+            wake_ms += behind * base_period_ms;
+        }
+        pros::Task::delay_until(&wake_ms, base_period_ms);
+    }
+}
+
+void ControlLoop::reset_stats() {
+    loop_stats = LoopStats{};
+    for (int i = 0; i < subsystem_count; i++) {
+        subsystems[i].max_exec_us = 0;
+    }
+}
+
+void ControlLoop::print_stats() const {
+    std::uint32_t avg_jitter = loop_stats.cycles > 1 ? loop_stats.total_jitter_us / (loop_stats.cycles - 1) : 0;
+    printf("loop: %lu cycles, %lu overruns, %lu skipped, jitter avg %lu us max %lu us, exec max %lu us\n",
+           (unsigned long)loop_stats.cycles, (unsigned long)loop_stats.overruns,
+           (unsigned long)loop_stats.skipped_ticks, (unsigned long)avg_jitter,
+           (unsigned long)loop_stats.max_jitter_us, (unsigned long)loop_stats.max_exec_us);
+    for (int i = 0; i < subsystem_count; i++) {
+        printf("  %s every %lu ms, exec max %lu us\n", subsystems[i].name,
+               (unsigned long)(subsystems[i].period_ticks * base_period_ms),
+               (unsigned long)subsystems[i].max_exec_us);
+    }
+}
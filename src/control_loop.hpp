@@ -0,0 +1,59 @@
+#ifndef CONTROL_LOOP_HPP
+#define CONTROL_LOOP_HPP
+
+#include <cstdint>
+
+// Fixed-rate control executive.
+// Subsystems are registered with their own period (a multiple of the base tick)
+// and the loop wakes with pros::Task::delay_until so the period never drifts by
+// however long the loop body took.
+
+struct LoopStats {
+    std::uint32_t cycles = 0;
+    std::uint32_t overruns = 0;       // ticks whose body took longer than the base period
+    std::uint32_t skipped_ticks = 0;  // whole periods lost after an overrun
+    std::uint32_t max_jitter_us = 0;  // worst |actual tick spacing - period|
+    std::uint64_t total_jitter_us = 0;
+    std::uint32_t max_exec_us = 0;    // worst time spent running subsystems in one tick
+    std::uint32_t last_jitter_us = 0; // the most recent tick, for telemetry
+    std::uint32_t last_exec_us = 0;
+};
+
+class ControlLoop {
+public:
+    using TickFn = void (*)();
+
+    static constexpr int MAX_SUBSYSTEMS = 8;
+
+    explicit ControlLoop(std::uint32_t base_period_ms);
+
+    // period_ms must be a non-zero multiple of the base period.
+    // Subsystems run in the order they were added. Returns false if it can't be added.
+    bool add(const char* name, std::uint32_t period_ms, TickFn fn);
+
+    // Runs every subsystem that is due this tick, without waiting.
+    void run_once();
+
+    // Runs forever at the base period.
+    [[noreturn]] void run();
+
+    const LoopStats& stats() const { return loop_stats; }
+    void reset_stats();
+    void print_stats() const;
+
+private:
+    struct Subsystem {
+        const char* name;
+        std::uint32_t period_ticks;
+        TickFn fn;
+        std::uint32_t max_exec_us;
+    };
+
+    std::uint32_t base_period_ms;
+    Subsystem subsystems[MAX_SUBSYSTEMS] = {};
+    int subsystem_count = 0;
+    std::uint32_t tick = 0;
+    LoopStats loop_stats;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "controller_input.hpp"
+
+ControllerInput::ControllerInput(pros::controller_id_e_t id, std::uint16_t button_mask, std::uint8_t axis_mask)
+    : id(id), button_mask(button_mask & ALL_BUTTONS), axis_mask(axis_mask & ALL_AXES) {}
+
+void ControllerInput::update() {
+    std::uint16_t held = 0;
+    std::int8_t axes[4] = {};
+
+    for (int i = 0; i < 12; i++) {
+        if (!(button_mask & (1u << i))) continue;
+        auto button = static_cast<pros::controller_digital_e_t>(pros::E_CONTROLLER_DIGITAL_L1 + i);
+        if (pros::c::controller_get_digital(id, button) == 1) held |= 1u << i;
+        read_count++;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        if (!(axis_mask & (1u << i))) continue;
+        std::int32_t value = pros::c::controller_get_analog(id, static_cast<pros::controller_analog_e_t>(i));
+        // PROS_ERR on a disconnected controller, treat it as centered
+        if (value < -127 || value > 127) value = 0;
+        axes[i] = value;
+        read_count++;
+    }
+
+    apply(held, axes);
+}
+
+void ControllerInput::apply(std::uint16_t held, const std::int8_t axes[4]) {
+    std::uint16_t changed = held ^ current.held;
+    current.pressed = changed & held;
+    current.released = changed & current.held;
+    current.held = held;
+    for (int i = 0; i < 4; i++) {
+        current.axes[i] = axes[i];
+    }
+
+    latched_pressed |= current.pressed;
+    latched_released |= current.released;
+}
+
+bool ControllerInput::take_press(pros::controller_digital_e_t button) {
+    std::uint16_t bit = button_bit(button);
+    bool hit = latched_pressed & bit;
+    latched_pressed &= ~bit;
+    return hit;
+}
+
+bool ControllerInput::take_release(pros::controller_digital_e_t button) {
+    std::uint16_t bit = button_bit(button);
+    bool hit = latched_released & bit;
+    latched_released &= ~bit;
+    return hit;
+}
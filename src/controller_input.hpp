@@ -0,0 +1,64 @@
+#ifndef CONTROLLER_INPUT_HPP
+#define CONTROLLER_INPUT_HPP
+
+#include <cstdint>
+#include "main.h"
+
+// One read of the controller per tick.
+// Buttons are packed into bitmasks (bit 0 = L1 ... bit 11 = A) and press/release
+// edges are worked out locally, so every subsystem sees the same input for a tick
+// instead of each one making its own kernel calls.
+
+constexpr std::uint16_t button_bit(pros::controller_digital_e_t button) {
+    return 1u << (button - pros::E_CONTROLLER_DIGITAL_L1);
+}
+
+constexpr std::uint16_t ALL_BUTTONS = 0x0FFF;
+constexpr std::uint8_t ALL_AXES = 0x0F;
+
+struct ControllerSnapshot {
+    std::uint16_t held = 0;
+    std::uint16_t pressed = 0;   // went down since the previous sample
+    std::uint16_t released = 0;  // went up since the previous sample
+    std::int8_t axes[4] = {};    // indexed by controller_analog_e_t, -127 to 127
+
+    bool is_held(pros::controller_digital_e_t button) const { return held & button_bit(button); }
+    bool was_pressed(pros::controller_digital_e_t button) const { return pressed & button_bit(button); }
+    bool was_released(pros::controller_digital_e_t button) const { return released & button_bit(button); }
+    int axis(pros::controller_analog_e_t channel) const { return axes[channel]; }
+};
+
+class ControllerInput {
+public:
+    // Only the buttons and axes in the masks are read from the controller, the
+    // rest always read as released / centered.
+    explicit ControllerInput(pros::controller_id_e_t id, std::uint16_t button_mask = ALL_BUTTONS,
+                             std::uint8_t axis_mask = ALL_AXES);
+
+    // Samples the controller once and updates the snapshot.
+    void update();
+
+    // Updates the snapshot from an already sampled state instead of the controller,
+    // e.g. scripted inputs.
+    void apply(std::uint16_t held, const std::int8_t axes[4]);
+
+    const ControllerSnapshot& snapshot() const { return current; }
+
+    // Edges are also latched until taken, so a subsystem that runs slower than
+    // update() doesn't miss a press that happened on a tick it skipped.
+    bool take_press(pros::controller_digital_e_t button);
+    bool take_release(pros::controller_digital_e_t button);
+
+    std::uint32_t reads() const { return read_count; }
+
+private:
+    pros::controller_id_e_t id;
+    std::uint16_t button_mask;
+    std::uint8_t axis_mask;
+    ControllerSnapshot current;
+    std::uint16_t latched_pressed = 0;
+    std::uint16_t latched_released = 0;
+    std::uint32_t read_count = 0;  // kernel calls made by update()
+};
+
+#endif
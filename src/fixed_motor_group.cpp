@@ -0,0 +1,8 @@
+#include "fixed_motor_group.hpp"
+#include <cerrno>
+
+void motor_group_port_error(const char* why) {
+    // Only reachable for a group built at runtime, constinit groups are checked by the compiler
+    printf("FixedMotorGroup: %s\n", why);
+    errno = ENXIO;
+}
@@ -0,0 +1,91 @@
+#ifndef FIXED_MOTOR_GROUP_HPP
+#define FIXED_MOTOR_GROUP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "main.h"
+
+// Called when a FixedMotorGroup is given a bad port list. It isn't constexpr, so
+// a constinit group with bad ports fails to compile instead of failing at runtime.
+void motor_group_port_error(const char* why);
+
+// Motor group with its ports stored inline, for groups whose size is known at
+// compile time (the drivetrain). Unlike pros::MotorGroup it never touches the
+// heap and needs no mutex since the ports can't change after construction.
+// Ports are signed like pros::Motor, negative means reversed.
+//
+// Declare it constinit so bad ports are a compile error:
+//   constinit FixedMotorGroup<2> left_mg({1, 12});
+template <std::size_t N>
+class FixedMotorGroup {
+    static_assert(N > 0 && N <= 21, "a V5 brain has 21 smart ports");
+
+public:
+    constexpr FixedMotorGroup(const std::int8_t (&group_ports)[N]) {
+        for (std::size_t i = 0; i < N; i++) {
+            std::int8_t port = group_ports[i];
+            if (port == 0 || port < -21 || port > 21) {
+                motor_group_port_error("motor port out of range");
+            }
+            for (std::size_t j = 0; j < i; j++) {
+                if (group_ports[j] == port || group_ports[j] == -port) {
+                    motor_group_port_error("motor port used twice in a group");
+                }
+            }
+            port_list[i] = port;
+        }
+    }
+
+    constexpr std::span<const std::int8_t, N> ports() const { return port_list; }
+    constexpr std::int8_t size() const { return N; }
+    constexpr std::int8_t get_port(std::uint8_t index = 0) const { return port_list[index]; }
+
+    // Movement, same meaning as the pros::MotorGroup functions
+    void move(std::int32_t voltage) const {
+        for (std::int8_t port : port_list) pros::c::motor_move(port, voltage);
+    }
+    void move_voltage(std::int32_t voltage) const {
+        for (std::int8_t port : port_list) pros::c::motor_move_voltage(port, voltage);
+    }
+    void move_velocity(std::int32_t velocity) const {
+        for (std::int8_t port : port_list) pros::c::motor_move_velocity(port, velocity);
+    }
+    void move_relative(double position, std::int32_t velocity) const {
+        for (std::int8_t port : port_list) pros::c::motor_move_relative(port, position, velocity);
+    }
+    void move_absolute(double position, std::int32_t velocity) const {
+        for (std::int8_t port : port_list) pros::c::motor_move_absolute(port, position, velocity);
+    }
+    void brake() const {
+        for (std::int8_t port : port_list) pros::c::motor_brake(port);
+    }
+
+    // Configuration
+    void set_brake_mode_all(pros::motor_brake_mode_e_t mode) const {
+        for (std::int8_t port : port_list) pros::c::motor_set_brake_mode(port, mode);
+    }
+    void set_gearing_all(pros::motor_gearset_e_t gearset) const {
+        for (std::int8_t port : port_list) pros::c::motor_set_gearing(port, gearset);
+    }
+    void set_encoder_units_all(pros::motor_encoder_units_e_t units) const {
+        for (std::int8_t port : port_list) pros::c::motor_set_encoder_units(port, units);
+    }
+    void tare_position_all() const {
+        for (std::int8_t port : port_list) pros::c::motor_tare_position(port);
+    }
+
+    // Telemetry for a single motor. Use MotorGroupSnapshot to read the whole group.
+    double get_position(std::uint8_t index = 0) const { return pros::c::motor_get_position(port_list[index]); }
+    double get_actual_velocity(std::uint8_t index = 0) const {
+        return pros::c::motor_get_actual_velocity(port_list[index]);
+    }
+    std::int32_t get_raw_position(std::uint32_t* timestamp, std::uint8_t index = 0) const {
+        return pros::c::motor_get_raw_position(port_list[index], timestamp);
+    }
+
+private:
+    std::int8_t port_list[N] = {};
+};
+
+#endif
@@ -1,17 +1,40 @@
 #include "main.h"
+#include "globals.hpp"
 
 //Define Devices here
 /*Comp Bot devices
-pros::MotorGroup left_mg({-1, -2, -3});  
-pros::MotorGroup right_mg({4, 5, 6});   
+constinit FixedMotorGroup<3> left_mg({-1, -2, -3});
+constinit FixedMotorGroup<3> right_mg({4, 5, 6});
 pros::Motor intake_motor(7);
 */
-pros::MotorGroup left_mg({1, 12});
-pros::MotorGroup right_mg({-10, -20});
+// Drivetrain groups keep their ports inline, constinit checks them at compile time
+constinit FixedMotorGroup<2> left_mg({1, 12});
+constinit FixedMotorGroup<2> right_mg({-10, -20});
 pros::Motor intake_motor({13});
 pros::Motor lift_motor({19});
+pros::Imu imu(11);
+
+// Tracking wheels, set use_tracking_wheels once they're on the robot
+// Run calibrate_tracking_offsets() to measure the offsets
+pros::Rotation left_tracker(14);
+pros::Rotation right_tracker(15);
+pros::Rotation perp_tracker(16);
+TrackingConfig tracking_config = {
+    .wheel_diameter = 2.0,
+    .left_offset = 5.0,
+    .right_offset = -5.0,
+    .perp_offset = -2.0,
+    .has_right = false,
+    .has_perp = true,
+};
+bool use_tracking_wheels = false;
 
 int intake_volt = 12000;
 int lift_volt = 8000;
 
 float slow_mult = 0.5f;
+
+// Drivetrain geometry, used by odometry and motion
+double drive_wheel_diameter = 3.25;  // inches
+double drive_counts_per_rev = 900;   // raw encoder counts per wheel turn (green cartridge, direct drive)
+double drive_track_width = 12.0;     // inches between left and right wheels
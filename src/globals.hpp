@@ -2,16 +2,31 @@
 #define GLOBALS_HPP
 
 #include "main.h"
+#include "fixed_motor_group.hpp"
+#include "tracking_odometry.hpp"
 
 // 'extern' tells the compiler these are defined in another file
-extern pros::MotorGroup left_mg;
-extern pros::MotorGroup right_mg;
+extern FixedMotorGroup<2> left_mg;
+extern FixedMotorGroup<2> right_mg;
 extern pros::Motor intake_motor;
 extern pros::Motor lift_motor;
+extern pros::Imu imu;
+
+// Tracking wheels
+extern pros::Rotation left_tracker;
+extern pros::Rotation right_tracker;
+extern pros::Rotation perp_tracker;
+extern TrackingConfig tracking_config;
+extern bool use_tracking_wheels;
 
 extern int intake_volt;
 extern int lift_volt;
 
 extern float slow_mult;
 
+// Drivetrain geometry
+extern double drive_wheel_diameter;
+extern double drive_counts_per_rev;
+extern double drive_track_width;
+
 #endif
\ No newline at end of file
@@ -1,13 +1,18 @@
 #include "main.h"
 #include "globals.hpp"
+#include "auton_actions.hpp"
+
+using namespace std::chrono_literals;
+
+static AutonTask left_qual_routine() {
+    // Follow the precompiled paths/left_qual_auton.path (28 inches straight out)
+    // with the intake running for the first second, both off the one scheduler loop
+    co_await all(follow("left_qual_auton"), intake_for(1s));
+}
 
 void left_qual_auton() {
     // Example left qualification auton code
-    left_mg.move_relative(1000, 100);  // Move left motors forward 1000 ticks at speed 100
-    right_mg.move_relative(1000, 100); // Move right motors forward 1000 ticks at speed 100
-    pros::delay(2000);                 // Wait for 2 seconds
-    intake_motor.move_velocity(200);   // Start intake motor at velocity 200
-    pros::delay(1000);                 // Run intake for 1 second
-    intake_motor.move_velocity(0);     // Stop intake motor
-
-}
\ No newline at end of file
+    begin_route("left_qual");
+    run_auton(left_qual_routine());
+    print_route_report();
+}
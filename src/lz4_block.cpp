@@ -0,0 +1,166 @@
+#include <cstring>
+#include "lz4_block.hpp"
+
+// Block format rules: a sequence is a token (literal length in the high nibble,
+// match length - 4 in the low one, 15 meaning more length bytes follow), the
+// literals, a 2 byte little endian offset, then the extra match length bytes.
+// The last 5 bytes are always literals and no match may start in the last 12.
+
+namespace {
+
+constexpr std::size_t MIN_MATCH = 4;
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MF_LIMIT = 12;
+constexpr int HASH_BITS = 12;
+
+std::uint32_t read32(const std::uint8_t* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash4(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Writes the 255, 255, ..., rest bytes of a length that didn't fit in its nibble
+bool write_length(std::size_t length, std::uint8_t*& op, const std::uint8_t* end) {
+    while (length >= 255) {
+        if (op >= end) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= end) return false;
+    *op++ = static_cast<std::uint8_t>(length);
+    return true;
+}
+
+bool write_sequence(const std::uint8_t* literals, std::size_t literal_length, std::size_t offset,
+                    std::size_t match_length, std::uint8_t*& op, const std::uint8_t* end) {
+    if (op >= end) return false;
+    std::uint8_t* token = op++;
+    *token = static_cast<std::uint8_t>((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15 && !write_length(literal_length - 15, op, end)) return false;
+
+    if (static_cast<std::size_t>(end - op) < literal_length) return false;
+    if (literal_length > 0) std::memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    // The last sequence is literals only
+    if (match_length == 0) return true;
+
+    if (end - op < 2) return false;
+    *op++ = static_cast<std::uint8_t>(offset);
+    *op++ = static_cast<std::uint8_t>(offset >> 8);
+    std::size_t extra = match_length - MIN_MATCH;
+    *token |= extra >= 15 ? 15 : extra;
+    if (extra >= 15 && !write_length(extra - 15, op, end)) return false;
+    return true;
+}
+
+}  // namespace
+
+std::size_t lz4_compress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst, std::size_t capacity) {
+    if (n > LZ4_MAX_BLOCK_INPUT) return 0;
+
+    std::uint8_t* op = dst;
+    const std::uint8_t* end = dst + capacity;
+    std::size_t anchor = 0;
+
+    if (n > MF_LIMIT) {
+        // Last position each hash of 4 bytes was seen. Offsets are 16 bit and
+        // the block is at most 64 KB, so any hit is within reach.
+        std::uint16_t table[1 << HASH_BITS] = {};
+        const std::size_t match_start_limit = n - MF_LIMIT;
+        const std::size_t match_end_limit = n - LAST_LITERALS;
+
+        std::size_t ip = 1;
+        table[hash4(read32(src))] = 0;
+        while (ip < match_start_limit) {
+            std::uint32_t sequence = read32(src + ip);
+            std::uint32_t h = hash4(sequence);
+            std::size_t ref = table[h];
+            table[h] = static_cast<std::uint16_t>(ip);
+
+            if (ref >= ip || read32(src + ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            std::size_t length = MIN_MATCH;
+            while (ip + length < match_end_limit && src[ref + length] == src[ip + length]) length++;
+
+            if (!write_sequence(src + anchor, ip - anchor, ip - ref, length, op, end)) return 0;
+            ip += length;
+            anchor = ip;
+
+            // Remember the position just before where we landed too, repeats often start there
+            if (ip < match_start_limit) table[hash4(read32(src + ip - 2))] = static_cast<std::uint16_t>(ip - 2);
+        }
+    }
+
+    if (!write_sequence(src + anchor, n - anchor, 0, 0, op, end)) return 0;
+    return op - dst;
+}
+
+long lz4_decompress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst, std::size_t size) {
+    const std::uint8_t* ip = src;
+    const std::uint8_t* in_end = src + n;
+    std::uint8_t* op = dst;
+    std::uint8_t* out_end = dst + size;
+
+    // Reads the extra length bytes after a 15 nibble
+    auto read_length = [&](std::size_t& length) {
+        std::uint8_t byte;
+        do {
+            if (ip >= in_end) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (true) {
+        // Every block ends on a literals only sequence, even an empty one
+        if (ip >= in_end) return -1;
+        std::uint8_t token = *ip++;
+
+        std::size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(literal_length)) return -1;
+        if (static_cast<std::size_t>(in_end - ip) < literal_length) return -1;
+        if (static_cast<std::size_t>(out_end - op) < literal_length) return -1;
+        std::memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // The block ends after the last literals, which have no match
+        if (ip == in_end) {
+            if ((token & 15) != 0) return -1;
+            break;
+        }
+
+        if (in_end - ip < 2) return -1;
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dst)) return -1;
+
+        std::size_t match_length = token & 15;
+        if (match_length == 15 && !read_length(match_length)) return -1;
+        match_length += MIN_MATCH;
+        if (static_cast<std::size_t>(out_end - op) < match_length) return -1;
+
+        // A match can overlap what it's writing, only copy it in one go when it doesn't.
+        // Offset 1 is a run of one byte, common in shuffled telemetry.
+        const std::uint8_t* match = op - offset;
+        if (offset >= match_length) {
+            std::memcpy(op, match, match_length);
+        } else if (offset == 1) {
+            std::memset(op, *match, match_length);
+        } else {
+            for (std::size_t i = 0; i < match_length; i++) op[i] = match[i];
+        }
+        op += match_length;
+    }
+    if (op != out_end) return -1;
+    return static_cast<long>(size);
+}
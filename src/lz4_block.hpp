@@ -0,0 +1,33 @@
+#ifndef LZ4_BLOCK_HPP
+#define LZ4_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format compression for the telemetry logs.
+// The LZ4 header LVGL ships (liblvgl/libs/lz4/lz4.h) has no implementation
+// linked in (LV_USE_LZ4_INTERNAL is 0), so this is a small greedy compressor
+// for blocks up to 64 KB. The output is standard LZ4 block format, so
+// LZ4_decompress_safe from any LZ4 can read it, as can lz4_decompress below.
+//
+// Shared with the host tools, so no PROS includes in here.
+
+constexpr std::size_t LZ4_MAX_BLOCK_INPUT = 65535;
+
+// Worst case compressed size for n input bytes
+constexpr std::size_t lz4_bound(std::size_t n) {
+    return n + n / 255 + 16;
+}
+
+// Compresses n bytes (at most LZ4_MAX_BLOCK_INPUT) from src into dst.
+// Returns the compressed size, or 0 if it didn't fit in capacity.
+std::size_t lz4_compress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst, std::size_t capacity);
+
+// Decompresses n bytes of a block that unpacks to exactly size bytes into dst.
+// Never reads or writes out of bounds. Returns size, or -1 if the block is
+// corrupt, cut short or unpacks to any other size. The format itself can't
+// tell a block cut off after some literals from a shorter one, so it's the
+// expected size that catches those.
+long lz4_decompress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst, std::size_t size);
+
+#endif
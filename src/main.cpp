@@ -1,7 +1,14 @@
 #include "main.h"
 #include "auton_select.hpp"
 #include "autons.hpp"
+#include "auton_prewarm.hpp"
 #include "globals.hpp"
+#include "command_scheduler.hpp"
+#include "control_loop.hpp"
+#include "controller_input.hpp"
+#include "motor_outputs.hpp"
+#include "odometry.hpp"
+#include "telemetry_log.hpp"
 
 /**
  * Runs initialization code. This occurs as soon as the program is started.
@@ -13,14 +20,46 @@ void initialize() {
     // Print a simple Hello World message on startup
     printf("Hello World!\n");
     create_auton_selector();
+
+    start_telemetry_logger();
+
+    // Calibrating takes ~2 s, odometry uses encoder heading until it's done
+    imu.reset();
+    if (use_tracking_wheels) {
+        start_tracking_odometry();
+    } else {
+        start_odometry();
+    }
 }
 
+// Driver control loop, file scope so the telemetry tick and disabled() can read its stats
+static ControlLoop loop(10);
+
 /**
  * Runs while the robot is in the disabled state of Field Management System or
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+    // Driver control is over, drop anything it had running or queued
+    command_scheduler.set_running(false);
+
+    // Autonomous may have been cut off before it could turn its sampling off
+    set_auton_telemetry(false);
+
+    // Get what was logged so far onto the card, and report once it's there
+    telemetry_flush();
+    if (!telemetry_wait_flushed(1000)) printf("telemetry: flush still running\n");
+    print_telemetry_stats();
+    // How the driver control loop kept time, if it ran since the last report
+    if (loop.stats().cycles > 0) {
+        loop.print_stats();
+        loop.reset_stats();
+    }
+
+    // Get the selected auton ready, redone if the selection changes
+    prewarm_while_disabled();
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -31,7 +70,10 @@ void disabled() {}
  * This task will exit when the robot is enabled and autonomous or opcontrol
  * starts.
  */
-void competition_initialize() {}
+void competition_initialize() {
+    // The selector stays up, so keep the chosen auton prewarmed until enable
+    prewarm_while_disabled();
+}
 
 /**
  * Runs the user autonomous code. This function will be started in its own task
@@ -45,158 +87,176 @@ void competition_initialize() {}
  * from where it left off.
  */
 void autonomous() {
-    // This looks a auton var (1-8) and runs the matching function
-    switch (selected_auton) {
-        case 1: left_qual_auton();   break;
-        case 2: right_qual_auton();  break;
-        case 3: skills_auton_for_qual(); break;
-        case 4: right_qual_auton_center(); break;
-        case 5: left_qual_auton_ram(); break;
-        
-        default: 
-            // Fallback if something goes wrong
-            printf("No auton selected!\n");
-            break;
-    }
+    mark_auton_enabled();
+    command_scheduler.set_running(false);
+    set_auton_telemetry(true);
+
+    // Looks up the selected auton in the registry and runs it
+    dispatch_auton(selected_auton);
+    set_auton_telemetry(false);
 
+    print_enable_latency();
 }
 
-/**
- * Runs the operator control code. This function will be started in its own task
- * with the default priority and stack size whenever the robot is enabled via
- * the Field Management System or the VEX Competition Switch in the operator
- * control mode.
- *
- * If no competition control is connected, this function will run immediately
- * following initialize().
- *
- * If the robot is disabled or communications is lost, the
- * operator control task will be stopped. Re-enabling the robot will restart the
- * task, not resume it from where it left off.
- */
+// Driver control state, shared by the subsystem ticks below.
+// Only the buttons and sticks the driver code uses are read each tick.
+static ControllerInput master(pros::E_CONTROLLER_MASTER,
+                              button_bit(DIGITAL_UP) | button_bit(DIGITAL_RIGHT) |
+                              button_bit(DIGITAL_L1) | button_bit(DIGITAL_L2) |
+                              button_bit(DIGITAL_R1) | button_bit(DIGITAL_R2),
+                              (1u << ANALOG_LEFT_Y) | (1u << ANALOG_RIGHT_X));
 
-void opcontrol() {
-    pros::Controller master(pros::E_CONTROLLER_MASTER);
+// Everything is off because the bot just started
+static bool intake_active = false, intake_rev = false;
+static bool lift_active = false, lift_rev = false;
+static float intake_slow = 1.0f;
+static float lift_slow = 1.0f;
 
-    // Everything is off because the bot just started
-    bool intake_active, intake_rev, lift_active, lift_rev; 
-    intake_active = intake_rev = lift_active = lift_rev = false;
+static void controller_tick() {
+    master.update();
+}
 
-    float intake_slow = 1.0f; 
-    float lift_slow = 1.0f;
+// Driver control runs as the default commands, so it stops whenever something
+// else (the debug auton run) takes the subsystems and comes back afterwards.
 
+class DriverDrive : public Command {
+public:
+    DriverDrive() : Command("driver drive", SUBSYSTEM_DRIVE) {}
 
-    while (true) {
-        
-        // --- SAFETY CHECK ---
-        // If the debug run is active, SKIP all joystick controls
-        if (is_debug_running) {
-            pros::delay(20); // Wait and let the auton task work (ms)
-            continue;        // Skip the rest of the loop
-        }
-        
-        
-        if (master.get_digital_new_press(DIGITAL_UP)) {
-            if (intake_slow == 1.0f) {
-                intake_slow *= slow_mult;
-            } else {
-                intake_slow = 1.0f;
-            }
-            // update intake speed
-            if (!intake_rev) {
-                intake_motor.move_voltage(intake_volt * intake_slow);
-            } else {
-                intake_motor.move_voltage(-intake_volt * intake_slow);
-            }
-        }
+    void execute() override {
+        const ControllerSnapshot& pad = master.snapshot();
+        int dir = pad.axis(ANALOG_LEFT_Y);
+        int turn = pad.axis(ANALOG_RIGHT_X);
+        motor_outputs.move(left_mg.ports(), dir - turn);
+        motor_outputs.move(right_mg.ports(), dir + turn);
+    }
+};
 
-        if (master.get_digital_new_press(DIGITAL_RIGHT)) {
-            if (lift_slow == 1.0f) {
-                lift_slow *= slow_mult;
-            } else {
-                lift_slow = 1.0f;
-            }
-            // update lift speed
-            if (!lift_rev) {
-                lift_motor.move_voltage(lift_volt * lift_slow);
-            } else {
-                lift_motor.move_voltage(-lift_volt * lift_slow);
-            }
-        }
+// Mechanisms only need every other tick
+class DriverIntake : public Command {
+public:
+    DriverIntake() : Command("driver intake", SUBSYSTEM_INTAKE, true, 2) {}
 
-        // Intake Logic
+    // Drop presses made while something else had the intake
+    void initialize() override {
+        master.take_press(DIGITAL_UP);
+        master.take_press(DIGITAL_L1);
+    }
 
-        // When user presses L2 activates reverse
-        if (master.get_digital_new_press(DIGITAL_L2)) {
-            intake_rev = true;
-            if (intake_active) {
-                intake_motor.move_voltage(-intake_volt * intake_slow);
-            }
+    void execute() override {
+        // UP toggles slow mode
+        if (master.take_press(DIGITAL_UP)) {
+            intake_slow = intake_slow == 1.0f ? slow_mult : 1.0f;
         }
 
-        if (master.get_digital_new_release(DIGITAL_L2)) {
-            intake_rev = false;
-            if (intake_active) {
-                intake_motor.move_voltage(intake_volt * intake_slow);
-            }
-        }
-        
+        // Reverse while L2 is held
+        intake_rev = master.snapshot().is_held(DIGITAL_L2);
+
         // Toggle on/off intake
-        if (master.get_digital_new_press(DIGITAL_L1)) {
+        if (master.take_press(DIGITAL_L1)) {
             intake_active = !intake_active;
         }
-        
+
         // Turns the intake on/off/slow/reverse based on the variables
         if (intake_active) {
             if (!intake_rev) {
-                intake_motor.move_voltage(intake_volt * intake_slow);
+                motor_outputs.voltage(intake_motor, intake_volt * intake_slow);
             } else {
-                intake_motor.move_voltage(-intake_volt * intake_slow);
+                motor_outputs.voltage(intake_motor, -intake_volt * intake_slow);
             }
         } else {
-            intake_motor.move_voltage(0);
+            motor_outputs.voltage(intake_motor, 0);
         }
+    }
+};
 
-        // Lifting
+class DriverLift : public Command {
+public:
+    DriverLift() : Command("driver lift", SUBSYSTEM_LIFT, true, 2) {}
 
+    void initialize() override {
+        master.take_press(DIGITAL_RIGHT);
+        master.take_press(DIGITAL_R1);
+    }
 
-        // When user presses R2 activates reverse
-        if (master.get_digital_new_press(DIGITAL_R2)) {
-            lift_rev = true;
-            if (lift_active) {
-                lift_motor.move_voltage(-lift_volt * lift_slow);
-            }
+    void execute() override {
+        // RIGHT toggles slow mode
+        if (master.take_press(DIGITAL_RIGHT)) {
+            lift_slow = lift_slow == 1.0f ? slow_mult : 1.0f;
         }
 
-        // deactivates when user releases R2
-        if (master.get_digital_new_release(DIGITAL_R2)) {
-            lift_rev = false;
-            if (lift_active) {
-                lift_motor.move_voltage(lift_volt * lift_slow);
-            }
-        }
+        // Reverse while R2 is held
+        lift_rev = master.snapshot().is_held(DIGITAL_R2);
 
         // Toggle on/off lift
-        if (master.get_digital_new_press(DIGITAL_R1)) {
+        if (master.take_press(DIGITAL_R1)) {
             lift_active = !lift_active;
         }
 
         if (lift_active) {
             if (!lift_rev) {
-                lift_motor.move_voltage(lift_volt * lift_slow);
+                motor_outputs.voltage(lift_motor, lift_volt * lift_slow);
             } else {
-                lift_motor.move_voltage(-lift_volt * lift_slow);
+                motor_outputs.voltage(lift_motor, -lift_volt * lift_slow);
             }
         } else {
-            lift_motor.move_voltage(0);
+            motor_outputs.voltage(lift_motor, 0);
         }
+    }
+};
+
+static DriverDrive driver_drive;
+static DriverIntake driver_intake;
+static DriverLift driver_lift;
+
+static void commands_tick() {
+    command_scheduler.run();
+}
+
+// Only copies records into the telemetry ring, the logger task does the rest
+static void telemetry_tick() {
+    telemetry_sample_drive(driver_telemetry);
+    telemetry_sample_mechanisms(driver_telemetry);
+    telemetry_record_loop(driver_telemetry, loop.stats());
+}
 
-        // Drive Logic
-        int dir = master.get_analog(ANALOG_LEFT_Y);    
-        int turn = master.get_analog(ANALOG_RIGHT_X);  
-        left_mg.move(dir - turn);                      
-        right_mg.move(dir + turn);                     
-        
-        pros::delay(20);                               
+static void outputs_tick() {
+    motor_outputs.flush();
+}
+
+/**
+ * Runs the operator control code. This function will be started in its own task
+ * with the default priority and stack size whenever the robot is enabled via
+ * the Field Management System or the VEX Competition Switch in the operator
+ * control mode.
+ *
+ * If no competition control is connected, this function will run immediately
+ * following initialize().
+ *
+ * If the robot is disabled or communications is lost, the
+ * operator control task will be stopped. Re-enabling the robot will restart the
+ * task, not resume it from where it left off.
+ */
+void opcontrol() {
+    static bool loop_ready = false;
+    if (!loop_ready) {
+        command_scheduler.set_default(SUBSYSTEM_DRIVE, &driver_drive);
+        command_scheduler.set_default(SUBSYSTEM_INTAKE, &driver_intake);
+        command_scheduler.set_default(SUBSYSTEM_LIFT, &driver_lift);
+
+        // The controller is sampled first so every command sees the same input
+        loop.add("controller", 10, controller_tick);
+        loop.add("commands", 10, commands_tick);
+        loop.add("telemetry", 10, telemetry_tick);
+        // Last, so each port gets at most one command per tick
+        loop.add("outputs", 10, outputs_tick);
+        loop_ready = true;
     }
-}
\ No newline at end of file
+
+    // Autonomous drove the motors directly, so the cache can't trust what it last sent
+    motor_outputs.invalidate_all();
+    // Starts with an empty queue, a debug run asked for while disabled was refused
+    command_scheduler.set_running(true);
+    loop.reset_stats();
+    loop.run();
+}
@@ -0,0 +1,333 @@
+#include <cmath>
+#include <cstring>
+#include "main.h"
+#include "motion.hpp"
+#include "globals.hpp"
+#include "motion_profile.hpp"
+#include "auton_prewarm.hpp"
+
+PIDGains drive_gains = {.kp = 900, .ki = 20, .kd = 60, .integral_range = 3};
+PIDGains heading_gains = {.kp = 6000, .ki = 0, .kd = 200, .integral_range = 0};
+PIDGains turn_gains = {.kp = 9000, .ki = 300, .kd = 500, .integral_range = 0.1};
+
+DriveParams default_drive_params = {
+    .max_voltage = 12000,
+    .exit = {.small_error = 1, .small_time = 100, .large_error = 3, .large_time = 500,
+             .max_velocity = 4, .timeout = 4000},
+};
+DriveParams default_turn_params = {
+    .max_voltage = 12000,
+    .exit = {.small_error = 1, .small_time = 100, .large_error = 3, .large_time = 500,
+             .max_velocity = 20, .timeout = 2000},
+};
+
+double PID::update(double error, double dt) {
+    if (gains.integral_range > 0 && std::fabs(error) < gains.integral_range) {
+        integral += error * dt;
+    }
+    // Reset the integral when we cross the target so it doesn't push us past it
+    if (!first && std::signbit(error) != std::signbit(last_error)) {
+        integral = 0;
+    }
+
+    double derivative = (first || dt <= 0) ? 0 : (error - last_error) / dt;
+    last_error = error;
+    first = false;
+    return gains.kp * error + gains.ki * integral + gains.kd * derivative;
+}
+
+void PID::reset() {
+    integral = 0;
+    last_error = 0;
+    first = true;
+}
+
+double angle_error(double target, double current) {
+    return std::remainder(target - current, 2 * M_PI);
+}
+
+void set_drive_voltage(double left, double right) {
+    left = std::fmax(-12000, std::fmin(12000, left));
+    right = std::fmax(-12000, std::fmin(12000, right));
+    left_mg.move_voltage(left);
+    right_mg.move_voltage(right);
+    note_motor_command();
+}
+
+bool chaining_enabled = true;
+
+// Forward output the last move left the drive at, so a chained move can pick up from it
+static double carried_forward = 0;
+
+double carried_drive_output() {
+    return carried_forward;
+}
+
+// --- Motion ---
+
+void Motion::start(const Pose& pose, std::uint32_t now) {
+    motion_result = MotionResult{};
+    start_time = now;
+    last_time = now;
+    last_error = 0;
+    in_small = in_large = false;
+    if (!chaining_enabled) {
+        params.exit_speed = 0;
+        params.early_exit = 0;
+    }
+}
+
+double Motion::shape_forward(double forward) {
+    // Keep at least the exit speed, in the direction we're going
+    double floor = params.exit_speed > 0 ? drive_feedforward.calculate(params.exit_speed, 0) : 0;
+    if (std::fabs(forward) < floor) forward = forward < 0 ? -floor : floor;
+
+    if (params.slew > 0) {
+        forward = std::fmax(carried_forward - params.slew, std::fmin(carried_forward + params.slew, forward));
+    }
+    return forward;
+}
+
+void Motion::output(double left, double right) {
+    double biggest = std::fmax(std::fabs(left), std::fabs(right));
+    if (biggest > params.max_voltage) {
+        left *= params.max_voltage / biggest;
+        right *= params.max_voltage / biggest;
+    }
+    carried_forward = (left + right) / 2;
+    set_drive_voltage(left, right);
+}
+
+bool Motion::check_exit(double error, std::uint32_t now) {
+    error = std::fabs(error);
+    double dt = (now - last_time) / 1000.0;
+    double velocity = (now == start_time || dt <= 0) ? 0 : std::fabs(error - last_error) / dt;
+    last_time = now;
+    last_error = error;
+
+    motion_result.elapsed = now - start_time;
+    motion_result.final_error = error;
+
+    // Close enough to hand over to the next move
+    if (params.early_exit > 0 && error < params.early_exit) {
+        motion_result.chained = true;
+        return true;
+    }
+
+    bool slow = exit.max_velocity <= 0 || velocity < exit.max_velocity;
+
+    if (error < exit.small_error) {
+        if (!in_small) small_since = now;
+        in_small = true;
+    } else {
+        in_small = false;
+    }
+    if (error < exit.large_error) {
+        if (!in_large) large_since = now;
+        in_large = true;
+    } else {
+        in_large = false;
+    }
+
+    if (slow && ((in_small && now - small_since >= exit.small_time) ||
+                 (in_large && now - large_since >= exit.large_time))) {
+        motion_result.settled = true;
+        return true;
+    }
+    if (exit.timeout > 0 && motion_result.elapsed >= exit.timeout) {
+        motion_result.timed_out = true;
+        return true;
+    }
+    return false;
+}
+
+// --- DriveDistance ---
+
+DriveDistance::DriveDistance(double inches, const DriveParams& params)
+    : Motion(params), distance(inches), drive_pid(drive_gains),
+      heading_pid(heading_gains) {}
+
+void DriveDistance::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    start_pose = pose;
+    drive_pid.reset();
+    heading_pid.reset();
+}
+
+bool DriveDistance::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+
+    // Progress along the starting heading
+    double dx = pose.x - start_pose.x;
+    double dy = pose.y - start_pose.y;
+    double travelled = dx * std::cos(start_pose.theta) + dy * std::sin(start_pose.theta);
+    double error = distance - travelled;
+
+    if (check_exit(error, now)) return true;
+
+    double forward = shape_forward(drive_pid.update(error, dt));
+    double turn = heading_pid.update(angle_error(start_pose.theta, pose.theta), dt);
+    output(forward - turn, forward + turn);
+    return false;
+}
+
+// --- TurnToHeading ---
+
+TurnToHeading::TurnToHeading(double degrees, const DriveParams& params)
+    : Motion(params), target(degrees * M_PI / 180), turn_pid(turn_gains) {}
+
+void TurnToHeading::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    turn_pid.reset();
+}
+
+bool TurnToHeading::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+    double error = angle_error(target, pose.theta);
+
+    // Turn exit conditions are in degrees
+    if (check_exit(error * 180 / M_PI, now)) return true;
+
+    double turn = turn_pid.update(error, dt);
+    output(-turn, turn);
+    return false;
+}
+
+// --- DriveToPoint ---
+
+DriveToPoint::DriveToPoint(double x, double y, const DriveParams& params)
+    : Motion(params), target_x(x), target_y(y), drive_pid(drive_gains),
+      heading_pid(heading_gains) {}
+
+void DriveToPoint::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    drive_pid.reset();
+    heading_pid.reset();
+}
+
+bool DriveToPoint::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+    double dx = target_x - pose.x;
+    double dy = target_y - pose.y;
+    double heading_to_target = std::atan2(dy, dx);
+    double turn_error = angle_error(heading_to_target, pose.theta);
+
+    // Distance along our heading, so driving past the point gives a negative error
+    double error = dx * std::cos(pose.theta) + dy * std::sin(pose.theta);
+
+    if (check_exit(error, now)) return true;
+
+    double forward = shape_forward(drive_pid.update(error, dt));
+    // Near the point the direction to it swings around wildly, stop steering
+    double turn = std::hypot(dx, dy) > 6 ? heading_pid.update(turn_error, dt) : 0;
+    // Slow down while facing the wrong way so we turn before we drive
+    forward *= std::fmax(0.0, std::cos(turn_error));
+    output(forward - turn, forward + turn);
+    return false;
+}
+
+// --- Route timing ---
+
+struct RouteEntry {
+    const char* label;
+    MotionResult result;
+};
+
+static constexpr int MAX_ROUTE_ENTRIES = 32;
+static RouteEntry route_entries[MAX_ROUTE_ENTRIES];
+static int route_entry_count = 0;
+static const char* route_name = nullptr;
+static std::uint32_t route_start = 0;
+
+// Last chained and stop-and-go totals of each route, by name
+struct RouteTotals {
+    const char* name;
+    std::uint32_t chained;  // ms, 0 = not run that way yet
+    std::uint32_t stop_go;
+};
+
+static constexpr int MAX_ROUTE_TOTALS = 8;
+static RouteTotals route_totals[MAX_ROUTE_TOTALS];
+static int route_totals_count = 0;
+
+// The route's totals, added if it's new. nullptr for an unnamed route or once the table is full.
+static RouteTotals* totals_for(const char* name) {
+    if (name == nullptr) return nullptr;
+    for (int i = 0; i < route_totals_count; i++) {
+        if (std::strcmp(route_totals[i].name, name) == 0) return &route_totals[i];
+    }
+    if (route_totals_count == MAX_ROUTE_TOTALS) return nullptr;
+    route_totals[route_totals_count] = {name, 0, 0};
+    return &route_totals[route_totals_count++];
+}
+
+void begin_route(const char* name) {
+    route_name = name;
+    route_entry_count = 0;
+    route_start = pros::millis();
+}
+
+void print_route_report() {
+    std::uint32_t total = pros::millis() - route_start;
+    printf("route %s (%s): %lu ms\n", route_name ? route_name : "?", chaining_enabled ? "chained" : "stop-and-go",
+           (unsigned long)total);
+    for (int i = 0; i < route_entry_count; i++) {
+        const MotionResult& r = route_entries[i].result;
+        const char* how = r.chained ? "chained" : (r.timed_out ? "TIMED OUT" : "settled");
+        printf("  %2d %-16s %5lu ms  %s, error %.2f\n", i + 1, route_entries[i].label ? route_entries[i].label : "-",
+               (unsigned long)r.elapsed, how, r.final_error);
+    }
+
+    RouteTotals* totals = totals_for(route_name);
+    if (totals == nullptr) return;
+    if (chaining_enabled) {
+        totals->chained = total;
+    } else {
+        totals->stop_go = total;
+    }
+    if (totals->chained > 0 && totals->stop_go > 0) {
+        printf("  chaining saves %.2f s\n", ((double)totals->stop_go - totals->chained) / 1000.0);
+    }
+}
+
+// --- Blocking helpers ---
+
+MotionResult run_motion(Motion& motion, const char* label) {
+    std::uint32_t wake = pros::millis();
+    motion.start(robot_pose.read(), wake);
+
+    // First step straight away, so the drive is commanded on the tick the move starts
+    while (!motion.step(robot_pose.read(), pros::millis())) {
+        pros::Task::delay_until(&wake, 10);
+    }
+
+    finish_motion(motion, label);
+    return motion.result();
+}
+
+void finish_motion(Motion& motion, const char* label) {
+    // A chained move leaves the drive going for the next one to take over
+    if (!motion.result().chained) {
+        set_drive_voltage(0, 0);
+        carried_forward = 0;
+    }
+
+    if (route_entry_count < MAX_ROUTE_ENTRIES) {
+        route_entries[route_entry_count++] = {label, motion.result()};
+    }
+}
+
+MotionResult drive_distance(double inches, const DriveParams& params) {
+    DriveDistance motion(inches, params);
+    return run_motion(motion);
+}
+
+MotionResult turn_to_heading(double degrees, const DriveParams& params) {
+    TurnToHeading motion(degrees, params);
+    return run_motion(motion);
+}
+
+MotionResult drive_to_point(double x, double y, const DriveParams& params) {
+    DriveToPoint motion(x, y, params);
+    return run_motion(motion);
+}
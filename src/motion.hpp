@@ -0,0 +1,201 @@
+#ifndef MOTION_HPP
+#define MOTION_HPP
+
+#include <cstdint>
+#include "odometry.hpp"
+
+// Closed-loop motion primitives that end as soon as the robot has settled,
+// instead of move_relative followed by a fixed pros::delay.
+//
+// Each move is a Motion object stepped once per control tick, so the same moves
+// can be run blocking (run_motion / drive_distance / ...) or stepped by something
+// else. Distances are in inches. Headings passed in are degrees counter-clockwise,
+// everything worked out from a Pose is radians like Pose::theta.
+
+struct PIDGains {
+    double kp = 0;
+    double ki = 0;
+    double kd = 0;
+    double integral_range = 0;  // only integrate when |error| is below this, 0 = never
+};
+
+class PID {
+public:
+    PID() = default;
+    explicit PID(const PIDGains& gains) : gains(gains) {}
+
+    double update(double error, double dt);
+    void reset();
+
+private:
+    PIDGains gains;
+    double integral = 0;
+    double last_error = 0;
+    bool first = true;
+};
+
+// A move is done when the error stays inside the small window for small_time,
+// or inside the large window for large_time, while moving slower than
+// max_velocity (units per second). timeout ends it regardless.
+// Units are inches for drives and degrees for turns.
+struct ExitConditions {
+    double small_error = 0;
+    std::uint32_t small_time = 0;  // ms
+    double large_error = 0;
+    std::uint32_t large_time = 0;  // ms
+    double max_velocity = 0;       // 0 = don't check
+    std::uint32_t timeout = 0;     // ms, 0 = no timeout
+};
+
+struct DriveParams {
+    double max_voltage = 12000;  // mV
+    ExitConditions exit;
+
+    // Chaining: a move can hand its speed on to the next one instead of stopping.
+    // exit_speed needs an early_exit too, otherwise the move never slows down to settle.
+    double exit_speed = 0;   // in/s, keep driving at least this fast until the move ends
+    double early_exit = 0;   // in (degrees for turns), end the move once this close, without settling
+    double slew = 0;         // mV per tick the forward output may change by, 0 = no limit
+};
+
+struct MotionResult {
+    bool settled = false;
+    bool timed_out = false;
+    bool chained = false;  // ended early to blend into the next move, the drive is still moving
+    std::uint32_t elapsed = 0;  // ms from start to exit
+    double final_error = 0;
+};
+
+class Motion {
+public:
+    virtual ~Motion() = default;
+
+    // Call once before the first step().
+    virtual void start(const Pose& pose, std::uint32_t now);
+
+    // Computes this tick's drive output and sends it. Returns true when the move is finished.
+    virtual bool step(const Pose& pose, std::uint32_t now) = 0;
+
+    const MotionResult& result() const { return motion_result; }
+
+protected:
+    explicit Motion(const DriveParams& params) : params(params), exit(params.exit) {}
+
+    // Updates the exit checks with this tick's error. Returns true when done.
+    bool check_exit(double error, std::uint32_t now);
+
+    // Applies the exit speed floor and slew limit to a PID's forward output (mV).
+    // The slew starts from where the previous move left the drive.
+    double shape_forward(double forward);
+
+    // Scales left / right down together to max_voltage, keeping the turn ratio, and sends them.
+    void output(double left, double right);
+
+    DriveParams params;
+    ExitConditions exit;
+    MotionResult motion_result;
+    std::uint32_t start_time = 0;
+    std::uint32_t last_time = 0;
+    double last_error = 0;
+    bool in_small = false;
+    bool in_large = false;
+    std::uint32_t small_since = 0;  // when the error entered each window
+    std::uint32_t large_since = 0;
+};
+
+// Drives straight along the starting heading, holding that heading.
+class DriveDistance : public Motion {
+public:
+    DriveDistance(double inches, const DriveParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+private:
+    double distance;
+    Pose start_pose;
+    PID drive_pid;
+    PID heading_pid;
+};
+
+// Turns in place to an absolute heading.
+class TurnToHeading : public Motion {
+public:
+    TurnToHeading(double degrees, const DriveParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+private:
+    double target;  // radians
+    PID turn_pid;
+};
+
+// Drives forwards to a field point, steering towards it on the way.
+class DriveToPoint : public Motion {
+public:
+    DriveToPoint(double x, double y, const DriveParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+private:
+    double target_x, target_y;
+    PID drive_pid;
+    PID heading_pid;
+};
+
+// Default gains and exit conditions, tune these
+extern PIDGains drive_gains;
+extern PIDGains heading_gains;
+extern PIDGains turn_gains;
+extern DriveParams default_drive_params;
+extern DriveParams default_turn_params;
+
+// Sends left / right drive voltages (mV), clamped to +-12000.
+void set_drive_voltage(double left, double right);
+
+// Runs a motion to completion at the 10 ms control rate. Stops the drive
+// afterwards unless the move chained into the next one.
+// label names the move in the route report.
+MotionResult run_motion(Motion& motion, const char* label = nullptr);
+
+// What run_motion does once a motion has finished, for code that steps motions itself:
+// stops the drive unless it chained and adds the move to the route report.
+void finish_motion(Motion& motion, const char* label = nullptr);
+
+// Forward output (mV) the drive was left at by the last move, 0 after a stop.
+// Moves that start from the robot's current speed read this.
+double carried_drive_output();
+
+// Set to false to ignore exit_speed / early_exit, e.g. to time the same route stop-and-go.
+extern bool chaining_enabled;
+
+// Per-move timing for a route. begin_route() clears it, every run_motion() adds a
+// line, print_route_report() shows each move and the total. The last chained and
+// stop-and-go totals are kept per route name, so running a route both ways shows the saving.
+void begin_route(const char* name);  // name is kept, so a string literal
+void print_route_report();
+
+// A chained route: the first two moves hand their speed on to the next one
+// instead of stopping, only the last one settles. Run it again with
+// chaining_enabled = false to compare the two in the report.
+//
+//   begin_route("example");
+//   DriveParams through = default_drive_params;
+//   through.exit_speed = 20;
+//   through.early_exit = 4;
+//   through.slew = 600;
+//   DriveToPoint first(24, 0, through);
+//   run_motion(first, "to 24,0");
+//   DriveToPoint second(36, 18, through);
+//   run_motion(second, "to 36,18");
+//   DriveToPoint last(36, 36, default_drive_params);
+//   run_motion(last, "to 36,36");
+//   print_route_report();
+
+MotionResult drive_distance(double inches, const DriveParams& params = default_drive_params);
+MotionResult turn_to_heading(double degrees, const DriveParams& params = default_turn_params);
+MotionResult drive_to_point(double x, double y, const DriveParams& params = default_drive_params);
+
+// Heading error wrapped into -pi..pi
+double angle_error(double target, double current);
+
+#endif
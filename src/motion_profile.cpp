@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cmath>
+#include "main.h"
+#include "motion_profile.hpp"
+
+DriveFeedforward drive_feedforward = {.kS = 500, .kV = 340, .kA = 40, .kT = 800};
+PIDGains profile_gains = {.kp = 600, .ki = 0, .kd = 0, .integral_range = 0};
+ProfileLimits default_profile_limits = {.max_velocity = 48, .max_acceleration = 80, .max_jerk = 0};
+
+double DriveFeedforward::calculate(double velocity, double acceleration) const {
+    double sign = velocity > 0 ? 1 : (velocity < 0 ? -1 : 0);
+    return kS * sign + kV * velocity + kA * acceleration;
+}
+
+double DriveFeedforward::turn(double angular_velocity) const {
+    return kT * std::clamp(angular_velocity / 0.1, -1.0, 1.0);
+}
+
+// --- Profile generation ---
+
+namespace {
+
+// The profile is a sequence of constant-jerk segments
+struct Segment {
+    double duration;
+    double jerk;
+};
+
+struct State {
+    double p, v, a;
+};
+
+State advance(const State& s, double jerk, double t) {
+    return {s.p + s.v * t + s.a * t * t / 2 + jerk * t * t * t / 6,
+            s.v + s.a * t + jerk * t * t / 2,
+            s.a + jerk * t};
+}
+
+// Time spent at constant jerk and at constant acceleration to get from 0 to v
+void ramp_times(double v, double a_max, double j_max, double& t_jerk, double& t_accel) {
+    if (j_max <= 0) {
+        t_jerk = 0;
+        t_accel = v / a_max;
+        return;
+    }
+    double a_peak = std::fmin(a_max, std::sqrt(v * j_max));
+    if (a_peak <= 0) {
+        // v is 0, there's no ramp (and v / a_peak would be 0 / 0)
+        t_jerk = t_accel = 0;
+        return;
+    }
+    t_jerk = a_peak / j_max;
+    t_accel = v / a_peak - t_jerk;
+}
+
+// Distance covered ramping from 0 to v (the ramp is symmetric, so the average speed is v / 2)
+double ramp_distance(double v, double a_max, double j_max) {
+    double t_jerk, t_accel;
+    ramp_times(v, a_max, j_max, t_jerk, t_accel);
+    return v * (2 * t_jerk + t_accel) / 2;
+}
+
+// Trapezoid: accelerate, cruise, decelerate
+State trapezoid_at(double t, double a, double t_accel, double t_cruise) {
+    double t1 = std::fmin(t, t_accel);
+    State s = advance({0, 0, a}, 0, t1);
+    if (t <= t_accel) return s;
+
+    double t2 = std::fmin(t - t_accel, t_cruise);
+    s = advance({s.p, s.v, 0}, 0, t2);
+    if (t <= t_accel + t_cruise) return s;
+
+    double t3 = std::fmin(t - t_accel - t_cruise, t_accel);
+    s = advance({s.p, s.v, -a}, 0, t3);
+    if (t3 >= t_accel) s.a = 0;
+    return s;
+}
+
+}  // namespace
+
+bool MotionProfile::generate(double distance, const ProfileLimits& limits, std::uint32_t dt_ms) {
+    count = 0;
+    step_ms = dt_ms;
+    if (dt_ms == 0 || limits.max_velocity <= 0 || limits.max_acceleration <= 0) return false;
+
+    double direction = distance < 0 ? -1 : 1;
+    double length = std::fabs(distance);
+    double a_max = limits.max_acceleration;
+    double j_max = limits.max_jerk;
+
+    // Nothing to move: one sample at rest on the target
+    constexpr double MIN_LENGTH = 1e-6;  // in
+    if (!(length > MIN_LENGTH)) {
+        if (!std::isfinite(distance)) return false;
+        points[0] = {static_cast<float>(distance), 0, 0};
+        count = 1;
+        return true;
+    }
+
+    // Too short to reach max velocity: find the peak we can reach and still stop in time
+    double v_peak = limits.max_velocity;
+    if (2 * ramp_distance(v_peak, a_max, j_max) > length) {
+        double low = 0, high = v_peak;
+        for (int i = 0; i < 50; i++) {
+            double mid = (low + high) / 2;
+            if (2 * ramp_distance(mid, a_max, j_max) > length) {
+                high = mid;
+            } else {
+                low = mid;
+            }
+        }
+        v_peak = low;
+    }
+
+    double t_jerk, t_accel;
+    ramp_times(v_peak, a_max, j_max, t_jerk, t_accel);
+    double t_cruise = v_peak > 0 ? (length - 2 * ramp_distance(v_peak, a_max, j_max)) / v_peak : 0;
+    double a_peak = j_max > 0 ? t_jerk * j_max : a_max;
+
+    // With no jerk limit the acceleration steps, which is a zero length jerk segment
+    Segment segments[7];
+    int segment_count = 0;
+    if (j_max > 0) {
+        segments[segment_count++] = {t_jerk, j_max};
+        segments[segment_count++] = {t_accel, 0};
+        segments[segment_count++] = {t_jerk, -j_max};
+        segments[segment_count++] = {t_cruise, 0};
+        segments[segment_count++] = {t_jerk, -j_max};
+        segments[segment_count++] = {t_accel, 0};
+        segments[segment_count++] = {t_jerk, j_max};
+    }
+
+    double total = j_max > 0 ? 4 * t_jerk + 2 * t_accel + t_cruise : 2 * t_accel + t_cruise;
+    double dt = dt_ms / 1000.0;
+    // A peak too small to move on leaves the times at 0 / 0, don't let NaN reach the cast
+    if (!(v_peak > 0) || !std::isfinite(total) || total / dt > CAPACITY) return false;
+    int ticks = static_cast<int>(std::ceil(total / dt)) + 1;
+    if (ticks > CAPACITY) return false;
+
+    for (int i = 0; i < ticks; i++) {
+        double t = std::fmin(i * dt, total);
+        State s = {0, 0, 0};
+
+        if (j_max > 0) {
+            for (int k = 0; k < segment_count && t > 0; k++) {
+                double in_segment = std::fmin(t, segments[k].duration);
+                s = advance(s, segments[k].jerk, in_segment);
+                t -= in_segment;
+            }
+        } else {
+            s = trapezoid_at(t, a_peak, t_accel, t_cruise);
+        }
+
+        points[i].position = direction * s.p;
+        points[i].velocity = direction * s.v;
+        points[i].acceleration = direction * s.a;
+    }
+
+    // Land exactly on the target
+    points[ticks - 1] = {static_cast<float>(distance), 0, 0};
+    count = ticks;
+    return true;
+}
+
+// --- Follower ---
+
+ProfiledDrive::ProfiledDrive(const MotionProfile& profile, const DriveParams& params)
+    : Motion(params), profile(profile), position_pid(profile_gains),
+      heading_pid(heading_gains) {}
+
+void ProfiledDrive::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    start_pose = pose;
+    position_pid.reset();
+    heading_pid.reset();
+}
+
+bool ProfiledDrive::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+    int tick = (now - start_time) / profile.dt_ms();
+    const ProfilePoint& target = profile.at(tick);
+
+    double dx = pose.x - start_pose.x;
+    double dy = pose.y - start_pose.y;
+    double travelled = dx * std::cos(start_pose.theta) + dy * std::sin(start_pose.theta);
+    double error = target.position - travelled;
+
+    // Only look at exiting once the profile itself is done
+    if (tick >= profile.size() - 1) {
+        double final_error = profile.at(profile.size() - 1).position - travelled;
+        if (check_exit(final_error, now)) return true;
+    } else {
+        last_time = now;
+        motion_result.elapsed = now - start_time;
+    }
+
+    double forward = drive_feedforward.calculate(target.velocity, target.acceleration) + position_pid.update(error, dt);
+    double turn = heading_pid.update(angle_error(start_pose.theta, pose.theta), dt);
+
+    output(forward - turn, forward + turn);
+    return false;
+}
+
+MotionResult profiled_drive(double inches, const ProfileLimits& limits, const DriveParams& params) {
+    // One buffer reused for every blocking profiled move
+    static MotionProfile profile;
+    if (!profile.generate(inches, limits)) {
+        printf("profiled_drive: %.1f in doesn't fit in the profile buffer\n", inches);
+        return MotionResult{};
+    }
+
+    ProfiledDrive motion(profile, params);
+    return run_motion(motion);
+}
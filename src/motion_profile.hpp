@@ -0,0 +1,85 @@
+#ifndef MOTION_PROFILE_HPP
+#define MOTION_PROFILE_HPP
+
+#include <cstdint>
+#include "motion.hpp"
+
+// Trapezoidal and jerk-limited (S-curve) motion profiles.
+// The whole profile is worked out before the move starts into a fixed buffer,
+// one setpoint per control tick, so following it is just a table lookup.
+
+struct ProfileLimits {
+    double max_velocity = 0;      // in/s
+    double max_acceleration = 0;  // in/s^2
+    double max_jerk = 0;          // in/s^3, 0 = trapezoid
+};
+
+struct ProfilePoint {
+    float position = 0;      // in
+    float velocity = 0;      // in/s
+    float acceleration = 0;  // in/s^2
+};
+
+class MotionProfile {
+public:
+    static constexpr int CAPACITY = 1000;  // 10 s at 10 ms
+
+    // Fills the buffer for a move of `distance` inches (negative = backwards).
+    // Uses an S-curve if limits.max_jerk is set, otherwise a trapezoid.
+    // Returns false if the move doesn't fit in the buffer.
+    bool generate(double distance, const ProfileLimits& limits, std::uint32_t dt_ms = 10);
+
+    int size() const { return count; }
+    std::uint32_t dt_ms() const { return step_ms; }
+    std::uint32_t duration_ms() const { return count > 0 ? (count - 1) * step_ms : 0; }
+
+    // Setpoint for a control tick, holds the last one past the end
+    const ProfilePoint& at(int tick) const { return points[tick < count ? tick : count - 1]; }
+
+private:
+    ProfilePoint points[CAPACITY];
+    int count = 0;
+    std::uint32_t step_ms = 10;
+};
+
+// Feedforward: voltage (mV) = kS * sign(v) + kV * v + kA * a
+struct DriveFeedforward {
+    double kS = 0;
+    double kV = 0;
+    double kA = 0;
+    double kT = 0;  // mV per side against the wheels scrubbing sideways in a turn
+
+    double calculate(double velocity, double acceleration) const;
+
+    // Extra voltage for turning at angular_velocity (rad/s, counter-clockwise),
+    // added to the right side and taken off the left. Ramps in up to 0.1 rad/s
+    // so it doesn't chatter when driving straight.
+    double turn(double angular_velocity) const;
+};
+
+extern DriveFeedforward drive_feedforward;
+extern PIDGains profile_gains;  // feedback on position error along the profile
+
+// Follows a straight-line profile with feedforward plus feedback, holding the
+// starting heading. Finishes once the profile has ended and the exit conditions are met.
+class ProfiledDrive : public Motion {
+public:
+    ProfiledDrive(const MotionProfile& profile, const DriveParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+private:
+    const MotionProfile& profile;
+    Pose start_pose;
+    PID position_pid;
+    PID heading_pid;
+};
+
+// Default limits for profiled_drive, tune these
+extern ProfileLimits default_profile_limits;
+
+// Generates a profile then follows it, blocking.
+MotionResult profiled_drive(double inches, const ProfileLimits& limits = default_profile_limits,
+                            const DriveParams& params = default_drive_params);
+
+#endif
@@ -0,0 +1,84 @@
+#include "motor_outputs.hpp"
+
+MotorOutputs motor_outputs;
+
+void MotorOutputs::move(std::int8_t port, std::int32_t value) { queue(port, MotorMode::MOVE, value); }
+void MotorOutputs::voltage(std::int8_t port, std::int32_t millivolts) { queue(port, MotorMode::VOLTAGE, millivolts); }
+void MotorOutputs::velocity(std::int8_t port, std::int32_t rpm) { queue(port, MotorMode::VELOCITY, rpm); }
+void MotorOutputs::brake(std::int8_t port) { queue(port, MotorMode::BRAKE, 0); }
+
+void MotorOutputs::move(const pros::MotorGroup& group, std::int32_t value) { queue(group, MotorMode::MOVE, value); }
+void MotorOutputs::voltage(const pros::MotorGroup& group, std::int32_t millivolts) {
+    queue(group, MotorMode::VOLTAGE, millivolts);
+}
+void MotorOutputs::velocity(const pros::MotorGroup& group, std::int32_t rpm) {
+    queue(group, MotorMode::VELOCITY, rpm);
+}
+void MotorOutputs::brake(const pros::MotorGroup& group) { queue(group, MotorMode::BRAKE, 0); }
+
+void MotorOutputs::move(std::span<const std::int8_t> group_ports, std::int32_t value) {
+    queue(group_ports, MotorMode::MOVE, value);
+}
+void MotorOutputs::voltage(std::span<const std::int8_t> group_ports, std::int32_t millivolts) {
+    queue(group_ports, MotorMode::VOLTAGE, millivolts);
+}
+void MotorOutputs::velocity(std::span<const std::int8_t> group_ports, std::int32_t rpm) {
+    queue(group_ports, MotorMode::VELOCITY, rpm);
+}
+void MotorOutputs::brake(std::span<const std::int8_t> group_ports) { queue(group_ports, MotorMode::BRAKE, 0); }
+
+void MotorOutputs::queue(std::int8_t port, MotorMode mode, std::int32_t value) {
+    int index = (port < 0 ? -port : port) - 1;
+    if (index < 0 || index >= 21) return;
+
+    // A second command for the same port in one tick just replaces the first
+    PortState& p = ports[index];
+    p.port = port;
+    p.pending_mode = mode;
+    p.pending_value = value;
+    output_stats.queued++;
+}
+
+void MotorOutputs::queue(const pros::MotorGroup& group, MotorMode mode, std::int32_t value) {
+    for (int i = 0; i < group.size(); i++) {
+        queue(group.get_port(i), mode, value);
+    }
+}
+
+void MotorOutputs::queue(std::span<const std::int8_t> group_ports, MotorMode mode, std::int32_t value) {
+    for (std::int8_t port : group_ports) {
+        queue(port, mode, value);
+    }
+}
+
+void MotorOutputs::flush() {
+    std::uint32_t now = pros::millis();
+
+    for (PortState& p : ports) {
+        if (p.pending_mode == MotorMode::NONE) continue;
+
+        bool same = p.pending_mode == p.sent_mode && p.pending_value == p.sent_value;
+        if (!same || now - p.sent_time >= REFRESH_MS) {
+            switch (p.pending_mode) {
+                case MotorMode::MOVE: pros::c::motor_move(p.port, p.pending_value); break;
+                case MotorMode::VOLTAGE: pros::c::motor_move_voltage(p.port, p.pending_value); break;
+                case MotorMode::VELOCITY: pros::c::motor_move_velocity(p.port, p.pending_value); break;
+                case MotorMode::BRAKE: pros::c::motor_brake(p.port); break;
+                case MotorMode::NONE: break;
+            }
+            p.sent_mode = p.pending_mode;
+            p.sent_value = p.pending_value;
+            p.sent_time = now;
+            output_stats.issued++;
+        }
+        p.pending_mode = MotorMode::NONE;
+    }
+
+    output_stats.suppressed = output_stats.queued - output_stats.issued;
+}
+
+void MotorOutputs::invalidate_all() {
+    for (PortState& p : ports) {
+        p.sent_mode = MotorMode::NONE;
+    }
+}
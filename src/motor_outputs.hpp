@@ -0,0 +1,83 @@
+#ifndef MOTOR_OUTPUTS_HPP
+#define MOTOR_OUTPUTS_HPP
+
+#include <cstdint>
+#include <span>
+#include "main.h"
+
+// Write-coalescing layer in front of the motors.
+// Commands are queued during a tick and flush() sends at most one per port,
+// dropping any that match what the motor was last told to do.
+
+enum class MotorMode : std::uint8_t {
+    NONE,      // nothing sent yet / unknown
+    MOVE,      // motor_move, -127 to 127
+    VOLTAGE,   // motor_move_voltage, millivolts
+    VELOCITY,  // motor_move_velocity, rpm
+    BRAKE
+};
+
+struct MotorOutputStats {
+    std::uint32_t queued = 0;
+    std::uint32_t issued = 0;      // commands that actually went to a motor
+    std::uint32_t suppressed = 0;  // queued - issued
+};
+
+class MotorOutputs {
+public:
+    // Unchanged commands are still resent this often (ms) in case a motor was
+    // unplugged and lost its last command.
+    static constexpr std::uint32_t REFRESH_MS = 500;
+
+    // Ports are signed like pros::Motor, negative means reversed.
+    void move(std::int8_t port, std::int32_t value);
+    void voltage(std::int8_t port, std::int32_t millivolts);
+    void velocity(std::int8_t port, std::int32_t rpm);
+    void brake(std::int8_t port);
+
+    void move(const pros::Motor& motor, std::int32_t value) { move(motor.get_port(), value); }
+    void voltage(const pros::Motor& motor, std::int32_t millivolts) { voltage(motor.get_port(), millivolts); }
+    void velocity(const pros::Motor& motor, std::int32_t rpm) { velocity(motor.get_port(), rpm); }
+    void brake(const pros::Motor& motor) { brake(motor.get_port()); }
+
+    void move(const pros::MotorGroup& group, std::int32_t value);
+    void voltage(const pros::MotorGroup& group, std::int32_t millivolts);
+    void velocity(const pros::MotorGroup& group, std::int32_t rpm);
+    void brake(const pros::MotorGroup& group);
+
+    // For groups that keep their own port list, e.g. FixedMotorGroup::ports()
+    void move(std::span<const std::int8_t> group_ports, std::int32_t value);
+    void voltage(std::span<const std::int8_t> group_ports, std::int32_t millivolts);
+    void velocity(std::span<const std::int8_t> group_ports, std::int32_t rpm);
+    void brake(std::span<const std::int8_t> group_ports);
+
+    // Sends the queued commands. Call once at the end of every control tick.
+    void flush();
+
+    // Forget what was sent, e.g. after code outside this layer drove the motors.
+    void invalidate_all();
+
+    const MotorOutputStats& stats() const { return output_stats; }
+    void reset_stats() { output_stats = MotorOutputStats{}; }
+
+private:
+    struct PortState {
+        std::int8_t port = 0;  // signed port of the last queued command
+        MotorMode pending_mode = MotorMode::NONE;
+        std::int32_t pending_value = 0;
+        MotorMode sent_mode = MotorMode::NONE;
+        std::int32_t sent_value = 0;
+        std::uint32_t sent_time = 0;
+    };
+
+    void queue(std::int8_t port, MotorMode mode, std::int32_t value);
+    void queue(const pros::MotorGroup& group, MotorMode mode, std::int32_t value);
+    void queue(std::span<const std::int8_t> group_ports, MotorMode mode, std::int32_t value);
+
+    PortState ports[21];
+    MotorOutputStats output_stats;
+};
+
+extern MotorOutputs motor_outputs;
+
+#endif
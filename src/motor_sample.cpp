@@ -0,0 +1,65 @@
+#include "motor_sample.hpp"
+
+// Motors past CAPACITY aren't sampled, say so rather than quietly averaging part of a group
+static int bound_count(int size) {
+    if (size <= MotorGroupSnapshot::CAPACITY) return size;
+    printf("motor_sample: group of %d motors, only the first %d are sampled\n", size, MotorGroupSnapshot::CAPACITY);
+    return MotorGroupSnapshot::CAPACITY;
+}
+
+void MotorGroupSnapshot::bind(const pros::MotorGroup& group) {
+    int size = bound_count(group.size());
+
+    count = size;
+    for (int i = 0; i < size; i++) {
+        ports[i] = group.get_port(i);
+    }
+    fields = 0;
+}
+
+void MotorGroupSnapshot::bind(std::span<const std::int8_t> group_ports) {
+    int group_size = bound_count(static_cast<int>(group_ports.size()));
+
+    count = group_size;
+    for (int i = 0; i < group_size; i++) {
+        ports[i] = group_ports[i];
+    }
+    fields = 0;
+}
+
+void MotorGroupSnapshot::sample(std::uint16_t field_mask) {
+    using namespace pros::c;
+
+    // One motor at a time so all of a motor's fields come from the same moment
+    for (int i = 0; i < count; i++) {
+        std::int8_t port = ports[i];
+        if (field_mask & FIELD_POSITION) position[i] = motor_get_position(port);
+        if (field_mask & FIELD_VELOCITY) velocity[i] = motor_get_actual_velocity(port);
+        if (field_mask & FIELD_CURRENT) current[i] = motor_get_current_draw(port);
+        if (field_mask & FIELD_TEMPERATURE) temperature[i] = motor_get_temperature(port);
+        if (field_mask & FIELD_TORQUE) torque[i] = motor_get_torque(port);
+        if (field_mask & FIELD_VOLTAGE) voltage[i] = motor_get_voltage(port);
+        if (field_mask & FIELD_POWER) power[i] = motor_get_power(port);
+        if (field_mask & FIELD_EFFICIENCY) efficiency[i] = motor_get_efficiency(port);
+        if (field_mask & FIELD_RAW_POSITION) raw_position[i] = motor_get_raw_position(port, &raw_timestamp[i]);
+        if (field_mask & FIELD_FAULTS) faults[i] = motor_get_faults(port);
+        if (field_mask & FIELD_FLAGS) flags[i] = motor_get_flags(port);
+    }
+
+    fields = field_mask;
+    time = pros::millis();
+}
+
+double MotorGroupSnapshot::average_position() const {
+    if (count == 0) return 0;
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += position[i];
+    return sum / count;
+}
+
+double MotorGroupSnapshot::average_velocity() const {
+    if (count == 0) return 0;
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += velocity[i];
+    return sum / count;
+}
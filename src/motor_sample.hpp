@@ -0,0 +1,61 @@
+#ifndef MOTOR_SAMPLE_HPP
+#define MOTOR_SAMPLE_HPP
+
+#include <cstdint>
+#include <span>
+#include "main.h"
+
+// Batched motor telemetry without the per-call vectors of MotorGroup::get_*_all().
+// The ports are captured once with bind(), then sample() reads the chosen fields
+// of every motor in one pass into fixed arrays (struct-of-arrays), so a snapshot
+// can live on the stack and sampling never allocates or takes the group's mutex.
+
+enum MotorField : std::uint16_t {
+    FIELD_POSITION = 1 << 0,
+    FIELD_VELOCITY = 1 << 1,
+    FIELD_CURRENT = 1 << 2,
+    FIELD_TEMPERATURE = 1 << 3,
+    FIELD_TORQUE = 1 << 4,
+    FIELD_VOLTAGE = 1 << 5,
+    FIELD_POWER = 1 << 6,
+    FIELD_EFFICIENCY = 1 << 7,
+    FIELD_RAW_POSITION = 1 << 8,  // also fills raw_timestamp
+    FIELD_FAULTS = 1 << 9,
+    FIELD_FLAGS = 1 << 10,
+    FIELD_ALL = 0x07FF
+};
+
+struct MotorGroupSnapshot {
+    static constexpr int CAPACITY = 8;
+
+    std::int8_t ports[CAPACITY] = {};
+    std::uint8_t count = 0;
+    std::uint16_t fields = 0;  // fields filled by the last sample()
+    std::uint32_t time = 0;    // pros::millis() of the last sample()
+
+    double position[CAPACITY] = {};
+    double velocity[CAPACITY] = {};
+    std::int32_t current[CAPACITY] = {};  // mA
+    double temperature[CAPACITY] = {};    // C
+    double torque[CAPACITY] = {};         // Nm
+    std::int32_t voltage[CAPACITY] = {};  // mV
+    double power[CAPACITY] = {};          // W
+    double efficiency[CAPACITY] = {};     // %
+    std::int32_t raw_position[CAPACITY] = {};
+    std::uint32_t raw_timestamp[CAPACITY] = {};
+    std::uint32_t faults[CAPACITY] = {};
+    std::uint32_t flags[CAPACITY] = {};
+
+    // Captures the ports of a group. Call once at init, not every tick. Only
+    // the first CAPACITY motors of a bigger group are kept, with a warning printed.
+    void bind(const pros::MotorGroup& group);
+    void bind(std::span<const std::int8_t> group_ports);
+
+    // Reads the selected fields of every bound motor.
+    void sample(std::uint16_t field_mask = FIELD_ALL);
+
+    double average_position() const;
+    double average_velocity() const;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "main.h"
+#include "odometry.hpp"
+#include "globals.hpp"
+#include "motor_sample.hpp"
+
+PoseBuffer robot_pose;
+
+void PoseBuffer::publish(const Pose& pose) {
+    std::uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    x.store(pose.x, std::memory_order_relaxed);
+    y.store(pose.y, std::memory_order_relaxed);
+    theta.store(pose.theta, std::memory_order_relaxed);
+    timestamp.store(pose.timestamp, std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+Pose PoseBuffer::read() const {
+    Pose pose;
+    while (true) {
+        std::uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;  // publish in progress
+
+        pose.x = x.load(std::memory_order_relaxed);
+        pose.y = y.load(std::memory_order_relaxed);
+        pose.theta = theta.load(std::memory_order_relaxed);
+        pose.timestamp = timestamp.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) return pose;
+    }
+}
+
+void DriveOdometry::reset(const Pose& start, std::int32_t left_counts, std::int32_t right_counts,
+                          double imu_rotation) {
+    current = start;
+    last_left = left_counts;
+    last_right = right_counts;
+    last_imu = imu_rotation;
+    linear_vel = 0;
+    angular_vel = 0;
+}
+
+bool DriveOdometry::update(std::int32_t left_counts, std::int32_t right_counts, std::uint32_t timestamp,
+                           double imu_rotation) {
+    // Motors only report new data every 10 ms, don't integrate the same sample twice
+    if (current.timestamp != 0 && timestamp == current.timestamp) return false;
+
+    double left = (left_counts - last_left) / config.counts_per_inch;
+    double right = (right_counts - last_right) / config.counts_per_inch;
+    last_left = left_counts;
+    last_right = right_counts;
+
+    // Heading change: encoders are noisy under scrub, so lean on the IMU when there is one
+    double d_theta = (right - left) / config.track_width;
+    if (!std::isnan(imu_rotation) && !std::isnan(last_imu)) {
+        d_theta = config.imu_weight * (imu_rotation - last_imu) + (1 - config.imu_weight) * d_theta;
+    }
+    last_imu = imu_rotation;
+
+    // Treat the move as an arc: travel along its chord at the average heading
+    double distance = (left + right) / 2;
+    double chord = distance;
+    if (std::fabs(d_theta) > 1e-9) {
+        chord = 2 * (distance / d_theta) * std::sin(d_theta / 2);
+    }
+    double mid_theta = current.theta + d_theta / 2;
+    current.x += chord * std::cos(mid_theta);
+    current.y += chord * std::sin(mid_theta);
+    current.theta += d_theta;
+
+    // Velocities from device time, not from when this task happened to wake up
+    if (current.timestamp != 0) {
+        double dt = (timestamp - current.timestamp) / 1000.0;
+        if (dt > 0) {
+            linear_vel = distance / dt;
+            angular_vel = d_theta / dt;
+        }
+    }
+    current.timestamp = timestamp;
+    return true;
+}
+
+// --- Odometry task ---
+
+static pros::Task* odometry_task = nullptr;
+// A seqlock like robot_pose, so a set_odometry_pose() while the odometry task
+// is taking the last one can't hand it half of each
+static PoseBuffer pending_pose;
+static std::atomic<bool> pose_reset_pending{false};
+
+void set_odometry_pose(const Pose& pose) {
+    pending_pose.publish(pose);
+    pose_reset_pending.store(true, std::memory_order_release);
+    robot_pose.publish(pose);
+}
+
+bool take_odometry_reset(Pose& pose) {
+    if (!pose_reset_pending.exchange(false, std::memory_order_acquire)) return false;
+    pose = pending_pose.read();
+    return true;
+}
+
+double imu_rotation_rad() {
+    if (imu.is_calibrating()) return NAN;
+    double degrees = imu.get_rotation();
+    if (degrees == PROS_ERR_F) return NAN;
+    return -degrees * M_PI / 180.0;
+}
+
+namespace {
+
+// One side of the drive read as a single encoder. Each tick it moves by the
+// average of its motors' movement since the last tick, so a motor reporting
+// PROS_ERR (unplugged or browning out) is left out instead of summing INT32_MAX
+// into the side, and the side doesn't jump when it comes back.
+struct SideEncoder {
+    double counts = 0;
+    std::int32_t last[MotorGroupSnapshot::CAPACITY] = {};
+    bool seen[MotorGroupSnapshot::CAPACITY] = {};
+
+    // False if no motor on the side reported this tick. timestamp is raised to
+    // the newest reading.
+    bool update(const MotorGroupSnapshot& side, std::uint32_t& timestamp) {
+        std::int64_t moved = 0;
+        int moving = 0;
+        bool any = false;
+        for (int i = 0; i < side.count; i++) {
+            std::int32_t raw = side.raw_position[i];
+            if (raw == PROS_ERR) {
+                seen[i] = false;
+                continue;
+            }
+            any = true;
+            if (seen[i]) {
+                moved += static_cast<std::int64_t>(raw) - last[i];
+                moving++;
+            }
+            last[i] = raw;
+            seen[i] = true;
+            if (side.raw_timestamp[i] > timestamp) timestamp = side.raw_timestamp[i];
+        }
+        if (moving > 0) counts += static_cast<double>(moved) / moving;
+        return any;
+    }
+
+    std::int32_t value() const { return static_cast<std::int32_t>(std::lround(counts)); }
+};
+
+}  // namespace
+
+static void odometry_task_fn(void* param) {
+    DriveOdometryConfig config;
+    config.counts_per_inch = drive_counts_per_rev / (drive_wheel_diameter * M_PI);
+    config.track_width = drive_track_width;
+    DriveOdometry odom(config);
+
+    MotorGroupSnapshot left, right;
+    left.bind(left_mg.ports());
+    right.bind(right_mg.ports());
+    SideEncoder left_side, right_side;
+
+    bool started = false;
+    std::uint32_t wake = pros::millis();
+
+    while (true) {
+        left.sample(FIELD_RAW_POSITION);
+        right.sample(FIELD_RAW_POSITION);
+
+        // Use the newest device timestamp of the motors that reported. With a
+        // whole side out there's nothing to integrate, hold the pose this tick.
+        std::uint32_t timestamp = 0;
+        bool left_ok = left_side.update(left, timestamp);
+        bool right_ok = right_side.update(right, timestamp);
+        if (!left_ok || !right_ok) {
+            pros::Task::delay_until(&wake, 5);
+            continue;
+        }
+        std::int32_t left_counts = left_side.value(), right_counts = right_side.value();
+        double imu_rotation = imu_rotation_rad();
+
+        Pose start;
+        bool reset = take_odometry_reset(start);
+        if (reset || !started) {
+            if (!reset) start = robot_pose.read();
+            odom.reset(start, left_counts, right_counts, imu_rotation);
+            started = true;
+        } else if (odom.update(left_counts, right_counts, timestamp, imu_rotation)) {
+            robot_pose.publish(odom.pose());
+        }
+
+        pros::Task::delay_until(&wake, 5);
+    }
+}
+
+void start_odometry() {
+    if (odometry_task != nullptr) return;
+    odometry_task = new pros::Task(odometry_task_fn, nullptr, TASK_PRIORITY_MAX - 2, TASK_STACK_DEPTH_DEFAULT,
+                                   "Odometry");
+}
@@ -0,0 +1,85 @@
+#ifndef ODOMETRY_HPP
+#define ODOMETRY_HPP
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// Robot pose estimate.
+// x / y are in inches, theta is in radians counter-clockwise from the starting
+// heading, timestamp is the device time (ms) of the encoder data it came from.
+struct Pose {
+    double x = 0;
+    double y = 0;
+    double theta = 0;
+    std::uint32_t timestamp = 0;
+};
+
+// Single writer, many readers. The odometry task publishes, anyone can read
+// without blocking the writer: a read that overlaps a publish just retries.
+class PoseBuffer {
+public:
+    void publish(const Pose& pose);
+    Pose read() const;
+
+private:
+    std::atomic<std::uint32_t> sequence{0};  // odd while a publish is in progress
+    std::atomic<double> x{0}, y{0}, theta{0};
+    std::atomic<std::uint32_t> timestamp{0};
+};
+
+// The pose every motion / auton routine reads from
+extern PoseBuffer robot_pose;
+
+struct DriveOdometryConfig {
+    double counts_per_inch = 0;  // raw encoder counts per inch of wheel travel
+    double track_width = 0;      // inches between the left and right wheels
+    double imu_weight = 0.98;    // 0 = encoder heading only, 1 = IMU heading only
+};
+
+// Integrates drive encoder deltas into a pose. No PROS calls in here so the
+// math can be run against recorded encoder traces off the robot.
+class DriveOdometry {
+public:
+    explicit DriveOdometry(const DriveOdometryConfig& config) : config(config) {}
+
+    // Starts integrating from the given pose with the given encoder / IMU readings.
+    void reset(const Pose& start, std::int32_t left_counts, std::int32_t right_counts, double imu_rotation);
+
+    // left / right are raw encoder counts (averaged per side) with the device
+    // timestamp they were taken at. imu_rotation is the IMU's continuous rotation
+    // in radians counter-clockwise, or NAN if there is no IMU reading.
+    // Returns false (and changes nothing) if the encoder data hasn't updated.
+    bool update(std::int32_t left_counts, std::int32_t right_counts, std::uint32_t timestamp, double imu_rotation);
+
+    const Pose& pose() const { return current; }
+
+    // Forward speed (in/s) and turn rate (rad/s) over the last update
+    double linear_velocity() const { return linear_vel; }
+    double angular_velocity() const { return angular_vel; }
+
+private:
+    DriveOdometryConfig config;
+    Pose current;
+    std::int32_t last_left = 0;
+    std::int32_t last_right = 0;
+    double last_imu = NAN;
+    double linear_vel = 0;
+    double angular_vel = 0;
+};
+
+// Starts the background drive-encoder odometry task (high priority, 5 ms).
+// Safe to call more than once. Only one odometry task should publish to robot_pose.
+void start_odometry();
+
+// Sets the pose the running odometry task integrates from, e.g. the auton start position.
+// Any task can call it, but only one at a time.
+void set_odometry_pose(const Pose& pose);
+
+// For odometry tasks: returns true (once) with the pose passed to set_odometry_pose().
+bool take_odometry_reset(Pose& pose);
+
+// IMU rotation in radians counter-clockwise, or NAN while it can't be trusted.
+double imu_rotation_rad();
+
+#endif
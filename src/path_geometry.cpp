@@ -0,0 +1,198 @@
+#include <cmath>
+#include "path_geometry.hpp"
+
+double Curve::curvature(double u) const {
+    Vec2 d = derivative(u);
+    Vec2 dd = second_derivative(u);
+    double speed = std::hypot(d.x, d.y);
+    if (speed < 1e-9) return 0;
+    return (d.x * dd.y - d.y * dd.x) / (speed * speed * speed);
+}
+
+double Curve::heading(double u) const {
+    Vec2 d = derivative(u);
+    return std::atan2(d.y, d.x);
+}
+
+// --- QuinticHermite ---
+
+static void quintic_coefficients(double p0, double d0, double dd0, double p1, double d1, double dd1, double* c) {
+    c[0] = p0;
+    c[1] = d0;
+    c[2] = dd0 / 2;
+    c[3] = -10 * p0 - 6 * d0 - 1.5 * dd0 + 0.5 * dd1 - 4 * d1 + 10 * p1;
+    c[4] = 15 * p0 + 8 * d0 + 1.5 * dd0 - dd1 + 7 * d1 - 15 * p1;
+    c[5] = -6 * p0 - 3 * d0 - 0.5 * dd0 + 0.5 * dd1 - 3 * d1 + 6 * p1;
+}
+
+QuinticHermite::QuinticHermite(Vec2 p0, Vec2 d0, Vec2 dd0, Vec2 p1, Vec2 d1, Vec2 dd1) {
+    quintic_coefficients(p0.x, d0.x, dd0.x, p1.x, d1.x, dd1.x, cx);
+    quintic_coefficients(p0.y, d0.y, dd0.y, p1.y, d1.y, dd1.y, cy);
+}
+
+Vec2 QuinticHermite::position(double u) const {
+    double x = ((((cx[5] * u + cx[4]) * u + cx[3]) * u + cx[2]) * u + cx[1]) * u + cx[0];
+    double y = ((((cy[5] * u + cy[4]) * u + cy[3]) * u + cy[2]) * u + cy[1]) * u + cy[0];
+    return {x, y};
+}
+
+Vec2 QuinticHermite::derivative(double u) const {
+    double x = (((5 * cx[5] * u + 4 * cx[4]) * u + 3 * cx[3]) * u + 2 * cx[2]) * u + cx[1];
+    double y = (((5 * cy[5] * u + 4 * cy[4]) * u + 3 * cy[3]) * u + 2 * cy[2]) * u + cy[1];
+    return {x, y};
+}
+
+Vec2 QuinticHermite::second_derivative(double u) const {
+    double x = ((20 * cx[5] * u + 12 * cx[4]) * u + 6 * cx[3]) * u + 2 * cx[2];
+    double y = ((20 * cy[5] * u + 12 * cy[4]) * u + 6 * cy[3]) * u + 2 * cy[2];
+    return {x, y};
+}
+
+// --- CubicBezier ---
+
+CubicBezier::CubicBezier(Vec2 p0, Vec2 p1, Vec2 p2, Vec2 p3) : p{p0, p1, p2, p3} {}
+
+Vec2 CubicBezier::position(double u) const {
+    double v = 1 - u;
+    double b0 = v * v * v, b1 = 3 * v * v * u, b2 = 3 * v * u * u, b3 = u * u * u;
+    return {b0 * p[0].x + b1 * p[1].x + b2 * p[2].x + b3 * p[3].x,
+            b0 * p[0].y + b1 * p[1].y + b2 * p[2].y + b3 * p[3].y};
+}
+
+Vec2 CubicBezier::derivative(double u) const {
+    double v = 1 - u;
+    double b0 = 3 * v * v, b1 = 6 * v * u, b2 = 3 * u * u;
+    return {b0 * (p[1].x - p[0].x) + b1 * (p[2].x - p[1].x) + b2 * (p[3].x - p[2].x),
+            b0 * (p[1].y - p[0].y) + b1 * (p[2].y - p[1].y) + b2 * (p[3].y - p[2].y)};
+}
+
+Vec2 CubicBezier::second_derivative(double u) const {
+    double v = 1 - u;
+    return {6 * v * (p[2].x - 2 * p[1].x + p[0].x) + 6 * u * (p[3].x - 2 * p[2].x + p[1].x),
+            6 * v * (p[2].y - 2 * p[1].y + p[0].y) + 6 * u * (p[3].y - 2 * p[2].y + p[1].y)};
+}
+
+// --- Arc length ---
+
+double integrate_arc_length(const Curve& curve, double u0, double u1, int intervals) {
+    // 5-point Gauss-Legendre on each interval
+    static const double nodes[5] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640,
+                                    0.9061798459386640};
+    static const double weights[5] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665,
+                                      0.2369268850561891, 0.2369268850561891};
+
+    double total = 0;
+    double width = (u1 - u0) / intervals;
+    for (int i = 0; i < intervals; i++) {
+        double a = u0 + i * width;
+        double half = width / 2;
+        double mid = a + half;
+        for (int k = 0; k < 5; k++) {
+            Vec2 d = curve.derivative(mid + half * nodes[k]);
+            total += weights[k] * half * std::hypot(d.x, d.y);
+        }
+    }
+    return total;
+}
+
+void ArcLengthTable::build(const Curve& curve) {
+    double s = 0;
+    lengths[0] = 0;
+    for (int i = 1; i < SIZE; i++) {
+        s += integrate_arc_length(curve, static_cast<double>(i - 1) / (SIZE - 1), static_cast<double>(i) / (SIZE - 1));
+        lengths[i] = s;
+    }
+}
+
+double ArcLengthTable::parameter_at(double s) const {
+    if (s <= 0) return 0;
+    if (s >= lengths[SIZE - 1]) return 1;
+
+    // First entry at or past s
+    int low = 0, high = SIZE - 1;
+    while (high - low > 1) {
+        int mid = (low + high) / 2;
+        if (lengths[mid] < s) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    double span = lengths[high] - lengths[low];
+    double f = span > 0 ? (s - lengths[low]) / span : 0;
+    return (low + f) / (SIZE - 1);
+}
+
+// --- SplinePath ---
+
+bool SplinePath::build(const Waypoint* waypoints, int count, double tangent_scale) {
+    segment_count = 0;
+    if (count < 2 || count - 1 > MAX_SEGMENTS) return false;
+
+    for (int i = 0; i < count - 1; i++) {
+        const Waypoint& a = waypoints[i];
+        const Waypoint& b = waypoints[i + 1];
+        double scale = tangent_scale * std::hypot(b.x - a.x, b.y - a.y);
+
+        // Zero second derivative at the waypoints: curvature is zero there, so it's
+        // continuous from one segment to the next
+        add_segment(QuinticHermite({a.x, a.y}, {std::cos(a.heading) * scale, std::sin(a.heading) * scale}, {0, 0},
+                                   {b.x, b.y}, {std::cos(b.heading) * scale, std::sin(b.heading) * scale}, {0, 0}));
+    }
+    return true;
+}
+
+bool SplinePath::build_bezier(const Vec2* control_points, int count) {
+    segment_count = 0;
+    if (count < 4 || (count - 1) % 3 != 0 || (count - 1) / 3 > MAX_SEGMENTS) return false;
+
+    for (int i = 0; i + 3 < count; i += 3) {
+        // A cubic is the quintic that matches its position and first two
+        // derivatives at both ends, so it's stored as one exactly
+        CubicBezier b(control_points[i], control_points[i + 1], control_points[i + 2], control_points[i + 3]);
+        add_segment(QuinticHermite(b.position(0), b.derivative(0), b.second_derivative(0), b.position(1),
+                                   b.derivative(1), b.second_derivative(1)));
+    }
+    return true;
+}
+
+void SplinePath::add_segment(const QuinticHermite& segment) {
+    int i = segment_count++;
+    segments[i] = segment;
+    tables[i].build(segments[i]);
+    segment_start[i] = i > 0 ? segment_start[i - 1] + tables[i - 1].length() : 0;
+}
+
+CurvePoint SplinePath::sample(double s) const {
+    CurvePoint point;
+    if (segment_count == 0) return point;
+
+    double total = length();
+    if (s < 0) s = 0;
+    if (s > total) s = total;
+
+    int i = segment_count - 1;
+    while (i > 0 && segment_start[i] > s) i--;
+
+    double u = tables[i].parameter_at(s - segment_start[i]);
+    Vec2 p = segments[i].position(u);
+    point.x = p.x;
+    point.y = p.y;
+    point.heading = segments[i].heading(u);
+    point.curvature = segments[i].curvature(u);
+    point.s = s;
+    return point;
+}
+
+int SplinePath::inject_points(double spacing, CurvePoint* out, int capacity) const {
+    if (segment_count == 0 || spacing <= 0 || capacity < 1) return 0;
+
+    double total = length();
+    int count = 0;
+    for (double s = 0; s < total && count < capacity - 1; s += spacing) {
+        out[count++] = sample(s);
+    }
+    out[count++] = sample(total);
+    return count;
+}
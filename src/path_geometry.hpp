@@ -0,0 +1,124 @@
+#ifndef PATH_GEOMETRY_HPP
+#define PATH_GEOMETRY_HPP
+
+// Path geometry: quintic Hermite splines and cubic Bezier curves.
+// Each curve gets an arc-length lookup table when it's built, so finding the
+// point a given distance along a path is a binary search, not an integration.
+//
+// No PROS includes, this is shared with the host tools (tools/pathc).
+
+struct Vec2 {
+    double x = 0;
+    double y = 0;
+};
+
+// A point on a path with what a follower needs to know about it
+struct CurvePoint {
+    double x = 0;
+    double y = 0;
+    double heading = 0;    // rad, counter-clockwise
+    double curvature = 0;  // 1/in, positive turning left
+    double s = 0;          // arc length from the start of the path
+};
+
+// A curve over the parameter u = 0 to 1
+class Curve {
+public:
+    virtual ~Curve() = default;
+    virtual Vec2 position(double u) const = 0;
+    virtual Vec2 derivative(double u) const = 0;
+    virtual Vec2 second_derivative(double u) const = 0;
+
+    double curvature(double u) const;
+    double heading(double u) const;
+};
+
+// Quintic Hermite segment: matches position, first and second derivative at both ends,
+// so chained segments have continuous curvature.
+class QuinticHermite : public Curve {
+public:
+    QuinticHermite() = default;
+    QuinticHermite(Vec2 p0, Vec2 d0, Vec2 dd0, Vec2 p1, Vec2 d1, Vec2 dd1);
+
+    Vec2 position(double u) const override;
+    Vec2 derivative(double u) const override;
+    Vec2 second_derivative(double u) const override;
+
+private:
+    // Polynomial coefficients, c[0] + c[1] u + ... + c[5] u^5
+    double cx[6] = {};
+    double cy[6] = {};
+};
+
+class CubicBezier : public Curve {
+public:
+    CubicBezier() = default;
+    CubicBezier(Vec2 p0, Vec2 p1, Vec2 p2, Vec2 p3);
+
+    Vec2 position(double u) const override;
+    Vec2 derivative(double u) const override;
+    Vec2 second_derivative(double u) const override;
+
+private:
+    Vec2 p[4];
+};
+
+// Arc length at evenly spaced parameters along a curve
+class ArcLengthTable {
+public:
+    static constexpr int SIZE = 65;
+
+    void build(const Curve& curve);
+
+    double length() const { return lengths[SIZE - 1]; }
+
+    // Parameter u at arc length s along the curve (binary search then linear interpolation)
+    double parameter_at(double s) const;
+
+private:
+    float lengths[SIZE] = {};
+};
+
+// Arc length of a curve between two parameters, by Gauss-Legendre quadrature.
+// Used for the tables, and as a reference to check them against.
+double integrate_arc_length(const Curve& curve, double u0, double u1, int intervals = 1);
+
+struct Waypoint {
+    double x = 0;
+    double y = 0;
+    double heading = 0;  // rad, counter-clockwise
+};
+
+// Quintic spline through a list of waypoints, or a chain of cubic Beziers,
+// sampled by distance along it
+class SplinePath {
+public:
+    static constexpr int MAX_SEGMENTS = 16;
+
+    // tangent_scale sets how far each waypoint's heading carries into the segment,
+    // as a fraction of the segment's straight-line length
+    bool build(const Waypoint* waypoints, int count, double tangent_scale = 1.0);
+
+    // Cubic Bezier segments from 3 * segments + 1 control points: an end point,
+    // two handles, the next end point and so on. Smooth only where each end
+    // point is in line with the handles either side of it.
+    bool build_bezier(const Vec2* control_points, int count);
+
+    double length() const { return segment_count > 0 ? segment_start[segment_count - 1] + tables[segment_count - 1].length() : 0; }
+
+    // Point at arc length s from the start, clamped to the ends
+    CurvePoint sample(double s) const;
+
+    // Points every `spacing` inches (plus the end point), returns how many were written
+    int inject_points(double spacing, CurvePoint* out, int capacity) const;
+
+private:
+    void add_segment(const QuinticHermite& segment);
+
+    QuinticHermite segments[MAX_SEGMENTS];
+    ArcLengthTable tables[MAX_SEGMENTS];
+    double segment_start[MAX_SEGMENTS] = {};  // arc length where each segment starts
+    int segment_count = 0;
+};
+
+#endif
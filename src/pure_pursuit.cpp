@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include "main.h"
+#include "pure_pursuit.hpp"
+#include "motion_profile.hpp"
+#include "globals.hpp"
+
+PursuitParams default_pursuit_params;
+
+// --- Path ---
+
+void Path::clear() {
+    count = 0;
+    waypoint_count = 0;
+}
+
+bool Path::add_waypoint(double x, double y) {
+    if (waypoint_count >= MAX_WAYPOINTS) return false;
+    waypoint_x[waypoint_count] = x;
+    waypoint_y[waypoint_count] = y;
+    waypoint_count++;
+    return true;
+}
+
+bool Path::build(double spacing, double max_velocity, double max_acceleration, double turn_speed) {
+    count = 0;
+    if (waypoint_count < 2 || spacing <= 0) return false;
+
+    // Inject points every `spacing` inches along each segment
+    float s = 0;
+    for (int w = 0; w < waypoint_count - 1; w++) {
+        double dx = waypoint_x[w + 1] - waypoint_x[w];
+        double dy = waypoint_y[w + 1] - waypoint_y[w];
+        double length = std::hypot(dx, dy);
+        int steps = static_cast<int>(length / spacing);
+        for (int i = 0; i < steps; i++) {
+            if (count >= CAPACITY - 1) return false;
+            double f = i * spacing / length;
+            points[count].x = waypoint_x[w] + dx * f;
+            points[count].y = waypoint_y[w] + dy * f;
+            count++;
+        }
+    }
+    points[count].x = waypoint_x[waypoint_count - 1];
+    points[count].y = waypoint_y[waypoint_count - 1];
+    count++;
+
+    for (int i = 0; i < count; i++) {
+        if (i > 0) s += std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y);
+        points[i].s = s;
+    }
+
+    // Waypoints all on top of each other leave nothing to follow
+    if (count < 2) {
+        count = 0;
+        return false;
+    }
+    compute_curvature();
+    limit_velocity(max_velocity, max_acceleration, turn_speed);
+    return true;
+}
+
+bool Path::build(const SplinePath& spline, double spacing, double max_velocity, double max_acceleration,
+                 double turn_speed) {
+    count = 0;
+    waypoint_count = 0;
+    if (spacing <= 0 || spline.length() / spacing + 2 > CAPACITY) return false;
+
+    // Spline points go through the point buffer, curvature comes from the spline itself
+    static CurvePoint curve_points[CAPACITY];
+    count = spline.inject_points(spacing, curve_points, CAPACITY);
+    for (int i = 0; i < count; i++) {
+        points[i].x = curve_points[i].x;
+        points[i].y = curve_points[i].y;
+        points[i].s = curve_points[i].s;
+        points[i].curvature = curve_points[i].curvature;
+    }
+
+    // An unbuilt or empty spline gives no points
+    if (count < 2) {
+        count = 0;
+        return false;
+    }
+    limit_velocity(max_velocity, max_acceleration, turn_speed);
+    return true;
+}
+
+bool Path::set_points(const PathPoint* path_points, int point_count) {
+    if (point_count < 1 || point_count > CAPACITY) return false;
+    for (int i = 0; i < point_count; i++) {
+        points[i] = path_points[i];
+    }
+    count = point_count;
+    waypoint_count = 0;
+    return true;
+}
+
+void Path::compute_curvature() {
+    // Curvature of the circle through each point and its neighbours
+    for (int i = 0; i < count; i++) {
+        points[i].curvature = 0;
+        if (i == 0 || i == count - 1) continue;
+
+        double ax = points[i - 1].x, ay = points[i - 1].y;
+        double bx = points[i].x, by = points[i].y;
+        double cx = points[i + 1].x, cy = points[i + 1].y;
+        double cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        double product = std::hypot(bx - ax, by - ay) * std::hypot(cx - bx, cy - by) * std::hypot(cx - ax, cy - ay);
+        if (product > 1e-9) points[i].curvature = 2 * cross / product;
+    }
+}
+
+void Path::limit_velocity(double max_velocity, double max_acceleration, double turn_speed) {
+    if (count == 0) return;
+    for (int i = 0; i < count; i++) {
+        double limit = max_velocity;
+        double k = std::fabs(points[i].curvature);
+        if (k > 1e-6) limit = std::fmin(limit, turn_speed / k);
+        points[i].max_velocity = limit;
+    }
+
+    // Come to a stop at the end, and slow down early enough for each curve
+    points[count - 1].max_velocity = 0;
+    for (int i = count - 2; i >= 0; i--) {
+        double ds = points[i + 1].s - points[i].s;
+        double reachable = std::sqrt(points[i + 1].max_velocity * points[i + 1].max_velocity + 2 * max_acceleration * ds);
+        points[i].max_velocity = std::fmin(points[i].max_velocity, reachable);
+    }
+}
+
+// --- PurePursuit ---
+
+PurePursuit::PurePursuit(const Path& path, const PursuitParams& params)
+    : Motion(params.drive), path(path), pursuit(params) {}
+
+void PurePursuit::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    closest = 0;
+    lookahead_index = 0;
+    // Pick up from however fast the last move left the drive going
+    target_velocity = std::fmax(0.0, (carried_drive_output() - drive_feedforward.kS) / drive_feedforward.kV);
+}
+
+int PurePursuit::find_closest(const Pose& pose) {
+    // The robot only moves forward along the path, so only look a few points past last tick
+    int end = std::min(path.size(), closest + pursuit.search_window + 1);
+    double best = 1e9;
+    int best_index = closest;
+    for (int i = closest; i < end; i++) {
+        double d = std::hypot(path[i].x - pose.x, path[i].y - pose.y);
+        if (d < best) {
+            best = d;
+            best_index = i;
+        }
+    }
+    return best_index;
+}
+
+void PurePursuit::lookahead_point(double distance, double& x, double& y) {
+    // Walk forward from where we were, the lookahead index never goes backwards
+    double target_s = path[closest].s + distance;
+    if (lookahead_index < closest) lookahead_index = closest;
+    while (lookahead_index < path.size() - 1 && path[lookahead_index + 1].s < target_s) {
+        lookahead_index++;
+    }
+
+    if (lookahead_index >= path.size() - 1) {
+        x = path[path.size() - 1].x;
+        y = path[path.size() - 1].y;
+        return;
+    }
+
+    // Interpolate between the two points around the target arc length
+    const PathPoint& a = path[lookahead_index];
+    const PathPoint& b = path[lookahead_index + 1];
+    double f = b.s > a.s ? (target_s - a.s) / (b.s - a.s) : 0;
+    f = std::fmax(0.0, std::fmin(1.0, f));
+    x = a.x + (b.x - a.x) * f;
+    y = a.y + (b.y - a.y) * f;
+}
+
+bool PurePursuit::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+    closest = find_closest(pose);
+    const PathPoint& end = path[path.size() - 1];
+
+    // Near the end, finish like a drive-to-point on the remaining distance
+    double to_end = std::hypot(end.x - pose.x, end.y - pose.y);
+    if (closest >= path.size() - 2 || path.length() - path[closest].s < pursuit.min_lookahead) {
+        if (check_exit(to_end, now)) return true;
+    } else {
+        last_time = now;
+        motion_result.elapsed = now - start_time;
+        if (exit.timeout > 0 && motion_result.elapsed >= exit.timeout) {
+            motion_result.timed_out = true;
+            return true;
+        }
+    }
+
+    // Target speed: the path's curvature limit, but don't speed up faster than max_acceleration
+    double limit = path[closest].max_velocity;
+    target_velocity = std::fmin(limit, target_velocity + pursuit.max_acceleration * dt);
+    // The last point's limit is 0, keep creeping in until the exit conditions are met
+    if (target_velocity < 2 && to_end > 0.5) target_velocity = 2;
+    // Chaining into another move, don't slow down below the exit speed
+    if (target_velocity < params.exit_speed) target_velocity = params.exit_speed;
+
+    // Look further ahead when fast, closer in tight curves
+    double lookahead = pursuit.min_lookahead + pursuit.lookahead_gain * target_velocity;
+    lookahead /= 1 + pursuit.curvature_shrink * std::fabs(path[closest].curvature);
+    lookahead = std::fmax(pursuit.min_lookahead, std::fmin(pursuit.max_lookahead, lookahead));
+
+    double lx, ly;
+    lookahead_point(lookahead, lx, ly);
+
+    // Curvature of the arc from the robot to the lookahead point
+    double dx = lx - pose.x;
+    double dy = ly - pose.y;
+    double side = -std::sin(pose.theta) * dx + std::cos(pose.theta) * dy;  // sideways offset, left positive
+    double distance_sq = dx * dx + dy * dy;
+    double curvature = distance_sq > 1e-6 ? 2 * side / distance_sq : 0;
+
+    // Wheel speeds for that arc, through the drive feedforward
+    double left_velocity = target_velocity * (1 - curvature * drive_track_width / 2);
+    double right_velocity = target_velocity * (1 + curvature * drive_track_width / 2);
+    double left = drive_feedforward.calculate(left_velocity, 0);
+    double right = drive_feedforward.calculate(right_velocity, 0);
+
+    output(left, right);
+    return false;
+}
+
+MotionResult follow_path(const Path& path, const PursuitParams& params) {
+    if (path.size() < 2) return MotionResult{};
+    PurePursuit motion(path, params);
+    return run_motion(motion);
+}
@@ -0,0 +1,96 @@
+#ifndef PURE_PURSUIT_HPP
+#define PURE_PURSUIT_HPP
+
+#include <cstdint>
+#include "motion.hpp"
+#include "path_geometry.hpp"
+
+// Pure pursuit path following.
+// A Path is a list of evenly spaced points with arc length, curvature and a
+// curvature-limited velocity all worked out before the move. The follower only
+// ever searches a small window ahead of where it was last tick, so a tick costs
+// the same however long the path is.
+
+struct PathPoint {
+    float x = 0;
+    float y = 0;
+    float s = 0;             // arc length from the start, in
+    float curvature = 0;     // 1/in, positive turning left
+    float max_velocity = 0;  // in/s
+};
+
+class Path {
+public:
+    static constexpr int CAPACITY = 512;
+    static constexpr int MAX_WAYPOINTS = 32;
+
+    void clear();
+
+    // Adds a waypoint in field inches. Returns false once the path is full.
+    bool add_waypoint(double x, double y);
+
+    // Fills in evenly spaced points between the waypoints, then the arc length,
+    // curvature and velocity of each one. turn_speed sets how hard it slows down
+    // in curves: max velocity at a point is turn_speed / curvature.
+    bool build(double spacing, double max_velocity, double max_acceleration, double turn_speed);
+
+    // Same as build(), but the points come from a spline instead of straight
+    // lines between the waypoints.
+    bool build(const SplinePath& spline, double spacing, double max_velocity, double max_acceleration,
+               double turn_speed);
+
+    // Uses already built points as-is, e.g. from a precompiled trajectory.
+    bool set_points(const PathPoint* path_points, int point_count);
+
+    int size() const { return count; }
+    const PathPoint& operator[](int i) const { return points[i]; }
+    double length() const { return count > 0 ? points[count - 1].s : 0; }
+
+private:
+    void compute_curvature();
+    void limit_velocity(double max_velocity, double max_acceleration, double turn_speed);
+
+    PathPoint points[CAPACITY];
+    int count = 0;
+    float waypoint_x[MAX_WAYPOINTS];
+    float waypoint_y[MAX_WAYPOINTS];
+    int waypoint_count = 0;
+};
+
+struct PursuitParams {
+    double min_lookahead = 8;      // in
+    double max_lookahead = 20;     // in
+    double lookahead_gain = 0.3;   // extra lookahead per in/s of speed
+    double curvature_shrink = 40;  // lookahead is divided by (1 + this * |curvature|)
+    double max_acceleration = 60;  // in/s^2, how fast the target speed may rise
+    int search_window = 10;        // points searched ahead of the last closest point
+    DriveParams drive = default_drive_params;
+};
+
+class PurePursuit : public Motion {
+public:
+    PurePursuit(const Path& path, const PursuitParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+    // How far along the path the robot is, in
+    double progress() const { return path[closest].s; }
+
+private:
+    int find_closest(const Pose& pose);
+    void lookahead_point(double distance, double& x, double& y);
+
+    const Path& path;
+    PursuitParams pursuit;
+    int closest = 0;
+    int lookahead_index = 0;
+    double target_velocity = 0;
+};
+
+// Default lookahead and limits for follow_path, tune these
+extern PursuitParams default_pursuit_params;
+
+// Follows a path to its end, blocking.
+MotionResult follow_path(const Path& path, const PursuitParams& params = default_pursuit_params);
+
+#endif
@@ -0,0 +1,85 @@
+#include <cmath>
+#include "main.h"
+#include "ramsete.hpp"
+#include "motion_profile.hpp"
+#include "globals.hpp"
+
+RamseteGains ramsete_gains;
+
+void ramsete(const Pose& pose, const TrajectorySample& reference, const RamseteGains& gains, double& velocity,
+             double& angular_velocity) {
+    // Error in the robot's frame
+    double dx = reference.x - pose.x;
+    double dy = reference.y - pose.y;
+    double error_x = std::cos(pose.theta) * dx + std::sin(pose.theta) * dy;
+    double error_y = -std::sin(pose.theta) * dx + std::cos(pose.theta) * dy;
+    double error_theta = angle_error(reference.theta, pose.theta);
+
+    double v_ref = reference.velocity;
+    double w_ref = reference.angular_velocity;
+    // The gain goes to zero with the reference speed, so without the floor the
+    // robot would stop wherever it is once the trajectory has ended
+    double k = std::fmax(2 * gains.zeta * std::sqrt(w_ref * w_ref + gains.b * v_ref * v_ref), gains.min_k);
+    double sinc = std::fabs(error_theta) < 1e-6 ? 1 : std::sin(error_theta) / error_theta;
+
+    velocity = v_ref * std::cos(error_theta) + k * error_x;
+    angular_velocity = w_ref + k * error_theta + gains.b * v_ref * sinc * error_y;
+}
+
+TrajectoryTracker::TrajectoryTracker(const TrajectoryTable& table, const RamseteGains& gains,
+                                     const DriveParams& params)
+    : Motion(params), table(table), gains(gains) {
+    // The timeout is for settling on the end, so it starts once the trajectory is over
+    if (exit.timeout > 0) exit.timeout += (table.count - 1) * table.dt_ms;
+}
+
+void TrajectoryTracker::start(const Pose& pose, std::uint32_t now) {
+    Motion::start(pose, now);
+    stream.reset(table);
+    stream.seek(0, reference);
+    last_left = last_right = 0;
+}
+
+bool TrajectoryTracker::step(const Pose& pose, std::uint32_t now) {
+    double dt = (now - last_time) / 1000.0;
+    std::uint32_t elapsed = now - start_time;
+    stream.seek(elapsed, reference);
+
+    if (elapsed >= stream.duration()) {
+        double to_end = std::hypot(reference.x - pose.x, reference.y - pose.y);
+        if (check_exit(to_end, now)) return true;
+    } else {
+        last_time = now;
+        motion_result.elapsed = elapsed;
+    }
+
+    double velocity, angular_velocity;
+    ramsete(pose, reference, gains, velocity, angular_velocity);
+
+    double left = velocity - angular_velocity * drive_track_width / 2;
+    double right = velocity + angular_velocity * drive_track_width / 2;
+    double left_accel = dt > 0 ? (left - last_left) / dt : 0;
+    double right_accel = dt > 0 ? (right - last_right) / dt : 0;
+    last_left = left;
+    last_right = right;
+
+    double turn = drive_feedforward.turn(angular_velocity);
+    double left_voltage = drive_feedforward.calculate(left, left_accel) - turn;
+    double right_voltage = drive_feedforward.calculate(right, right_accel) + turn;
+    output(left_voltage, right_voltage);
+    return false;
+}
+
+MotionResult follow_trajectory(const TrajectoryTable& table, const DriveParams& params) {
+    TrajectoryTracker motion(table, ramsete_gains, params);
+    return run_motion(motion);
+}
+
+MotionResult follow_trajectory(const char* name, const DriveParams& params) {
+    const TrajectoryTable* table = find_trajectory(name);
+    if (table == nullptr) {
+        printf("follow_trajectory: no trajectory called %s\n", name);
+        return MotionResult{};
+    }
+    return follow_trajectory(*table, params);
+}
@@ -0,0 +1,48 @@
+#ifndef RAMSETE_HPP
+#define RAMSETE_HPP
+
+#include <cstdint>
+#include "motion.hpp"
+#include "trajectory.hpp"
+
+// RAMSETE trajectory tracking for the differential drive.
+// Follows a time-indexed trajectory and corrects along-track, cross-track and
+// heading error together, so it can stay on a fast route without slowing down.
+
+struct RamseteGains {
+    double b = 0.0013;  // 1/in^2, how hard to correct (2 rad^2/m^2 in inches)
+    double zeta = 0.7;  // damping, 0 to 1
+    double min_k = 2;   // 1/s, floor on the correction gain so it still closes on a reference that has stopped
+};
+
+// Commanded forward speed (in/s) and turn rate (rad/s) to get back onto the reference
+void ramsete(const Pose& pose, const TrajectorySample& reference, const RamseteGains& gains, double& velocity,
+             double& angular_velocity);
+
+extern RamseteGains ramsete_gains;
+
+// Streams a precompiled trajectory and tracks it with RAMSETE, turning wheel
+// speeds into voltages with the drive feedforward. Once the trajectory is over
+// it finishes on the exit conditions, measured as distance from the end point.
+// The odometry pose should be set to the trajectory's start first.
+class TrajectoryTracker : public Motion {
+public:
+    TrajectoryTracker(const TrajectoryTable& table, const RamseteGains& gains, const DriveParams& params);
+    void start(const Pose& pose, std::uint32_t now) override;
+    bool step(const Pose& pose, std::uint32_t now) override;
+
+private:
+    const TrajectoryTable& table;
+    RamseteGains gains;
+    TrajectoryStream stream;
+    TrajectorySample reference;
+    double last_left = 0;  // wheel speeds last tick, in/s
+    double last_right = 0;
+};
+
+MotionResult follow_trajectory(const TrajectoryTable& table, const DriveParams& params = default_drive_params);
+
+// By the name in the path file. Returns a zero result if there's no such trajectory.
+MotionResult follow_trajectory(const char* name, const DriveParams& params = default_drive_params);
+
+#endif
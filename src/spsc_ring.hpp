@@ -0,0 +1,72 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free ring buffer for one producer task and one consumer task.
+// Fixed storage, no allocation, and push never blocks: when the ring is full
+// the item is dropped and counted instead. The producer only writes head and
+// the consumer only writes tail, so neither ever waits on the other.
+//
+// No PROS includes, the host tools use it too.
+
+template <typename T, std::size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    static constexpr std::size_t CAPACITY = N;
+
+    // Producer side. Returns false (and counts a drop) if the ring is full.
+    bool push(const T& item) {
+        std::uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail == N) {
+            // Only look at the consumer's index when our copy says we're full
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail == N) {
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool pop(T& item) {
+        std::uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies up to max items out in one go, returns how many.
+    std::size_t pop_many(T* out, std::size_t max) {
+        std::uint32_t t = tail.load(std::memory_order_relaxed);
+        std::uint32_t available = head.load(std::memory_order_acquire) - t;
+        std::size_t count = available < max ? available : max;
+        for (std::size_t i = 0; i < count; i++) {
+            out[i] = slots[(t + i) & (N - 1)];
+        }
+        tail.store(t + static_cast<std::uint32_t>(count), std::memory_order_release);
+        return count;
+    }
+
+    // Approximate from either side, exact from neither while the other is running
+    std::size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    std::uint32_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    // Producer and consumer indices on separate cache lines so they don't bounce
+    alignas(64) std::atomic<std::uint32_t> head{0};
+    std::uint32_t cached_tail = 0;  // producer's last look at tail
+    alignas(64) std::atomic<std::uint32_t> tail{0};
+    alignas(64) std::atomic<std::uint32_t> dropped_count{0};
+    T slots[N];
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <cstdint>
+
+// Telemetry records pushed from the control loop.
+// Fixed 32-byte records so the control loop only ever copies a few words into
+// the ring (spsc_ring.hpp), and a low priority logger task takes them from there.
+//
+// This header is the record schema for the logs too and is shared with the host
+// tools, so no PROS includes in here. Bump TELEMETRY_SCHEMA_VERSION whenever a
+// record changes.
+
+constexpr std::uint16_t TELEMETRY_SCHEMA_VERSION = 1;
+
+enum TelemetryType : std::uint8_t {
+    TELEMETRY_DRIVE = 1,
+    TELEMETRY_MECHANISMS = 2,
+    TELEMETRY_LOOP = 3,
+};
+
+// Record flags. Each producer task numbers its records on its own, the flag says whose they are.
+constexpr std::uint8_t TELEMETRY_FLAG_AUTON = 1 << 0;  // from the autonomous sampler, not the driver control loop
+
+struct DriveTelemetry {
+    float x, y, theta;                    // pose, in and rad
+    std::int16_t left_mv, right_mv;       // average voltage per side
+    std::int16_t left_rpm, right_rpm;     // average velocity per side
+    std::int16_t left_ma, right_ma;       // total current per side
+};
+
+struct MechanismTelemetry {
+    std::int16_t intake_mv, lift_mv;
+    std::int16_t intake_rpm, lift_rpm;
+    std::int16_t intake_ma, lift_ma;
+    float lift_position;  // degrees
+    std::uint8_t pad[8];
+};
+
+struct LoopTelemetry {
+    std::uint32_t exec_us;     // time the last tick's subsystems took
+    std::uint32_t jitter_us;   // |tick spacing - period| of the last tick
+    std::uint32_t overruns;    // totals since the loop's stats were reset
+    std::uint32_t skipped_ticks;
+    std::uint8_t pad[8];
+};
+
+struct TelemetryRecord {
+    std::uint32_t time_ms;
+    std::uint8_t type;   // TelemetryType
+    std::uint8_t flags;  // TELEMETRY_FLAG_*
+    std::uint16_t seq;   // counts up per record pushed by its producer, gaps mean drops
+    union {
+        DriveTelemetry drive;
+        MechanismTelemetry mechanisms;
+        LoopTelemetry loop;
+    };
+};
+
+// --- Log files ---
+// A log is a TelemetryFileHeader padded out to TELEMETRY_FILE_HEADER_SIZE, then
+// blocks back to back: a TelemetryBlockHeader followed by stored_size bytes of
+// payload. Unpacked, a payload is record_count records (at most
+// TELEMETRY_RECORDS_PER_BLOCK). Every block decodes on its own.
+//
+// Alongside each log is an index file (same name, .idx) of TelemetryIndexEntry,
+// one per block, so a reader can seek by time without walking the whole log.
+// A reader can also rebuild it by walking the block headers.
+
+constexpr std::uint16_t TELEMETRY_FORMAT_VERSION = 2;        // 2: LZ4 blocks and index
+constexpr std::uint32_t TELEMETRY_FILE_MAGIC = 0x4C543556;   // "V5TL"
+constexpr std::uint32_t TELEMETRY_BLOCK_MAGIC = 0x4B4C4254;  // "TBLK"
+constexpr std::uint32_t TELEMETRY_FILE_HEADER_SIZE = 512;    // one SD sector
+constexpr std::uint32_t TELEMETRY_BLOCK_SIZE = 4096;         // header + records of a full block, unpacked
+
+// Block flags
+constexpr std::uint16_t TELEMETRY_BLOCK_LZ4 = 1 << 0;       // payload is one LZ4 block (lz4_block.hpp)
+constexpr std::uint16_t TELEMETRY_BLOCK_SHUFFLED = 1 << 1;  // records stored byte-transposed, see below
+
+struct TelemetryFileHeader {
+    std::uint32_t magic;           // TELEMETRY_FILE_MAGIC
+    std::uint16_t schema_version;  // TELEMETRY_SCHEMA_VERSION of the writer
+    std::uint16_t record_size;     // sizeof(TelemetryRecord)
+    std::uint32_t block_size;      // TELEMETRY_BLOCK_SIZE
+    std::uint32_t start_ms;        // brain time the log was opened
+    std::uint16_t format_version;  // TELEMETRY_FORMAT_VERSION
+    std::uint8_t pad[14];
+};
+
+struct TelemetryBlockHeader {
+    std::uint32_t magic;  // TELEMETRY_BLOCK_MAGIC
+    std::uint32_t index;  // counts up from 0 within a log
+    std::uint16_t record_count;
+    std::uint16_t flags;  // TELEMETRY_BLOCK_*
+    std::uint32_t first_time_ms;
+    std::uint32_t last_time_ms;
+    std::uint32_t dropped;      // records dropped from the ring before this block was started, total
+    std::uint32_t stored_size;  // payload bytes following this header
+    std::uint8_t pad[4];
+};
+
+struct TelemetryIndexEntry {
+    std::uint32_t block;   // TelemetryBlockHeader::index
+    std::uint32_t offset;  // of the block header in the log
+    std::uint32_t first_time_ms;
+    std::uint32_t last_time_ms;
+};
+
+constexpr std::uint32_t TELEMETRY_RECORDS_PER_BLOCK =
+    (TELEMETRY_BLOCK_SIZE - sizeof(TelemetryBlockHeader)) / sizeof(TelemetryRecord);
+
+// Byte-transposes count records: byte k of every record goes together. Fields
+// that barely change from record to record (times, types, slow signals) then
+// become long runs, which LZ4 does much better on.
+inline void telemetry_shuffle(const void* records, std::uint8_t* out, std::uint32_t count) {
+    const std::uint8_t* in = static_cast<const std::uint8_t*>(records);
+    for (std::uint32_t k = 0; k < sizeof(TelemetryRecord); k++) {
+        for (std::uint32_t i = 0; i < count; i++) {
+            out[k * count + i] = in[i * sizeof(TelemetryRecord) + k];
+        }
+    }
+}
+
+inline void telemetry_unshuffle(const std::uint8_t* in, void* records, std::uint32_t count) {
+    std::uint8_t* out = static_cast<std::uint8_t*>(records);
+    for (std::uint32_t k = 0; k < sizeof(TelemetryRecord); k++) {
+        for (std::uint32_t i = 0; i < count; i++) {
+            out[i * sizeof(TelemetryRecord) + k] = in[k * count + i];
+        }
+    }
+}
+
+static_assert(sizeof(TelemetryFileHeader) == 32 && sizeof(TelemetryBlockHeader) == 32);
+static_assert(sizeof(TelemetryIndexEntry) == 16);
+static_assert(sizeof(DriveTelemetry) == 24 && sizeof(MechanismTelemetry) == 24 && sizeof(LoopTelemetry) == 24);
+static_assert(sizeof(TelemetryRecord) == 32, "telemetry records are read back by the host tools, keep them 32 bytes");
+
+#endif
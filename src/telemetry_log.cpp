@@ -0,0 +1,395 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include "main.h"
+#include "telemetry_log.hpp"
+#include "globals.hpp"
+#include "lz4_block.hpp"
+#include "motor_sample.hpp"
+#include "odometry.hpp"
+
+TelemetryProducer driver_telemetry(0);
+TelemetryProducer auton_telemetry(TELEMETRY_FLAG_AUTON);
+
+// The logger drains these, in this order
+static TelemetryProducer* const producers[] = {&auton_telemetry, &driver_telemetry};
+
+// --- Producer ---
+
+static void push(TelemetryProducer& producer, TelemetryRecord& record, TelemetryType type) {
+    record.time_ms = pros::millis();
+    record.type = type;
+    record.flags = producer.flags;
+    // Counted even when the push fails, so the gap shows up in the log
+    record.seq = producer.next_seq++;
+    producer.ring.push(record);
+}
+
+static std::int16_t clamp16(double value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return static_cast<std::int16_t>(value);
+}
+
+void telemetry_sample_drive(TelemetryProducer& producer) {
+    MotorGroupSnapshot& left = producer.left;
+    MotorGroupSnapshot& right = producer.right;
+    if (!producer.bound) {
+        left.bind(left_mg.ports());
+        right.bind(right_mg.ports());
+        producer.bound = true;
+    }
+    const std::uint16_t fields = FIELD_VELOCITY | FIELD_CURRENT | FIELD_VOLTAGE;
+    left.sample(fields);
+    right.sample(fields);
+
+    std::int32_t left_mv = 0, right_mv = 0, left_ma = 0, right_ma = 0;
+    for (int i = 0; i < left.count; i++) {
+        left_mv += left.voltage[i];
+        left_ma += left.current[i];
+    }
+    for (int i = 0; i < right.count; i++) {
+        right_mv += right.voltage[i];
+        right_ma += right.current[i];
+    }
+
+    Pose pose = robot_pose.read();
+    TelemetryRecord record = {};
+    record.drive.x = pose.x;
+    record.drive.y = pose.y;
+    record.drive.theta = pose.theta;
+    record.drive.left_mv = clamp16(left.count ? left_mv / left.count : 0);
+    record.drive.right_mv = clamp16(right.count ? right_mv / right.count : 0);
+    record.drive.left_rpm = clamp16(left.average_velocity());
+    record.drive.right_rpm = clamp16(right.average_velocity());
+    record.drive.left_ma = clamp16(left_ma);
+    record.drive.right_ma = clamp16(right_ma);
+    push(producer, record, TELEMETRY_DRIVE);
+}
+
+void telemetry_sample_mechanisms(TelemetryProducer& producer) {
+    TelemetryRecord record = {};
+    record.mechanisms.intake_mv = clamp16(intake_motor.get_voltage());
+    record.mechanisms.lift_mv = clamp16(lift_motor.get_voltage());
+    record.mechanisms.intake_rpm = clamp16(intake_motor.get_actual_velocity());
+    record.mechanisms.lift_rpm = clamp16(lift_motor.get_actual_velocity());
+    record.mechanisms.intake_ma = clamp16(intake_motor.get_current_draw());
+    record.mechanisms.lift_ma = clamp16(lift_motor.get_current_draw());
+    record.mechanisms.lift_position = lift_motor.get_position();
+    push(producer, record, TELEMETRY_MECHANISMS);
+}
+
+void telemetry_record_loop(TelemetryProducer& producer, const LoopStats& stats) {
+    TelemetryRecord record = {};
+    record.loop.exec_us = stats.last_exec_us;
+    record.loop.jitter_us = stats.last_jitter_us;
+    record.loop.overruns = stats.overruns;
+    record.loop.skipped_ticks = stats.skipped_ticks;
+    push(producer, record, TELEMETRY_LOOP);
+}
+
+// --- Autonomous sampler ---
+
+static std::atomic<bool> auton_sampling{false};
+
+void set_auton_telemetry(bool on) {
+    auton_sampling = on;
+}
+
+// The only producer of auton_telemetry. Runs all the time so the ring never
+// changes hands, and only samples while autonomous has it on.
+static void auton_sampler_fn(void* param) {
+    std::uint32_t wake = pros::millis();
+    while (true) {
+        if (auton_sampling) {
+            telemetry_sample_drive(auton_telemetry);
+            telemetry_sample_mechanisms(auton_telemetry);
+        }
+        pros::Task::delay_until(&wake, 10);
+    }
+}
+
+// --- Logger ---
+// The logger task takes records off the ring into one of two block buffers.
+// When a block is full it's handed to the writer task and the logger carries on
+// into the other one, so a slow SD write only holds up the writer. If the writer
+// is still busy when the next block fills, the logger waits and the ring soaks
+// up the records in the meantime. The writer compresses each block (LZ4, after
+// byte-shuffling the records) before writing it; both tasks run at the lowest
+// priority, so the compression only ever uses time the control loop isn't.
+
+struct LogBlock {
+    TelemetryBlockHeader header;
+    TelemetryRecord records[TELEMETRY_RECORDS_PER_BLOCK];
+};
+static_assert(sizeof(LogBlock) == TELEMETRY_BLOCK_SIZE);
+
+static LogBlock blocks[2];
+static std::atomic<int> write_pending{-1};  // block waiting for the writer, -1 = none
+// Flushes asked for and finished, telemetry_wait_flushed waits for the second to catch up
+static std::atomic<std::uint32_t> flushes_requested{0};
+static std::atomic<std::uint32_t> flushes_done{0};
+static pros::task_t writer_task = nullptr;
+
+static std::FILE* log_file = nullptr;
+static std::FILE* index_file = nullptr;
+static std::uint32_t log_opened_ms = 0;
+static TelemetryLoggerStats logger_stats;
+
+const TelemetryLoggerStats& telemetry_logger_stats() {
+    return logger_stats;
+}
+
+void telemetry_flush() {
+    flushes_requested++;
+}
+
+bool telemetry_wait_flushed(std::uint32_t timeout_ms) {
+    std::uint32_t target = flushes_requested.load();
+    std::uint32_t start = pros::millis();
+    while (static_cast<std::int32_t>(flushes_done.load() - target) < 0) {
+        if (pros::millis() - start >= timeout_ms) return false;
+        pros::delay(5);
+    }
+    return true;
+}
+
+// Opens the next free /usd/tlm_NNN.v5l. Returns false if there's no card or no free name.
+static bool open_log() {
+    if (!pros::usd::is_installed()) return false;
+
+    for (int i = 0; i < 1000; i++) {
+        std::snprintf(logger_stats.file_name, sizeof(logger_stats.file_name), "/usd/tlm_%03d.v5l", i);
+        std::FILE* existing = std::fopen(logger_stats.file_name, "rb");
+        if (existing != nullptr) {
+            std::fclose(existing);
+            continue;
+        }
+
+        log_file = std::fopen(logger_stats.file_name, "wb");
+        if (log_file == nullptr) return false;
+        // Our blocks are already big, don't copy them through stdio's buffer too
+        std::setvbuf(log_file, nullptr, _IONBF, 0);
+
+        static std::uint8_t header_sector[TELEMETRY_FILE_HEADER_SIZE];
+        TelemetryFileHeader header = {};
+        header.magic = TELEMETRY_FILE_MAGIC;
+        header.schema_version = TELEMETRY_SCHEMA_VERSION;
+        header.record_size = sizeof(TelemetryRecord);
+        header.block_size = TELEMETRY_BLOCK_SIZE;
+        header.start_ms = pros::millis();
+        header.format_version = TELEMETRY_FORMAT_VERSION;
+        std::memcpy(header_sector, &header, sizeof(header));
+        if (std::fwrite(header_sector, 1, sizeof(header_sector), log_file) != sizeof(header_sector)) {
+            std::fclose(log_file);
+            log_file = nullptr;
+            return false;
+        }
+        log_opened_ms = header.start_ms;
+        logger_stats.bytes_written = sizeof(header_sector);
+
+        // The seek index is a nice to have, the log is still readable without it
+        char index_name[sizeof(logger_stats.file_name)];
+        std::snprintf(index_name, sizeof(index_name), "/usd/tlm_%03d.idx", i);
+        index_file = std::fopen(index_name, "wb");
+        if (index_file != nullptr) std::setvbuf(index_file, nullptr, _IONBF, 0);
+        return true;
+    }
+    return false;
+}
+
+// Packs a block (shuffle + LZ4, or as is if that doesn't make it smaller),
+// appends it to the log and its entry to the index
+static void write_block(LogBlock& block) {
+    static std::uint8_t shuffled[sizeof(block.records)];
+    static std::uint8_t packed[lz4_bound(sizeof(block.records))];
+
+    std::uint32_t raw_size = block.header.record_count * sizeof(TelemetryRecord);
+    std::uint64_t compress_start = pros::micros();
+    telemetry_shuffle(block.records, shuffled, block.header.record_count);
+    std::size_t packed_size = lz4_compress(shuffled, raw_size, packed, sizeof(packed));
+    std::uint32_t compress_took = pros::micros() - compress_start;
+    logger_stats.total_compress_us += compress_took;
+    if (compress_took > logger_stats.max_compress_us) logger_stats.max_compress_us = compress_took;
+
+    const void* payload = block.records;
+    if (packed_size > 0 && packed_size < raw_size) {
+        block.header.flags = TELEMETRY_BLOCK_LZ4 | TELEMETRY_BLOCK_SHUFFLED;
+        block.header.stored_size = packed_size;
+        payload = packed;
+    } else {
+        block.header.flags = 0;
+        block.header.stored_size = raw_size;
+    }
+
+    TelemetryIndexEntry entry = {block.header.index, logger_stats.bytes_written, block.header.first_time_ms,
+                                 block.header.last_time_ms};
+
+    std::uint64_t start = pros::micros();
+    bool ok = std::fwrite(&block.header, 1, sizeof(block.header), log_file) == sizeof(block.header);
+    ok = ok && std::fwrite(payload, 1, block.header.stored_size, log_file) == block.header.stored_size;
+    ok = std::fflush(log_file) == 0 && ok;
+    std::uint32_t took = pros::micros() - start;
+
+    if (ok) {
+        logger_stats.blocks_written++;
+        logger_stats.bytes_written += sizeof(block.header) + block.header.stored_size;
+        logger_stats.raw_bytes += sizeof(block.header) + raw_size;
+        if (index_file != nullptr) {
+            std::fwrite(&entry, 1, sizeof(entry), index_file);
+            std::fflush(index_file);
+        }
+    } else {
+        logger_stats.write_errors++;
+    }
+    logger_stats.total_write_us += took;
+    if (took > logger_stats.max_write_us) logger_stats.max_write_us = took;
+}
+
+static void telemetry_writer_fn(void* param) {
+    while (true) {
+        pros::c::task_notify_take(true, TIMEOUT_MAX);
+        int pending = write_pending.load(std::memory_order_acquire);
+        if (pending < 0) continue;
+
+        if (log_file == nullptr && !logger_stats.sd_failed) {
+            if (open_log()) {
+                printf("telemetry: logging to %s\n", logger_stats.file_name);
+            } else {
+                logger_stats.sd_failed = true;
+                printf("telemetry: no SD card or can't create a log, only counting records\n");
+            }
+        }
+
+        if (log_file != nullptr) write_block(blocks[pending]);
+
+        write_pending.store(-1, std::memory_order_release);
+    }
+}
+
+static void wait_for_writer() {
+    while (write_pending.load(std::memory_order_acquire) >= 0) {
+        pros::delay(2);
+    }
+}
+
+// Gives a block to the writer, waiting for it to finish the previous one first
+static void hand_off(int block) {
+    wait_for_writer();
+    write_pending.store(block, std::memory_order_release);
+    pros::c::task_notify(writer_task);
+}
+
+static std::uint32_t total_dropped() {
+    std::uint32_t dropped = 0;
+    for (const TelemetryProducer* producer : producers) dropped += producer->ring.dropped();
+    return dropped;
+}
+
+static void start_block(LogBlock& block, std::uint32_t index) {
+    block.header = {};
+    block.header.magic = TELEMETRY_BLOCK_MAGIC;
+    block.header.index = index;
+    block.header.dropped = total_dropped();
+}
+
+static void telemetry_logger_fn(void* param) {
+    int filling = 0;
+    std::uint32_t block_index = 0;
+    std::uint32_t count = 0;
+    start_block(blocks[filling], block_index);
+    std::uint32_t wake = pros::millis();
+
+    while (true) {
+        for (const TelemetryProducer* producer : producers) {
+            std::uint32_t backlog = producer->ring.size();
+            if (backlog > logger_stats.max_backlog) logger_stats.max_backlog = backlog;
+        }
+
+        while (true) {
+            LogBlock& block = blocks[filling];
+            std::size_t got = 0;
+            for (TelemetryProducer* producer : producers) {
+                got += producer->ring.pop_many(&block.records[count + got], TELEMETRY_RECORDS_PER_BLOCK - count - got);
+            }
+            logger_stats.records += got;
+            count += got;
+
+            // A flush waits until the rings are drained, then writes what's there
+            std::uint32_t flush_target = flushes_requested.load();
+            bool flush = got == 0 && flush_target != flushes_done.load();
+            bool full = count == TELEMETRY_RECORDS_PER_BLOCK;
+            if (flush && count == 0) {
+                wait_for_writer();
+                flushes_done = flush_target;
+                break;
+            }
+            if (!full && !flush) break;
+
+            // On a flush the block is short, only the records it has are written. The
+            // rings are drained one after the other, so times are only ordered per producer.
+            block.header.record_count = count;
+            block.header.first_time_ms = block.header.last_time_ms = block.records[0].time_ms;
+            for (std::uint32_t i = 1; i < count; i++) {
+                std::uint32_t time = block.records[i].time_ms;
+                if (time < block.header.first_time_ms) block.header.first_time_ms = time;
+                if (time > block.header.last_time_ms) block.header.last_time_ms = time;
+            }
+
+            if (!logger_stats.sd_failed) hand_off(filling);
+            filling ^= 1;
+            count = 0;
+            start_block(blocks[filling], ++block_index);
+            if (flush) {
+                wait_for_writer();
+                flushes_done = flush_target;
+                break;
+            }
+        }
+        logger_stats.dropped = total_dropped();
+
+        // The ring holds seconds of records, no need to wake often
+        pros::Task::delay_until(&wake, 50);
+    }
+}
+
+void start_telemetry_logger() {
+    static bool started = false;
+    if (started) return;
+    started = true;
+    // The writer can wait on the card as long as it likes, it only holds up the logger
+    writer_task = pros::c::task_create(telemetry_writer_fn, nullptr, TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT,
+                                       "telemetry sd");
+    pros::Task logger(telemetry_logger_fn, nullptr, TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT, "telemetry");
+    // Above the auton itself, so the samples keep their 10 ms spacing while it computes
+    pros::Task sampler(auton_sampler_fn, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+                       "telemetry auton");
+}
+
+void print_telemetry_stats() {
+    printf("telemetry: %lu records, %lu dropped, ring backlog max %lu of %u\n", (unsigned long)logger_stats.records,
+           (unsigned long)logger_stats.dropped, (unsigned long)logger_stats.max_backlog,
+           (unsigned)TELEMETRY_RING_SIZE);
+
+    if (log_file == nullptr) {
+        printf("  not logging to SD\n");
+        return;
+    }
+    // Sustained: what the log has averaged since it was opened. Card: how fast the writes themselves went.
+    double elapsed_s = (pros::millis() - log_opened_ms) / 1000.0;
+    double sustained = elapsed_s > 0 ? logger_stats.bytes_written / elapsed_s / 1024 : 0;
+    double card = logger_stats.total_write_us > 0 ? logger_stats.bytes_written / (logger_stats.total_write_us / 1e6) / 1024 : 0;
+    printf("  %s: %lu blocks, %lu KB, %.1f KB/s sustained, %.0f KB/s card, block write max %.2f ms avg %.2f ms, %lu errors\n",
+           logger_stats.file_name, (unsigned long)logger_stats.blocks_written,
+           (unsigned long)(logger_stats.bytes_written / 1024), sustained, card, logger_stats.max_write_us / 1000.0,
+           logger_stats.blocks_written ? logger_stats.total_write_us / 1000.0 / logger_stats.blocks_written : 0.0,
+           (unsigned long)logger_stats.write_errors);
+
+    // CPU: share of the time since the log was opened spent compressing
+    double ratio = logger_stats.bytes_written > TELEMETRY_FILE_HEADER_SIZE
+                       ? (double)logger_stats.raw_bytes / (logger_stats.bytes_written - TELEMETRY_FILE_HEADER_SIZE)
+                       : 0;
+    double cpu = elapsed_s > 0 ? logger_stats.total_compress_us / (elapsed_s * 1e6) * 100 : 0;
+    printf("  compression %.2fx, %.2f ms total, block max %.2f ms, %.3f%% cpu\n", ratio,
+           logger_stats.total_compress_us / 1000.0, logger_stats.max_compress_us / 1000.0, cpu);
+}
@@ -0,0 +1,81 @@
+#ifndef TELEMETRY_LOG_HPP
+#define TELEMETRY_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "control_loop.hpp"
+#include "motor_sample.hpp"
+#include "spsc_ring.hpp"
+#include "telemetry.hpp"
+
+// Telemetry from the control loops to a low priority logger task.
+// Each producer task has its own ring, and the logger task is the only consumer
+// of all of them, so pushing is a copy and two atomic operations, and never
+// waits on the logger. If the logger falls behind, records are dropped and counted.
+
+constexpr std::size_t TELEMETRY_RING_SIZE = 1024;  // ~3 s of drive + mechanisms + loop at 100 Hz
+
+// Everything one producer task owns: its ring, its sequence numbers and its
+// motor snapshots. Only that task may call the producer functions with it.
+struct TelemetryProducer {
+    explicit TelemetryProducer(std::uint8_t flags) : flags(flags) {}
+
+    SpscRing<TelemetryRecord, TELEMETRY_RING_SIZE> ring;
+    std::uint16_t next_seq = 0;
+    const std::uint8_t flags;  // TELEMETRY_FLAG_*, stamped on every record
+    MotorGroupSnapshot left, right;
+    bool bound = false;
+};
+
+extern TelemetryProducer driver_telemetry;  // the opcontrol control loop
+extern TelemetryProducer auton_telemetry;   // the autonomous sampler task, see set_auton_telemetry
+
+// Producer side, only call these from the producer's own task.
+// Each samples what it needs, stamps the time and sequence number, and pushes one record.
+void telemetry_sample_drive(TelemetryProducer& producer);
+void telemetry_sample_mechanisms(TelemetryProducer& producer);
+void telemetry_record_loop(TelemetryProducer& producer, const LoopStats& stats);
+
+// Autonomous has no control loop to sample from, so a sampler task records the
+// drive and mechanisms at 100 Hz into auton_telemetry while this is on.
+// On from the start of autonomous() until it returns or the robot is disabled.
+void set_auton_telemetry(bool on);
+
+struct TelemetryLoggerStats {
+    std::uint32_t records = 0;  // taken off the rings
+    std::uint32_t dropped = 0;  // pushed while a ring was full
+    std::uint32_t max_backlog = 0;  // most records waiting in one ring at once
+
+    // SD log, see telemetry.hpp for the file layout
+    char file_name[24] = {};
+    bool sd_failed = false;  // no card or couldn't create the file, records are only counted
+    std::uint32_t blocks_written = 0;
+    std::uint32_t bytes_written = 0;
+    std::uint32_t write_errors = 0;
+    std::uint32_t max_write_us = 0;  // worst block write + flush
+    std::uint64_t total_write_us = 0;
+
+    // Compression, done by the writer task before each block is written
+    std::uint32_t raw_bytes = 0;  // what the blocks written would have been unpacked
+    std::uint32_t max_compress_us = 0;
+    std::uint64_t total_compress_us = 0;
+};
+
+// Starts the logger tasks (low priority) and the autonomous sampler. Safe to call more than once.
+// Records are written to /usd/tlm_NNN.v5l in LZ4 compressed blocks, with a seek
+// index in tlm_NNN.idx; the files are opened with the first block. Without an
+// SD card the records are only taken off the ring and counted.
+void start_telemetry_logger();
+
+// Writes out the partly filled block too, e.g. at the end of a match.
+// Done by the logger task on its next pass.
+void telemetry_flush();
+
+// Waits until every telemetry_flush() so far is on the card (or there's no card),
+// at most timeout_ms. False if it timed out.
+bool telemetry_wait_flushed(std::uint32_t timeout_ms);
+
+const TelemetryLoggerStats& telemetry_logger_stats();
+void print_telemetry_stats();
+
+#endif
@@ -0,0 +1,144 @@
+#include "main.h"
+#include "tracking_odometry.hpp"
+#include "globals.hpp"
+
+void TrackingOdometry::reset(const Pose& start, double imu_rotation) {
+    current = start;
+    last_imu = imu_rotation;
+}
+
+void TrackingOdometry::update(const TrackingDeltas& deltas, std::uint32_t timestamp, double imu_rotation) {
+    // Heading change from the two parallel wheels if we have them, otherwise the IMU
+    double d_theta = 0;
+    if (config.has_right) {
+        d_theta = (deltas.right - deltas.left) / (config.left_offset - config.right_offset);
+    } else if (!std::isnan(imu_rotation) && !std::isnan(last_imu)) {
+        d_theta = imu_rotation - last_imu;
+    }
+    last_imu = imu_rotation;
+
+    // Take out the part of each wheel's travel that came from turning
+    double forward = deltas.left + config.left_offset * d_theta;
+    if (config.has_right) {
+        forward = (forward + deltas.right + config.right_offset * d_theta) / 2;
+    }
+    double lateral = config.has_perp ? deltas.perp - config.perp_offset * d_theta : 0;
+
+    // Arc integration: the chord of a constant-curvature move, at the average heading
+    if (std::fabs(d_theta) > 1e-9) {
+        double scale = 2 * std::sin(d_theta / 2) / d_theta;
+        forward *= scale;
+        lateral *= scale;
+    }
+    double mid_theta = current.theta + d_theta / 2;
+    current.x += forward * std::cos(mid_theta) - lateral * std::sin(mid_theta);
+    current.y += forward * std::sin(mid_theta) + lateral * std::cos(mid_theta);
+    current.theta += d_theta;
+    current.timestamp = timestamp;
+}
+
+// --- Tracking wheel task ---
+
+static pros::Task* tracking_task = nullptr;
+
+// Rotation sensor position is in centidegrees
+static double centidegrees_to_inches(std::int32_t position) {
+    return position / 36000.0 * tracking_config.wheel_diameter * M_PI;
+}
+
+struct TrackerReading {
+    std::int32_t left = 0, right = 0, perp = 0;
+};
+
+static bool read_trackers(TrackerReading& reading) {
+    reading.left = left_tracker.get_position();
+    if (reading.left == PROS_ERR) return false;
+    if (tracking_config.has_right) {
+        reading.right = right_tracker.get_position();
+        if (reading.right == PROS_ERR) return false;
+    }
+    if (tracking_config.has_perp) {
+        reading.perp = perp_tracker.get_position();
+        if (reading.perp == PROS_ERR) return false;
+    }
+    return true;
+}
+
+static void tracking_task_fn(void* param) {
+    TrackingOdometry odom(tracking_config);
+    TrackerReading last;
+    bool started = false;
+
+    left_tracker.set_data_rate(5);
+    right_tracker.set_data_rate(5);
+    perp_tracker.set_data_rate(5);
+
+    std::uint32_t wake = pros::millis();
+    while (true) {
+        TrackerReading now;
+        if (read_trackers(now)) {
+            double imu_rotation = imu_rotation_rad();
+
+            Pose start;
+            bool reset = take_odometry_reset(start);
+            if (reset || !started) {
+                if (!reset) start = robot_pose.read();
+                odom.reset(start, imu_rotation);
+                started = true;
+            } else {
+                TrackingDeltas deltas;
+                deltas.left = centidegrees_to_inches(now.left - last.left);
+                deltas.right = centidegrees_to_inches(now.right - last.right);
+                deltas.perp = centidegrees_to_inches(now.perp - last.perp);
+                odom.update(deltas, pros::millis(), imu_rotation);
+                robot_pose.publish(odom.pose());
+            }
+            last = now;
+        }
+
+        // Same as the sensors' data rate, so each new reading is used once
+        pros::Task::delay_until(&wake, 5);
+    }
+}
+
+void start_tracking_odometry() {
+    if (tracking_task != nullptr) return;
+    tracking_task = new pros::Task(tracking_task_fn, nullptr, TASK_PRIORITY_MAX - 2, TASK_STACK_DEPTH_DEFAULT,
+                                   "TrackingOdom");
+}
+
+void calibrate_tracking_offsets() {
+    // Needs a calibrated IMU to know how far we actually turned
+    while (imu.is_calibrating()) pros::delay(10);
+
+    TrackerReading start, end;
+    while (!read_trackers(start)) pros::delay(10);
+    double start_rotation = imu_rotation_rad();
+
+    // Spin slowly counter-clockwise for a few turns, then let it settle
+    left_mg.move(-40);
+    right_mg.move(40);
+    pros::delay(6000);
+    left_mg.brake();
+    right_mg.brake();
+    pros::delay(500);
+
+    while (!read_trackers(end)) pros::delay(10);
+    double d_theta = imu_rotation_rad() - start_rotation;
+    if (std::isnan(d_theta) || std::fabs(d_theta) < 1.0) {
+        printf("Tracking calibration failed, robot didn't turn\n");
+        return;
+    }
+
+    printf("Turned %.1f deg\n", d_theta * 180 / M_PI);
+    printf("left_offset = %.3f\n",
+           TrackingOdometry::parallel_offset_from_spin(centidegrees_to_inches(end.left - start.left), d_theta));
+    if (tracking_config.has_right) {
+        printf("right_offset = %.3f\n",
+               TrackingOdometry::parallel_offset_from_spin(centidegrees_to_inches(end.right - start.right), d_theta));
+    }
+    if (tracking_config.has_perp) {
+        printf("perp_offset = %.3f\n",
+               TrackingOdometry::perp_offset_from_spin(centidegrees_to_inches(end.perp - start.perp), d_theta));
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef TRACKING_ODOMETRY_HPP
+#define TRACKING_ODOMETRY_HPP
+
+#include <cmath>
+#include <cstdint>
+#include "odometry.hpp"
+
+// Odometry from unpowered tracking wheels on rotation sensors. They don't slip
+// when the drive gets pushed, so the pose stays good through a whole skills run.
+//
+// Offsets are measured from the robot's tracking center:
+//   parallel wheels: sideways distance, positive to the left
+//   perpendicular wheel: forward distance, positive to the front
+
+struct TrackingConfig {
+    double wheel_diameter = 2.0;  // inches
+    double left_offset = 0;       // parallel wheel(s)
+    double right_offset = 0;
+    double perp_offset = 0;       // perpendicular wheel
+    bool has_right = false;       // second parallel wheel, heading comes from the IMU without it
+    bool has_perp = false;
+};
+
+// Wheel travel in inches since the last update
+struct TrackingDeltas {
+    double left = 0;
+    double right = 0;
+    double perp = 0;
+};
+
+// No PROS calls in here so it can be run against recorded sensor traces.
+class TrackingOdometry {
+public:
+    explicit TrackingOdometry(const TrackingConfig& config) : config(config) {}
+
+    void reset(const Pose& start, double imu_rotation);
+
+    // imu_rotation is in radians counter-clockwise, or NAN. With two parallel
+    // wheels the IMU isn't needed; with one it is.
+    void update(const TrackingDeltas& deltas, std::uint32_t timestamp, double imu_rotation);
+
+    const Pose& pose() const { return current; }
+    const TrackingConfig& get_config() const { return config; }
+
+    // Offsets that make a pure spin of d_theta radians produce no translation.
+    // Spin in place, then feed in the total wheel travel and IMU rotation.
+    static double parallel_offset_from_spin(double wheel_travel, double d_theta) { return -wheel_travel / d_theta; }
+    static double perp_offset_from_spin(double wheel_travel, double d_theta) { return wheel_travel / d_theta; }
+
+private:
+    TrackingConfig config;
+    Pose current;
+    double last_imu = NAN;
+};
+
+// Starts the tracking wheel odometry task at the rotation sensors' 5 ms data rate.
+// Use it instead of start_odometry(), not as well.
+void start_tracking_odometry();
+
+// Spins the robot in place for a few seconds and prints measured wheel offsets
+// to put into the tracking config.
+void calibrate_tracking_offsets();
+
+#endif
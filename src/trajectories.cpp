@@ -0,0 +1,4 @@
+#include "trajectory.hpp"
+
+// The tables are generated from paths/*.path by tools/pathc, see the Makefile
+#include "trajectories.inc"
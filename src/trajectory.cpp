@@ -0,0 +1,56 @@
+#include <cstring>
+#include "trajectory.hpp"
+
+void TrajectoryStream::reset(const TrajectoryTable& new_table) {
+    table = &new_table;
+    index = 0;
+    x = table->x0;
+    y = table->y0;
+    theta = table->theta0;
+    v = table->v0;
+    omega = table->omega0;
+}
+
+void TrajectoryStream::decode(TrajectorySample& sample) const {
+    sample.x = x / TRAJ_POSITION_SCALE;
+    sample.y = y / TRAJ_POSITION_SCALE;
+    sample.theta = theta / TRAJ_THETA_SCALE;
+    sample.velocity = v / TRAJ_VELOCITY_SCALE;
+    sample.angular_velocity = omega / TRAJ_OMEGA_SCALE;
+    sample.time = index * table->dt_ms;
+}
+
+bool TrajectoryStream::next(TrajectorySample& sample) {
+    if (finished()) return false;
+
+    if (index > 0) {
+        const TrajectoryDelta& d = table->deltas[index - 1];
+        x += d.dx;
+        y += d.dy;
+        theta += d.dtheta;
+        v += d.dv;
+        omega += d.domega;
+    }
+    decode(sample);
+    last = sample;
+    index++;
+    return true;
+}
+
+bool TrajectoryStream::seek(std::uint32_t time_ms, TrajectorySample& sample) {
+    if (table == nullptr) return false;
+
+    // index is the next sample, so index * dt is its time
+    while (index < table->count && static_cast<std::uint32_t>(index) * table->dt_ms <= time_ms) {
+        next(sample);
+    }
+    sample = last;
+    return true;
+}
+
+const TrajectoryTable* find_trajectory(const char* name) {
+    for (const TrajectoryTable* t = trajectory_tables; t->name != nullptr; t++) {
+        if (std::strcmp(t->name, name) == 0) return t;
+    }
+    return nullptr;
+}
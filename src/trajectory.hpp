@@ -0,0 +1,76 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <cstdint>
+
+// Precompiled auton trajectories.
+// tools/pathc turns the path files in paths/ into tables at build time: one
+// sample per control tick, quantized and stored as deltas from the previous
+// sample. The brain only decodes them as it goes, one sample per tick.
+//
+// This header is shared with the host tools, so no PROS includes in here.
+
+// Quantization steps
+constexpr float TRAJ_POSITION_SCALE = 128.0f;                // counts per inch
+constexpr float TRAJ_THETA_SCALE = 65536.0f / 6.28318531f;   // counts per radian
+constexpr float TRAJ_VELOCITY_SCALE = 16.0f;                 // counts per in/s
+constexpr float TRAJ_OMEGA_SCALE = 64.0f;                    // counts per rad/s
+
+// Change from one sample to the next, in quantized counts
+struct TrajectoryDelta {
+    std::int8_t dx;
+    std::int8_t dy;
+    std::int16_t dtheta;
+    std::int8_t dv;
+    std::int8_t domega;
+};
+
+struct TrajectoryTable {
+    const char* name;
+    std::uint16_t dt_ms;
+    std::uint16_t count;  // samples, including the first
+    // First sample, in quantized counts
+    std::int32_t x0, y0, theta0, v0, omega0;
+    const TrajectoryDelta* deltas;  // count - 1 of them
+};
+
+struct TrajectorySample {
+    float x = 0;      // in
+    float y = 0;      // in
+    float theta = 0;  // rad, counter-clockwise
+    float velocity = 0;          // in/s
+    float angular_velocity = 0;  // rad/s
+    std::uint32_t time = 0;      // ms from the start of the trajectory
+};
+
+// Decodes a table one sample at a time, forwards only.
+class TrajectoryStream {
+public:
+    void reset(const TrajectoryTable& table);
+
+    // Decodes the next sample. Returns false once past the end.
+    bool next(TrajectorySample& sample);
+
+    // Skips forward to the last sample at or before time_ms (from the start).
+    // Returns false if there's no table. Holds the final sample past the end.
+    bool seek(std::uint32_t time_ms, TrajectorySample& sample);
+
+    bool finished() const { return table == nullptr || index >= table->count; }
+    std::uint32_t duration() const { return table ? (table->count - 1) * table->dt_ms : 0; }
+
+private:
+    void decode(TrajectorySample& sample) const;
+
+    const TrajectoryTable* table = nullptr;
+    int index = 0;  // next sample to decode
+    std::int32_t x = 0, y = 0, theta = 0, v = 0, omega = 0;
+    TrajectorySample last;
+};
+
+// Generated tables, ending with an entry whose name is nullptr
+extern const TrajectoryTable trajectory_tables[];
+
+// Looks up a generated trajectory by the name in its path file, or nullptr
+const TrajectoryTable* find_trajectory(const char* name);
+
+#endif
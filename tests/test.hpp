@@ -0,0 +1,80 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <cmath>
+#include <cstdint>
+
+// Host unit tests, `make test` (see tests/test_main.cpp).
+//
+// The test binary is built like the simulator: all of src/ against
+// tools/sim_pros.cpp, so robot code runs as tasks on the sim kernel's virtual
+// clock (tools/sim_kernel.hpp) with the same timing on every run. There's no
+// physics unless a test sets the tick hook, sensors read whatever the test puts
+// in sim::world().
+//
+// Tests share one process, so the clock never goes back and a task a test
+// leaves behind stays parked. Measure time from where the test started.
+//
+//   TEST(ring_keeps_order) {
+//       ...
+//       CHECK(ring.empty());
+//       CHECK_EQ(popped, pushed);
+//       CHECK_NEAR(pose.x, 24.0, 0.01);
+//   }
+
+using TestFn = void (*)();
+
+// Adds a test to the run, in the order the files' static initializers get to them
+bool register_test(const char* name, TestFn fn);
+
+// Records a failed check in the running test, which carries on
+void check_failed(const char* file, int line, const char* expression);
+void check_equal_failed(const char* file, int line, const char* expression, long long value, long long expected);
+void check_near_failed(const char* file, int line, const char* expression, double value, double expected,
+                       double tolerance);
+
+#define TEST(name)                                                                     \
+    static void name();                                                                \
+    [[maybe_unused]] static const bool name##_registered = register_test(#name, name); \
+    static void name()
+
+#define CHECK(expression)                                                 \
+    do {                                                                  \
+        if (!(expression)) check_failed(__FILE__, __LINE__, #expression); \
+    } while (0)
+
+#define CHECK_EQ(value, expected)                                                        \
+    do {                                                                                 \
+        long long check_value = (value), check_expected = (expected);                    \
+        if (check_value != check_expected) {                                             \
+            check_equal_failed(__FILE__, __LINE__, #value, check_value, check_expected); \
+        }                                                                                \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance)                                                           \
+    do {                                                                                                 \
+        double check_value = (value), check_expected = (expected), check_tolerance = (tolerance);        \
+        if (!(std::fabs(check_value - check_expected) <= check_tolerance)) {                             \
+            check_near_failed(__FILE__, __LINE__, #value, check_value, check_expected, check_tolerance); \
+        }                                                                                                \
+    } while (0)
+
+// --- Running robot code on the virtual clock ---
+
+// Virtual ms since the simulation started
+std::uint32_t sim_now_ms();
+
+// Starts fn(arg) as a sim task, like pros::c::task_create
+void* start_sim_task(void (*fn)(void*), void* arg, std::uint32_t priority, const char* name);
+
+// Deletes a task started with start_sim_task, e.g. one that loops forever
+void stop_sim_task(void* task);
+
+// Runs the tasks for ms of virtual time
+void run_sim_for(std::uint32_t ms);
+
+// Runs the tasks until the given one returns, for at most timeout_ms.
+// True if it returned.
+bool run_sim_until_done(void* task, std::uint32_t timeout_ms);
+
+#endif
@@ -0,0 +1,170 @@
+// The coroutine auton runtime (src/auton_runtime.cpp) run by run_auton
+// (src/auton_actions.cpp) on the virtual clock
+
+#include "main.h"
+#include "auton_actions.hpp"
+#include "test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// When things happened, in ms from when the auton started
+std::uint32_t auton_start_ms;
+std::uint32_t auton_end_ms;
+std::uint32_t marks[4];
+bool condition_met;
+
+std::uint32_t elapsed() {
+    return pros::millis() - auton_start_ms;
+}
+
+AutonTask (*routine)();
+
+void run_routine(void*) {
+    auton_start_ms = pros::millis();
+    run_auton(routine());
+    auton_end_ms = elapsed();
+}
+
+// Starts routine as an auton in its own task
+void* start_routine(AutonTask (*r)()) {
+    routine = r;
+    for (std::uint32_t& mark : marks) mark = 0;
+    condition_met = false;
+    return start_sim_task(run_routine, nullptr, TASK_PRIORITY_DEFAULT, "auton");
+}
+
+// False if it didn't finish in time
+bool run_routine_to_end(AutonTask (*r)(), std::uint32_t timeout_ms = 5000) {
+    return run_sim_until_done(start_routine(r), timeout_ms);
+}
+
+AutonTask mark_after(int index, std::chrono::milliseconds time) {
+    co_await sleep(time);
+    marks[index] = elapsed();
+}
+
+// Sets the condition from another task at 123 ms, off the scheduler's 10 ms grid
+bool notify_on_set;
+
+void set_condition(void*) {
+    pros::delay(123);
+    condition_met = true;
+    if (notify_on_set) auton_notify();
+}
+
+AutonTask sleeps_in_sequence() {
+    co_await sleep(100ms);
+    marks[0] = elapsed();
+    co_await sleep(55ms);
+    marks[1] = elapsed();
+}
+
+AutonTask sleeps_at_once() {
+    co_await all(mark_after(0, 300ms), mark_after(1, 100ms), sleep(200ms));
+    marks[2] = elapsed();
+}
+
+AutonTask waits_for_condition() {
+    co_await wait_until([] { return condition_met; });
+    marks[0] = elapsed();
+}
+
+// Runs waits_for_condition with the condition set from another task
+bool run_with_condition_set(bool notify) {
+    notify_on_set = notify;
+    void* task = start_routine(waits_for_condition);
+    start_sim_task(set_condition, nullptr, TASK_PRIORITY_DEFAULT, "setter");
+    return run_sim_until_done(task, 5000);
+}
+
+AutonTask waits_with_timeout() {
+    bool met = co_await wait_until([] { return false; }, 250ms);
+    marks[0] = elapsed();
+    marks[1] = met;
+    met = co_await wait_until([] { return true; }, 250ms);
+    marks[2] = elapsed();
+    marks[3] = met;
+}
+
+AutonTask all_with_one_already_done() {
+    co_await all(wait_until([] { return true; }), mark_after(0, 40ms));
+    marks[1] = elapsed();
+}
+
+// Counts the coroutine frames it's in that have been destroyed
+int frames_freed;
+
+struct FrameGuard {
+    ~FrameGuard() { frames_freed++; }
+};
+
+AutonTask sleeps_forever() {
+    FrameGuard guard;
+    co_await sleep(100000ms);
+}
+
+AutonTask cut_off_part_way() {
+    FrameGuard guard;
+    co_await all(sleeps_forever(), sleep(100000ms));
+}
+
+}  // namespace
+
+TEST(auton_sleeps_run_on_the_tick) {
+    CHECK(run_routine_to_end(sleeps_in_sequence));
+    CHECK_EQ(marks[0], 100);
+    // 55 ms after the tick at 100 ends on the first tick after it
+    CHECK_EQ(marks[1], 160);
+    CHECK_EQ(auton_end_ms, 160);
+    CHECK(auton_scheduler.idle());
+}
+
+TEST(auton_all_runs_together_and_waits_for_the_last) {
+    CHECK(run_routine_to_end(sleeps_at_once));
+    CHECK_EQ(marks[0], 300);
+    CHECK_EQ(marks[1], 100);
+    CHECK_EQ(marks[2], 300);
+    CHECK_EQ(auton_end_ms, 300);
+}
+
+TEST(auton_all_with_a_task_that_finishes_straight_away) {
+    CHECK(run_routine_to_end(all_with_one_already_done));
+    CHECK_EQ(marks[0], 40);
+    CHECK_EQ(marks[1], 40);
+}
+
+TEST(auton_wait_until_checks_every_tick) {
+    CHECK(run_with_condition_set(false));
+    CHECK_EQ(marks[0], 130);
+}
+
+TEST(auton_notify_rechecks_before_the_tick) {
+    CHECK(run_with_condition_set(true));
+    CHECK_EQ(marks[0], 123);
+}
+
+TEST(auton_wait_until_times_out) {
+    CHECK(run_routine_to_end(waits_with_timeout));
+    CHECK_EQ(marks[0], 250);
+    CHECK_EQ(marks[1], false);
+    CHECK_EQ(marks[2], 250);
+    CHECK_EQ(marks[3], true);
+    CHECK(auton_scheduler.idle());
+}
+
+TEST(auton_cut_off_is_freed_by_the_next_one) {
+    // Deleted part way, like RoutineCommand does when the auton is interrupted
+    frames_freed = 0;
+    void* task = start_routine(cut_off_part_way);
+    run_sim_for(100);
+    stop_sim_task(task);
+    CHECK_EQ(auton_scheduler.waiting(), 2);
+    CHECK_EQ(frames_freed, 0);
+
+    // Both the root and the task all() started
+    CHECK(run_routine_to_end(sleeps_in_sequence));
+    CHECK_EQ(frames_freed, 2);
+    CHECK_EQ(marks[1], 160);
+}
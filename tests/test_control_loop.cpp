@@ -0,0 +1,100 @@
+// ControlLoop (src/control_loop.cpp) timing on the virtual clock
+
+#include "main.h"
+#include "control_loop.hpp"
+#include "test.hpp"
+
+namespace {
+
+// What the subsystems saw, reset by each test
+std::uint32_t loop_start_ms;
+int fast_runs, slow_runs;
+bool off_boundary;  // a tick started off the 10 ms grid
+int stall_on_run;   // the fast subsystem's run that takes stall_ms, -1 for none
+std::uint32_t stall_ms;
+
+void fast_tick() {
+    if ((pros::millis() - loop_start_ms) % 10 != 0) off_boundary = true;
+    if (fast_runs++ == stall_on_run) pros::delay(stall_ms);
+}
+
+void slow_tick() {
+    slow_runs++;
+}
+
+void run_loop(void* loop) {
+    static_cast<ControlLoop*>(loop)->run();
+}
+
+void reset_counts(int stall_run, std::uint32_t stall) {
+    loop_start_ms = sim_now_ms();
+    fast_runs = slow_runs = 0;
+    off_boundary = false;
+    stall_on_run = stall_run;
+    stall_ms = stall;
+}
+
+}  // namespace
+
+TEST(control_loop_runs_subsystems_at_their_rates) {
+    static ControlLoop loop(10);
+    CHECK(loop.add("fast", 10, fast_tick));
+    CHECK(loop.add("slow", 20, slow_tick));
+    CHECK(!loop.add("odd", 15, slow_tick));
+    CHECK(!loop.add("none", 0, slow_tick));
+
+    reset_counts(-1, 0);
+    void* task = start_sim_task(run_loop, &loop, TASK_PRIORITY_DEFAULT, "loop");
+    run_sim_for(995);  // ticks at 0, 10, ... 990
+    stop_sim_task(task);
+
+    const LoopStats& stats = loop.stats();
+    CHECK_EQ(stats.cycles, 100);
+    CHECK_EQ(fast_runs, 100);
+    CHECK_EQ(slow_runs, 50);
+    CHECK(!off_boundary);
+    CHECK_EQ(stats.overruns, 0);
+    CHECK_EQ(stats.skipped_ticks, 0);
+    CHECK_EQ(stats.max_jitter_us, 0);
+}
+
+TEST(control_loop_skips_ticks_after_an_overrun) {
+    static ControlLoop loop(10);
+    loop.add("fast", 10, fast_tick);
+    loop.add("slow", 20, slow_tick);
+
+    // Run 5 starts at 50 ms and takes 25, so the ticks at 60 and 70 are lost
+    // and the next one starts back on the grid at 80
+    reset_counts(5, 25);
+    void* task = start_sim_task(run_loop, &loop, TASK_PRIORITY_DEFAULT, "loop");
+    run_sim_for(995);
+    stop_sim_task(task);
+
+    const LoopStats& stats = loop.stats();
+    CHECK_EQ(stats.overruns, 1);
+    CHECK_EQ(stats.skipped_ticks, 2);
+    CHECK_EQ(stats.cycles + stats.skipped_ticks, 100);
+    CHECK(!off_boundary);
+    CHECK_EQ(stats.max_jitter_us, 20000);
+    CHECK_EQ(stats.total_jitter_us, 20000);
+    CHECK(stats.max_exec_us >= 25000);
+}
+
+TEST(control_loop_reset_stats_clears_everything) {
+    static ControlLoop loop(10);
+    loop.add("fast", 10, fast_tick);
+
+    reset_counts(0, 15);
+    void* task = start_sim_task(run_loop, &loop, TASK_PRIORITY_DEFAULT, "loop");
+    run_sim_for(195);
+    CHECK_EQ(loop.stats().overruns, 1);
+
+    loop.reset_stats();
+    run_sim_for(200);  // ticks at 200, 210, ... 390
+    stop_sim_task(task);
+
+    CHECK_EQ(loop.stats().overruns, 0);
+    CHECK_EQ(loop.stats().skipped_ticks, 0);
+    CHECK_EQ(loop.stats().cycles, 20);
+    CHECK_EQ(loop.stats().max_exec_us, 0);
+}
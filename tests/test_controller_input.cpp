@@ -0,0 +1,104 @@
+// ControllerInput (src/controller_input.cpp) against scripted controller input
+
+#include "main.h"
+#include "controller_input.hpp"
+#include "sim_world.hpp"
+#include "test.hpp"
+
+namespace {
+
+constexpr std::uint16_t L1 = button_bit(pros::E_CONTROLLER_DIGITAL_L1);
+constexpr std::uint16_t R2 = button_bit(pros::E_CONTROLLER_DIGITAL_R2);
+constexpr std::uint16_t A = button_bit(pros::E_CONTROLLER_DIGITAL_A);
+
+// One tick of input, and what the snapshot should say after it
+struct ScriptTick {
+    std::uint16_t buttons;
+    std::int8_t left_y;
+    std::uint16_t pressed;
+    std::uint16_t released;
+};
+
+const ScriptTick script[] = {
+    {0, 0, 0, 0},
+    {L1, 50, L1, 0},
+    {L1, 127, 0, 0},
+    {L1 | A, -127, A, 0},
+    {A, -20, 0, L1},
+    {R2, 0, R2, A},
+    {0, 0, 0, R2},
+};
+
+// Sets what the simulated controller reads, as sim --driver does
+void set_controller(std::uint16_t buttons, std::int8_t left_y) {
+    sim::SimController& pad = sim::world().controllers[0];
+    pad.buttons = buttons;
+    pad.analog[pros::E_CONTROLLER_ANALOG_LEFT_Y] = left_y;
+}
+
+}  // namespace
+
+TEST(controller_input_edges_follow_the_script) {
+    ControllerInput input(pros::E_CONTROLLER_MASTER);
+    for (const ScriptTick& tick : script) {
+        set_controller(tick.buttons, tick.left_y);
+        input.update();
+        const ControllerSnapshot& s = input.snapshot();
+        CHECK_EQ(s.held, tick.buttons);
+        CHECK_EQ(s.pressed, tick.pressed);
+        CHECK_EQ(s.released, tick.released);
+        CHECK_EQ(s.axis(pros::E_CONTROLLER_ANALOG_LEFT_Y), tick.left_y);
+    }
+    // 12 buttons and 4 axes, once per tick
+    CHECK_EQ(input.reads(), 16 * std::size(script));
+    set_controller(0, 0);
+}
+
+TEST(controller_input_apply_matches_update) {
+    ControllerInput sampled(pros::E_CONTROLLER_MASTER);
+    ControllerInput scripted(pros::E_CONTROLLER_MASTER);
+    for (const ScriptTick& tick : script) {
+        set_controller(tick.buttons, tick.left_y);
+        sampled.update();
+        std::int8_t axes[4] = {0, tick.left_y, 0, 0};
+        scripted.apply(tick.buttons, axes);
+
+        CHECK_EQ(scripted.snapshot().held, sampled.snapshot().held);
+        CHECK_EQ(scripted.snapshot().pressed, sampled.snapshot().pressed);
+        CHECK_EQ(scripted.snapshot().released, sampled.snapshot().released);
+        CHECK_EQ(scripted.snapshot().axes[1], sampled.snapshot().axes[1]);
+    }
+    CHECK_EQ(scripted.reads(), 0);
+    set_controller(0, 0);
+}
+
+TEST(controller_input_latches_edges_until_taken) {
+    ControllerInput input(pros::E_CONTROLLER_MASTER);
+    std::int8_t centered[4] = {};
+
+    // Pressed and released on ticks a slower subsystem didn't look at
+    input.apply(A, centered);
+    input.apply(0, centered);
+    input.apply(0, centered);
+    CHECK(!input.snapshot().was_pressed(pros::E_CONTROLLER_DIGITAL_A));
+    CHECK(input.take_press(pros::E_CONTROLLER_DIGITAL_A));
+    CHECK(!input.take_press(pros::E_CONTROLLER_DIGITAL_A));
+    CHECK(input.take_release(pros::E_CONTROLLER_DIGITAL_A));
+    CHECK(!input.take_release(pros::E_CONTROLLER_DIGITAL_A));
+    CHECK(!input.take_press(pros::E_CONTROLLER_DIGITAL_L1));
+}
+
+TEST(controller_input_reads_only_the_masked_inputs) {
+    ControllerInput input(pros::E_CONTROLLER_MASTER, L1 | A, 1u << pros::E_CONTROLLER_ANALOG_LEFT_Y);
+    set_controller(L1 | R2 | A, 90);
+    sim::world().controllers[0].analog[pros::E_CONTROLLER_ANALOG_RIGHT_X] = 40;
+    input.update();
+
+    CHECK_EQ(input.snapshot().held, L1 | A);
+    CHECK_EQ(input.snapshot().axis(pros::E_CONTROLLER_ANALOG_LEFT_Y), 90);
+    CHECK_EQ(input.snapshot().axis(pros::E_CONTROLLER_ANALOG_RIGHT_X), 0);
+    CHECK_EQ(input.reads(), 3);
+
+    sim::world().controllers[0].analog[pros::E_CONTROLLER_ANALOG_RIGHT_X] = 0;
+    set_controller(0, 0);
+}
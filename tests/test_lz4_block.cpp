@@ -0,0 +1,188 @@
+// The LZ4 block compressor and decoder (src/lz4_block.cpp) on the kinds of
+// blocks the telemetry logger writes, and on blocks cut short or corrupted
+// the way a log pulled off an SD card mid-write can be.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "lz4_block.hpp"
+#include "telemetry.hpp"
+#include "test.hpp"
+
+namespace {
+
+using Bytes = std::vector<std::uint8_t>;
+
+Bytes compress(const Bytes& raw) {
+    Bytes packed(lz4_bound(raw.size()));
+    std::size_t size = lz4_compress(raw.data(), raw.size(), packed.data(), packed.size());
+    packed.resize(size);
+    return packed;
+}
+
+// Decodes into a buffer with guard bytes after it, so a write past size shows up
+long decompress(const Bytes& packed, std::size_t size, Bytes& out) {
+    constexpr std::size_t GUARD = 64;
+    out.assign(size + GUARD, 0xa5);
+    long result = lz4_decompress(packed.data(), packed.size(), out.data(), size);
+    for (std::size_t i = size; i < size + GUARD; i++) {
+        if (out[i] != 0xa5) {
+            std::printf("  wrote past the end at %zu\n", i);
+            return -2;
+        }
+    }
+    out.resize(size);
+    return result;
+}
+
+void check_round_trip(const char* name, const Bytes& raw) {
+    Bytes packed = compress(raw);
+    CHECK(!packed.empty());
+    CHECK(packed.size() <= lz4_bound(raw.size()));
+    std::printf("  %s: %zu -> %zu bytes\n", name, raw.size(), packed.size());
+
+    Bytes out;
+    CHECK_EQ(decompress(packed, raw.size(), out), raw.size());
+    CHECK(out == raw);
+}
+
+// Every cut short version of the block, from empty to one byte short
+void check_truncations(const Bytes& raw) {
+    Bytes packed = compress(raw);
+    Bytes out;
+    int bad = 0;
+    for (std::size_t length = 0; length < packed.size(); length++) {
+        Bytes cut(packed.begin(), packed.begin() + length);
+        if (decompress(cut, raw.size(), out) != -1) bad++;
+    }
+    CHECK_EQ(bad, 0);
+}
+
+Bytes random_bytes(std::size_t n, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    Bytes bytes(n);
+    for (std::uint8_t& b : bytes) b = static_cast<std::uint8_t>(rng());
+    return bytes;
+}
+
+// Random bytes from a small alphabet in short runs, compressible but not trivially
+Bytes runs_of_bytes(std::size_t n, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    Bytes bytes;
+    while (bytes.size() < n) {
+        std::uint8_t value = static_cast<std::uint8_t>('a' + rng() % 6);
+        std::size_t run = 1 + rng() % 20;
+        for (std::size_t i = 0; i < run && bytes.size() < n; i++) bytes.push_back(value);
+    }
+    return bytes;
+}
+
+// A full block of drive records like the sampler writes, slowly changing, shuffled as the logger stores them
+Bytes shuffled_telemetry() {
+    TelemetryRecord records[TELEMETRY_RECORDS_PER_BLOCK];
+    std::memset(static_cast<void*>(records), 0, sizeof(records));
+    for (std::uint32_t i = 0; i < TELEMETRY_RECORDS_PER_BLOCK; i++) {
+        TelemetryRecord& r = records[i];
+        r.time_ms = 15000 + i * 10;
+        r.type = TELEMETRY_DRIVE;
+        r.flags = TELEMETRY_FLAG_AUTON;
+        r.seq = static_cast<std::uint16_t>(i);
+        r.drive.x = 0.5f * i;
+        r.drive.y = 0.01f * i * i;
+        r.drive.theta = 0.002f * i;
+        r.drive.left_mv = static_cast<std::int16_t>(6000 + 20 * i);
+        r.drive.right_mv = static_cast<std::int16_t>(5800 + 20 * i);
+        r.drive.left_rpm = static_cast<std::int16_t>(150 + i / 4);
+        r.drive.right_rpm = static_cast<std::int16_t>(148 + i / 4);
+        r.drive.left_ma = 1200;
+        r.drive.right_ma = 1180;
+    }
+    Bytes bytes(sizeof(records));
+    telemetry_shuffle(records, bytes.data(), TELEMETRY_RECORDS_PER_BLOCK);
+    return bytes;
+}
+
+}  // namespace
+
+TEST(lz4_round_trips) {
+    check_round_trip("empty", {});
+    check_round_trip("one byte", {42});
+    check_round_trip("just under the match limit", runs_of_bytes(12, 1));
+    check_round_trip("runs", runs_of_bytes(4000, 2));
+    check_round_trip("one long run", Bytes(LZ4_MAX_BLOCK_INPUT, 7));
+    check_round_trip("shuffled telemetry", shuffled_telemetry());
+
+    // Incompressible input grows, but stays within lz4_bound
+    check_round_trip("random", random_bytes(4000, 3));
+    check_round_trip("random, largest block", random_bytes(LZ4_MAX_BLOCK_INPUT, 4));
+}
+
+TEST(lz4_shuffled_telemetry_unshuffles) {
+    Bytes shuffled = shuffled_telemetry();
+    Bytes out;
+    CHECK_EQ(decompress(compress(shuffled), shuffled.size(), out), shuffled.size());
+
+    TelemetryRecord records[TELEMETRY_RECORDS_PER_BLOCK];
+    telemetry_unshuffle(out.data(), records, TELEMETRY_RECORDS_PER_BLOCK);
+    CHECK_EQ(records[0].time_ms, 15000);
+    CHECK_EQ(records[TELEMETRY_RECORDS_PER_BLOCK - 1].seq, TELEMETRY_RECORDS_PER_BLOCK - 1);
+    CHECK_EQ(records[100].drive.left_mv, 8000);
+}
+
+TEST(lz4_rejects_too_big_input) {
+    Bytes raw(LZ4_MAX_BLOCK_INPUT + 1, 0);
+    Bytes packed(lz4_bound(raw.size()));
+    CHECK_EQ(lz4_compress(raw.data(), raw.size(), packed.data(), packed.size()), 0);
+    // Nor does a block go into too little room
+    raw = random_bytes(1000, 5);
+    CHECK_EQ(lz4_compress(raw.data(), raw.size(), packed.data(), 500), 0);
+}
+
+TEST(lz4_truncated_blocks_fail) {
+    check_truncations({});
+    check_truncations(runs_of_bytes(4000, 6));
+    check_truncations(random_bytes(300, 7));
+    check_truncations(shuffled_telemetry());
+}
+
+TEST(lz4_wrong_size_fails) {
+    Bytes raw = runs_of_bytes(2000, 8);
+    Bytes packed = compress(raw);
+    Bytes out;
+    CHECK_EQ(decompress(packed, raw.size() - 1, out), -1);
+    CHECK_EQ(decompress(packed, raw.size() + 1, out), -1);
+}
+
+TEST(lz4_corrupt_blocks_fail) {
+    Bytes out;
+    // 4 literals, then a match with offset 0
+    CHECK_EQ(decompress({0x40, 'a', 'b', 'c', 'd', 0, 0, 0x00}, 8, out), -1);
+    // Offset back past the start of the output
+    CHECK_EQ(decompress({0x40, 'a', 'b', 'c', 'd', 5, 0, 0x00}, 8, out), -1);
+    // More literals than the block has
+    CHECK_EQ(decompress({0x50, 'a', 'b', 'c', 'd'}, 5, out), -1);
+    // A 15 nibble with its extra length bytes missing
+    CHECK_EQ(decompress({0xf0, 255, 255}, 600, out), -1);
+    // A last sequence that has a match length but no offset
+    CHECK_EQ(decompress({0x41, 'a', 'b', 'c', 'd'}, 4, out), -1);
+    // A match running past the output
+    CHECK_EQ(decompress({0x4f, 'a', 'b', 'c', 'd', 1, 0, 200, 0x00}, 100, out), -1);
+
+    // Random damage to a real block never reads or writes out of bounds, and
+    // mostly gets caught. Damage in the literals can't be, LZ4 has no checksum.
+    Bytes raw = shuffled_telemetry();
+    Bytes packed = compress(raw);
+    std::mt19937 rng(9);
+    int wrote_past = 0;
+    for (int i = 0; i < 2000; i++) {
+        Bytes damaged = packed;
+        for (int j = 0; j < 3; j++) damaged[rng() % damaged.size()] ^= static_cast<std::uint8_t>(1 + rng() % 255);
+        long result = decompress(damaged, raw.size(), out);
+        if (result == -2) wrote_past++;
+        CHECK(result == -1 || result == static_cast<long>(raw.size()));
+    }
+    CHECK_EQ(wrote_past, 0);
+}
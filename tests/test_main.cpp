@@ -0,0 +1,100 @@
+// Host unit test runner, `make test`.
+//
+//   tests [name...]
+//
+// Runs every TEST (tests/test.hpp), or just those whose name contains one of
+// the arguments. Exits 1 if any check failed.
+
+#include "test.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sim_kernel.hpp"
+
+namespace {
+
+struct TestCase {
+    const char* name;
+    TestFn fn;
+};
+
+std::vector<TestCase>& all_tests() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+int failed_checks = 0;  // in the running test
+
+bool selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (std::strstr(name, argv[i]) != nullptr) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool register_test(const char* name, TestFn fn) {
+    all_tests().push_back({name, fn});
+    return true;
+}
+
+void check_failed(const char* file, int line, const char* expression) {
+    std::printf("  %s:%d: CHECK(%s) failed\n", file, line, expression);
+    failed_checks++;
+}
+
+void check_equal_failed(const char* file, int line, const char* expression, long long value, long long expected) {
+    std::printf("  %s:%d: %s is %lld, expected %lld\n", file, line, expression, value, expected);
+    failed_checks++;
+}
+
+void check_near_failed(const char* file, int line, const char* expression, double value, double expected,
+                       double tolerance) {
+    std::printf("  %s:%d: %s is %.6g, expected %.6g +- %.3g\n", file, line, expression, value, expected, tolerance);
+    failed_checks++;
+}
+
+std::uint32_t sim_now_ms() {
+    return sim::now_ms();
+}
+
+void* start_sim_task(void (*fn)(void*), void* arg, std::uint32_t priority, const char* name) {
+    return sim::create_task(fn, arg, priority, name);
+}
+
+void stop_sim_task(void* task) {
+    sim::delete_task(static_cast<sim::Task*>(task));
+}
+
+void run_sim_for(std::uint32_t ms) {
+    sim::run_until_us(sim::now_us() + ms * 1000ull);
+}
+
+bool run_sim_until_done(void* task, std::uint32_t timeout_ms) {
+    sim::Task* t = static_cast<sim::Task*>(task);
+    std::uint32_t end = sim::now_ms() + timeout_ms;
+    while (!sim::task_finished(t) && sim::now_ms() < end) run_sim_for(1);
+    return sim::task_finished(t);
+}
+
+int main(int argc, char** argv) {
+    int run = 0, failed = 0;
+    for (const TestCase& test : all_tests()) {
+        if (!selected(test.name, argc, argv)) continue;
+        failed_checks = 0;
+        test.fn();
+        run++;
+        if (failed_checks > 0) failed++;
+        std::printf("%s %s\n", failed_checks > 0 ? "FAIL" : "ok  ", test.name);
+    }
+    std::printf("\n%d tests, %d failed\n", run, failed);
+
+    // Tasks the tests left behind are still parked on their threads, don't wait for them
+    std::fflush(nullptr);
+    std::_Exit(failed > 0 ? 1 : 0);
+}
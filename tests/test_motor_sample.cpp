@@ -0,0 +1,123 @@
+// MotorGroupSnapshot (src/motor_sample.cpp), and a benchmark against reading
+// the same fields the way MotorGroup::get_*_all() does
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "main.h"
+#include "motor_sample.hpp"
+#include "sim_world.hpp"
+#include "test.hpp"
+
+// Counts heap allocations for the whole test binary, the benchmark looks at the difference
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// Six motors on ports the robot code doesn't use
+const std::int8_t PORTS[] = {2, 3, 4, -5, 6, -7};
+constexpr std::uint16_t SIX_FIELDS =
+    FIELD_POSITION | FIELD_VELOCITY | FIELD_CURRENT | FIELD_TEMPERATURE | FIELD_TORQUE | FIELD_VOLTAGE;
+
+void attach_motors() {
+    for (std::int8_t port : PORTS) {
+        int p = port < 0 ? -port : port;
+        sim::world().attach_motor(p, sim::ROLE_FREE);
+        sim::world().motors[p].report_angle = p * 0.5;
+        sim::world().motors[p].temperature = 30 + p;
+    }
+}
+
+// What each MotorGroup::get_*_all() call does: take the group's mutex and
+// read every motor into a new vector
+std::mutex group_mutex;
+
+template <typename Read>
+auto read_all(Read read) {
+    std::lock_guard<std::mutex> lock(group_mutex);
+    std::vector<decltype(read(PORTS[0]))> values;
+    for (std::int8_t port : PORTS) values.push_back(read(port));
+    return values;
+}
+
+double sample_with_all_getters() {
+    using namespace pros::c;
+    auto position = read_all(motor_get_position);
+    auto velocity = read_all(motor_get_actual_velocity);
+    auto current = read_all(motor_get_current_draw);
+    auto temperature = read_all(motor_get_temperature);
+    auto torque = read_all(motor_get_torque);
+    auto voltage = read_all(motor_get_voltage);
+    return position[0] + velocity[0] + current[0] + temperature[0] + torque[0] + voltage[0];
+}
+
+}  // namespace
+
+TEST(motor_snapshot_reads_the_masked_fields) {
+    attach_motors();
+    MotorGroupSnapshot snapshot;
+    snapshot.bind(PORTS);
+    CHECK_EQ(snapshot.count, std::size(PORTS));
+
+    snapshot.sample(FIELD_POSITION | FIELD_TEMPERATURE);
+    CHECK_EQ(snapshot.fields, FIELD_POSITION | FIELD_TEMPERATURE);
+    for (int i = 0; i < snapshot.count; i++) {
+        CHECK_NEAR(snapshot.position[i], pros::c::motor_get_position(PORTS[i]), 1e-9);
+        CHECK_NEAR(snapshot.temperature[i], pros::c::motor_get_temperature(PORTS[i]), 1e-9);
+        CHECK_EQ(snapshot.voltage[i], 0);  // not in the mask, never read
+    }
+}
+
+TEST(motor_snapshot_keeps_the_first_capacity_motors) {
+    // Prints the warning, a group this big is a wiring mistake
+    const std::int8_t ports[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    MotorGroupSnapshot snapshot;
+    snapshot.bind(ports);
+    CHECK_EQ(snapshot.count, MotorGroupSnapshot::CAPACITY);
+    CHECK_EQ(snapshot.ports[MotorGroupSnapshot::CAPACITY - 1], 8);
+}
+
+TEST(motor_snapshot_benchmark) {
+    attach_motors();
+    MotorGroupSnapshot snapshot;
+    snapshot.bind(PORTS);
+    constexpr int RUNS = 20000;
+
+    std::size_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++) snapshot.sample(SIX_FIELDS);
+    double sample_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::size_t sample_allocations = allocations.load() - before;
+
+    volatile double sink = 0;
+    before = allocations.load();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RUNS; i++) sink = sink + sample_with_all_getters();
+    double all_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::size_t all_allocations = allocations.load() - before;
+
+    std::printf("  6 fields of 6 motors: sample() %.3f us and %.1f allocations per tick, "
+                "_all getters %.3f us and %.1f allocations\n",
+                sample_us / RUNS, double(sample_allocations) / RUNS, all_us / RUNS, double(all_allocations) / RUNS);
+    CHECK_EQ(sample_allocations, 0);
+    CHECK(all_allocations >= 6u * RUNS);
+}
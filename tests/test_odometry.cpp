@@ -0,0 +1,125 @@
+// DriveOdometry (src/odometry.cpp) against reference encoder traces.
+//
+// Each trace is a drive described by its forward speed and turn rate over time.
+// The reference pose comes from integrating that finely (1000 steps per tick),
+// and the encoder counts the odometry sees are the wheel travel rounded to
+// whole counts every 10 ms, the same as the motors report.
+
+#include <cmath>
+#include <functional>
+
+#include "odometry.hpp"
+#include "test.hpp"
+
+namespace {
+
+constexpr double COUNTS_PER_INCH = 900 / (M_PI * 3.25);
+constexpr double TRACK_WIDTH = 12;
+constexpr double TICK_S = 0.01;
+
+struct Command {
+    double velocity;          // in/s
+    double angular_velocity;  // rad/s
+};
+
+struct TraceResult {
+    Pose reference;  // where the robot really ended up
+    Pose odometry;
+};
+
+// Runs the drive for seconds. wheel_scale scales the right wheel's reported
+// travel, like a slipping wheel, the IMU still sees the true heading.
+TraceResult run_trace(const std::function<Command(double t)>& drive, double seconds, double imu_weight,
+                      bool use_imu, double wheel_scale = 1) {
+    DriveOdometry odometry({.counts_per_inch = COUNTS_PER_INCH, .track_width = TRACK_WIDTH, .imu_weight = imu_weight});
+    odometry.reset(Pose{}, 0, 0, use_imu ? 0 : NAN);
+
+    Pose truth;
+    double left = 0, right = 0;  // true wheel travel, in
+    int ticks = std::lround(seconds / TICK_S);
+    constexpr int SUBSTEPS = 1000;
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int k = 0; k < SUBSTEPS; k++) {
+            double dt = TICK_S / SUBSTEPS;
+            Command c = drive((tick + (k + 0.5) / SUBSTEPS) * TICK_S);
+            double mid_theta = truth.theta + c.angular_velocity * dt / 2;
+            truth.x += c.velocity * std::cos(mid_theta) * dt;
+            truth.y += c.velocity * std::sin(mid_theta) * dt;
+            truth.theta += c.angular_velocity * dt;
+            left += (c.velocity - c.angular_velocity * TRACK_WIDTH / 2) * dt;
+            right += (c.velocity + c.angular_velocity * TRACK_WIDTH / 2) * dt;
+        }
+        std::int32_t left_counts = std::lround(left * COUNTS_PER_INCH);
+        std::int32_t right_counts = std::lround(right * wheel_scale * COUNTS_PER_INCH);
+        odometry.update(left_counts, right_counts, (tick + 1) * 10, use_imu ? truth.theta : NAN);
+    }
+    return {truth, odometry.pose()};
+}
+
+double position_error(const TraceResult& r) {
+    return std::hypot(r.odometry.x - r.reference.x, r.odometry.y - r.reference.y);
+}
+
+}  // namespace
+
+TEST(odometry_straight_line) {
+    TraceResult r = run_trace([](double) { return Command{24, 0}; }, 1.0, 0, false);
+    CHECK_NEAR(r.reference.x, 24, 1e-9);
+    CHECK_NEAR(r.odometry.x, 24, 0.01);
+    CHECK_NEAR(r.odometry.y, 0, 1e-9);
+    CHECK_NEAR(r.odometry.theta, 0, 1e-9);
+}
+
+TEST(odometry_quarter_circle) {
+    // 24 in radius to the left, a quarter turn in 2 s: ends at (24, 24) facing +y
+    double w = M_PI / 2 / 2.0;
+    TraceResult r = run_trace([w](double) { return Command{24 * w, w}; }, 2.0, 0, false);
+    CHECK_NEAR(r.reference.x, 24, 1e-6);
+    CHECK_NEAR(r.reference.y, 24, 1e-6);
+    CHECK_NEAR(r.odometry.theta, M_PI / 2, 0.002);
+    CHECK_NEAR(position_error(r), 0, 0.02);
+}
+
+TEST(odometry_turn_in_place) {
+    TraceResult r = run_trace([](double) { return Command{0, -3}; }, 1.0, 0, false);
+    CHECK_NEAR(r.odometry.theta, -3, 0.002);
+    CHECK_NEAR(position_error(r), 0, 1e-9);
+}
+
+TEST(odometry_s_curve_with_changing_speed) {
+    // Speeds up and slows down while the curvature swings left then right
+    auto drive = [](double t) {
+        double v = 30 * std::sin(M_PI * t / 3);
+        return Command{v, v * 0.05 * std::sin(2 * M_PI * t / 3)};
+    };
+    TraceResult r = run_trace(drive, 3.0, 0, false);
+    CHECK(std::hypot(r.reference.x, r.reference.y) > 50);
+    CHECK_NEAR(r.odometry.theta, r.reference.theta, 0.005);
+    CHECK_NEAR(position_error(r), 0, 0.1);
+}
+
+TEST(odometry_imu_corrects_a_slipping_wheel) {
+    // The right wheel reports 3% short, so encoder heading drifts the wrong way
+    double w = M_PI / 2 / 2.0;
+    auto drive = [w](double) { return Command{24 * w, w}; };
+    TraceResult encoders = run_trace(drive, 2.0, 0, false, 0.97);
+    TraceResult fused = run_trace(drive, 2.0, 1, true, 0.97);
+    CHECK(std::fabs(encoders.odometry.theta - encoders.reference.theta) > 0.1);
+    CHECK_NEAR(fused.odometry.theta, fused.reference.theta, 1e-9);
+    // What's left is the distance the slipping wheel didn't report
+    CHECK(position_error(fused) < position_error(encoders) / 2);
+}
+
+TEST(odometry_skips_a_repeated_sample) {
+    DriveOdometry odometry({.counts_per_inch = COUNTS_PER_INCH, .track_width = TRACK_WIDTH, .imu_weight = 0});
+    odometry.reset(Pose{}, 0, 0, NAN);
+    std::int32_t inch = std::lround(COUNTS_PER_INCH);
+
+    CHECK(odometry.update(inch, inch, 10, NAN));
+    CHECK(odometry.update(2 * inch, 2 * inch, 20, NAN));
+    CHECK(!odometry.update(3 * inch, 3 * inch, 20, NAN));
+    CHECK_NEAR(odometry.pose().x, 2 * inch / COUNTS_PER_INCH, 1e-9);
+    CHECK_EQ(odometry.pose().timestamp, 20);
+    // An inch per 10 ms of device time
+    CHECK_NEAR(odometry.linear_velocity(), inch / COUNTS_PER_INCH / 0.01, 1e-6);
+}
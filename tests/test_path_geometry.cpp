@@ -0,0 +1,179 @@
+// Path geometry (src/path_geometry.cpp) against a high-precision reference
+// integration of the arc length, done here independently of the library.
+
+#include <cmath>
+
+#include "path_geometry.hpp"
+#include "pure_pursuit.hpp"
+#include "test.hpp"
+
+namespace {
+
+// Composite Simpson's rule on |dP/du|, many more intervals than it needs
+double reference_arc_length(const Curve& curve, double u0, double u1, int intervals = 20000) {
+    auto speed = [&](double u) {
+        Vec2 d = curve.derivative(u);
+        return std::hypot(d.x, d.y);
+    };
+    double h = (u1 - u0) / intervals;
+    double sum = speed(u0) + speed(u1);
+    for (int i = 1; i < intervals; i++) sum += speed(u0 + i * h) * (i % 2 ? 4 : 2);
+    return sum * h / 3;
+}
+
+// A quarter circle of radius 24 (to within 0.03%), and a quintic S
+const CubicBezier quarter({24, 0}, {24, 24 * 0.5523}, {24 * 0.5523, 24}, {0, 24});
+const QuinticHermite s_curve({0, 0}, {60, 0}, {0, 0}, {36, 24}, {60, 0}, {0, 0});
+
+}  // namespace
+
+TEST(path_quadrature_matches_reference) {
+    // 5-point Gauss-Legendre: close over the whole curve in one go, exact to
+    // rounding over the slices the tables use
+    CHECK_NEAR(integrate_arc_length(quarter, 0, 1), reference_arc_length(quarter, 0, 1), 1e-3);
+    CHECK_NEAR(integrate_arc_length(quarter, 0, 1, 64), reference_arc_length(quarter, 0, 1), 1e-9);
+    CHECK_NEAR(integrate_arc_length(s_curve, 0, 1, 64), reference_arc_length(s_curve, 0, 1), 1e-9);
+    CHECK_NEAR(integrate_arc_length(quarter, 0, 1, 64), 24 * M_PI / 2, 0.02);
+
+    CubicBezier line({0, 0}, {1, 1}, {2, 2}, {3, 3});
+    CHECK_NEAR(integrate_arc_length(line, 0, 1), 3 * std::sqrt(2.0), 1e-9);
+}
+
+TEST(path_arc_length_table_inverts_to_reference) {
+    const Curve* curves[] = {&quarter, &s_curve};
+    for (const Curve* curve : curves) {
+        ArcLengthTable table;
+        table.build(*curve);
+        double length = reference_arc_length(*curve, 0, 1);
+        CHECK_NEAR(table.length(), length, 1e-3);
+
+        // The arc length up to the parameter the table gives back is the one asked for
+        for (int i = 0; i <= 20; i++) {
+            double s = length * i / 20;
+            double u = table.parameter_at(s);
+            CHECK_NEAR(reference_arc_length(*curve, 0, u), s, 0.01);
+        }
+        CHECK_NEAR(table.parameter_at(-1), 0, 1e-9);
+        CHECK_NEAR(table.parameter_at(length + 1), 1, 1e-9);
+    }
+}
+
+TEST(path_curvature_is_heading_change_per_inch) {
+    CHECK_NEAR(quarter.curvature(0.5), 1 / 24.0, 1e-3);
+
+    // dtheta / ds by central differences, with ds from the reference integration
+    for (double u = 0.1; u < 0.95; u += 0.1) {
+        double h = 1e-4;
+        double d_heading = std::remainder(s_curve.heading(u + h) - s_curve.heading(u - h), 2 * M_PI);
+        double ds = reference_arc_length(s_curve, u - h, u + h, 20);
+        CHECK_NEAR(s_curve.curvature(u), d_heading / ds, 1e-5);
+    }
+}
+
+TEST(path_spline_is_continuous_through_waypoints) {
+    const Waypoint waypoints[] = {{0, 0, 0}, {36, 24, M_PI / 2}, {36, 60, M_PI / 2}, {0, 84, M_PI}};
+    SplinePath path;
+    CHECK(path.build(waypoints, 4));
+    CHECK(!path.build(waypoints, 1));
+    CHECK(path.build(waypoints, 4));
+
+    // Each waypoint is on the path, crossed at its heading
+    for (const Waypoint& w : waypoints) {
+        CurvePoint closest;
+        double best = INFINITY;
+        for (double at = 0; at <= path.length(); at += 0.01) {
+            CurvePoint p = path.sample(at);
+            double distance = std::hypot(p.x - w.x, p.y - w.y);
+            if (distance < best) {
+                best = distance;
+                closest = p;
+            }
+        }
+        CHECK_NEAR(best, 0, 0.01);
+        CHECK_NEAR(std::remainder(closest.heading - w.heading, 2 * M_PI), 0, 0.01);
+    }
+
+    CurvePoint start = path.sample(0), end = path.sample(path.length());
+    CHECK_NEAR(start.x, 0, 1e-9);
+    CHECK_NEAR(end.x, 0, 1e-6);
+    CHECK_NEAR(end.y, 84, 1e-6);
+    CHECK_NEAR(std::remainder(end.heading - M_PI, 2 * M_PI), 0, 1e-6);
+
+    // Small steps along the path move about as far as the step, with no jumps in heading or curvature
+    CurvePoint previous = start;
+    for (double at = 0.25; at <= path.length(); at += 0.25) {
+        CurvePoint p = path.sample(at);
+        CHECK_NEAR(std::hypot(p.x - previous.x, p.y - previous.y), 0.25, 0.01);
+        CHECK(std::fabs(std::remainder(p.heading - previous.heading, 2 * M_PI)) < 0.05);
+        CHECK(std::fabs(p.curvature - previous.curvature) < 0.01);
+        previous = p;
+    }
+}
+
+TEST(path_bezier_chain_is_the_bezier_curves) {
+    const Vec2 controls[] = {{0, 0}, {12, 0}, {24, 12}, {24, 24}, {24, 36}, {12, 48}, {0, 48}};
+    CubicBezier first(controls[0], controls[1], controls[2], controls[3]);
+    CubicBezier second(controls[3], controls[4], controls[5], controls[6]);
+    SplinePath path;
+    CHECK(path.build_bezier(controls, 7));
+    double first_length = reference_arc_length(first, 0, 1);
+    CHECK_NEAR(path.length(), first_length + reference_arc_length(second, 0, 1), 1e-3);
+
+    // The same points as the Bezier curves at the same distance along them
+    for (int i = 0; i <= 10; i++) {
+        double u = i / 10.0;
+        CurvePoint on_first = path.sample(reference_arc_length(first, 0, u));
+        CurvePoint on_second = path.sample(first_length + reference_arc_length(second, 0, u));
+        CHECK_NEAR(std::hypot(on_first.x - first.position(u).x, on_first.y - first.position(u).y), 0, 0.01);
+        CHECK_NEAR(std::hypot(on_second.x - second.position(u).x, on_second.y - second.position(u).y), 0, 0.01);
+        if (i > 0 && i < 10) CHECK_NEAR(on_first.curvature, first.curvature(u), 1e-3);
+    }
+
+    CHECK(!path.build_bezier(controls, 6));
+    CHECK(!path.build_bezier(controls, 1));
+    CHECK_NEAR(path.length(), 0, 1e-12);
+}
+
+TEST(path_inject_points_spacing) {
+    const Waypoint waypoints[] = {{0, 0, 0}, {36, 24, M_PI / 2}};
+    SplinePath path;
+    path.build(waypoints, 2);
+
+    CurvePoint points[64];
+    int count = path.inject_points(2, points, 64);
+    CHECK_EQ(count, static_cast<int>(std::ceil(path.length() / 2)) + 1);
+    for (int i = 1; i < count - 1; i++) CHECK_NEAR(points[i].s - points[i - 1].s, 2, 1e-9);
+    CHECK_NEAR(points[count - 1].s, path.length(), 1e-9);
+    CHECK_NEAR(points[count - 1].x, 36, 1e-6);
+
+    // Stops at the capacity, still ending on the end point
+    CHECK_EQ(path.inject_points(2, points, 5), 5);
+    CHECK_NEAR(points[4].s, path.length(), 1e-9);
+}
+
+TEST(path_follower_points_respect_the_limits) {
+    const Waypoint waypoints[] = {{0, 0, 0}, {36, 24, M_PI / 2}, {36, 60, M_PI / 2}};
+    SplinePath spline;
+    spline.build(waypoints, 3);
+    static Path path;
+    CHECK(path.build(spline, 1, 40, 60, 3));
+    CHECK_NEAR(path.length(), spline.length(), 0.05);
+
+    // Within the speed and curve limits, and slowing down no harder than the acceleration limit
+    for (int i = 0; i < path.size(); i++) {
+        CHECK(path[i].max_velocity <= 40 + 1e-3);
+        if (std::fabs(path[i].curvature) > 1e-6) CHECK(path[i].max_velocity <= 3 / std::fabs(path[i].curvature) + 1e-3);
+        if (i + 1 < path.size()) {
+            double ds = path[i + 1].s - path[i].s;
+            double reachable = path[i + 1].max_velocity * path[i + 1].max_velocity + 2 * 60 * ds;
+            CHECK(path[i].max_velocity * path[i].max_velocity <= reachable + 1e-2);
+        }
+    }
+    CHECK_NEAR(path[path.size() - 1].max_velocity, 0, 1e-6);
+
+    // A path needs two points to have a direction
+    path.clear();
+    path.add_waypoint(0, 0);
+    CHECK(!path.build(1, 40, 60, 3));
+    CHECK_EQ(path.size(), 0);
+}
@@ -0,0 +1,125 @@
+// SpscRing (src/spsc_ring.hpp) with a real producer and consumer thread.
+// Runs outside the sim kernel, on the host's own threads, so the two sides
+// really do race.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "spsc_ring.hpp"
+#include "test.hpp"
+
+namespace {
+
+struct Item {
+    std::uint32_t sequence;
+    std::uint32_t check;  // derived from sequence, catches a slot read half written
+};
+
+constexpr std::uint32_t check_for(std::uint32_t sequence) {
+    return sequence * 2654435761u ^ 0x5bd1e995u;
+}
+
+struct StressResult {
+    std::uint32_t pushed = 0;  // push() returned true
+    std::uint32_t popped = 0;
+    std::uint32_t dropped = 0;  // what the ring counted
+    std::uint32_t out_of_order = 0;
+    std::uint32_t torn = 0;
+};
+
+// The producer pushes count items, giving up the CPU every yield_every so the
+// two sides interleave even on one core. The consumer pops them one at a time or
+// in batches.
+template <std::size_t N>
+StressResult stress(std::uint32_t count, std::uint32_t yield_every, bool batches) {
+    SpscRing<Item, N> ring;
+    StressResult result;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (std::uint32_t i = 0; i < count; i++) {
+            if (ring.push({i, check_for(i)})) result.pushed++;
+            if (i % yield_every == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::thread consumer([&] {
+        bool seen_any = false;
+        std::uint32_t last = 0;
+        auto take = [&](const Item& item) {
+            if (item.check != check_for(item.sequence)) result.torn++;
+            if (seen_any && item.sequence <= last) result.out_of_order++;
+            seen_any = true;
+            last = item.sequence;
+            result.popped++;
+        };
+        Item batch[16];
+        while (true) {
+            bool finished = done.load(std::memory_order_acquire);
+            std::size_t got = 0;
+            if (batches) {
+                got = ring.pop_many(batch, 16);
+                for (std::size_t i = 0; i < got; i++) take(batch[i]);
+            } else if (ring.pop(batch[0])) {
+                take(batch[0]);
+                got = 1;
+            }
+            // Only stop once the ring was empty after the producer finished
+            if (got == 0) {
+                if (finished) break;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    result.dropped = ring.dropped();
+    return result;
+}
+
+template <std::size_t N>
+void check_stress(std::uint32_t count, std::uint32_t yield_every, bool batches) {
+    StressResult r = stress<N>(count, yield_every, batches);
+    std::printf("  ring of %zu, %s: %u pushed, %u dropped\n", N, batches ? "batches" : "one at a time", r.pushed,
+                r.dropped);
+    CHECK_EQ(r.popped, r.pushed);
+    CHECK_EQ(r.popped + r.dropped, count);
+    CHECK_EQ(r.out_of_order, 0);
+    CHECK_EQ(r.torn, 0);
+}
+
+}  // namespace
+
+TEST(spsc_ring_single_thread) {
+    SpscRing<int, 4> ring{};
+    int item = 0;
+    CHECK(!ring.pop(item));
+    for (int i = 0; i < 4; i++) CHECK(ring.push(i));
+    CHECK(!ring.push(4));
+    CHECK_EQ(ring.dropped(), 1);
+    CHECK_EQ(ring.size(), 4);
+
+    CHECK(ring.pop(item));
+    CHECK_EQ(item, 0);
+    CHECK(ring.push(5));
+    int out[8];
+    CHECK_EQ(ring.pop_many(out, 8), 4);
+    CHECK_EQ(out[0], 1);
+    CHECK_EQ(out[3], 5);
+    CHECK_EQ(ring.size(), 0);
+}
+
+TEST(spsc_ring_threads_pop_one_at_a_time) {
+    // A small ring overflows between yields and drops, a big one keeps up
+    check_stress<8>(200000, 12, false);
+    check_stress<1024>(200000, 64, false);
+}
+
+TEST(spsc_ring_threads_pop_in_batches) {
+    check_stress<8>(200000, 12, true);
+    check_stress<1024>(200000, 64, true);
+}
@@ -0,0 +1,148 @@
+// The delta-encoded trajectory tables (src/trajectory.cpp): a table built by
+// hand decodes to exactly the samples it was built from, and the ones pathc
+// generated from paths/ start and end where their path files say.
+
+#include <cmath>
+#include <cstdint>
+
+#include "test.hpp"
+#include "trajectory.hpp"
+
+namespace {
+
+struct Counts {
+    std::int32_t x, y, theta, v, omega;
+};
+
+// Quantized samples with deltas of both signs, up to the limits of their types
+const Counts hand_samples[] = {
+    {0, 0, 0, 0, 0},
+    {127, -128, 32767, 127, -128},
+    {254, -256, 0, 100, -100},
+    {200, -200, -32768, -28, 27},
+    {200, -200, -32768, -28, 27},
+};
+constexpr int HAND_COUNT = sizeof(hand_samples) / sizeof(hand_samples[0]);
+
+TrajectoryDelta hand_deltas[HAND_COUNT - 1];
+
+const TrajectoryTable& hand_table() {
+    for (int i = 1; i < HAND_COUNT; i++) {
+        const Counts& a = hand_samples[i - 1];
+        const Counts& b = hand_samples[i];
+        hand_deltas[i - 1] = {static_cast<std::int8_t>(b.x - a.x), static_cast<std::int8_t>(b.y - a.y),
+                              static_cast<std::int16_t>(b.theta - a.theta), static_cast<std::int8_t>(b.v - a.v),
+                              static_cast<std::int8_t>(b.omega - a.omega)};
+    }
+    static const TrajectoryTable table = {"hand", 10, HAND_COUNT, 0, 0, 0, 0, 0, hand_deltas};
+    return table;
+}
+
+// Exact, every count is a power of two fraction or a product small enough for a float
+void check_sample(const TrajectorySample& sample, int index) {
+    const Counts& c = hand_samples[index];
+    CHECK_EQ(sample.time, index * 10);
+    CHECK_NEAR(sample.x, c.x / TRAJ_POSITION_SCALE, 1e-6);
+    CHECK_NEAR(sample.y, c.y / TRAJ_POSITION_SCALE, 1e-6);
+    CHECK_NEAR(sample.theta, c.theta / TRAJ_THETA_SCALE, 1e-6);
+    CHECK_NEAR(sample.velocity, c.v / TRAJ_VELOCITY_SCALE, 1e-6);
+    CHECK_NEAR(sample.angular_velocity, c.omega / TRAJ_OMEGA_SCALE, 1e-6);
+}
+
+// Decodes a whole generated table and checks it against its path file
+void check_generated(const char* name, float end_x, float end_y, float end_theta, float max_velocity) {
+    const TrajectoryTable* table = find_trajectory(name);
+    CHECK(table != nullptr);
+    if (table == nullptr) return;
+
+    TrajectoryStream stream;
+    stream.reset(*table);
+    TrajectorySample first, sample, previous;
+    CHECK(stream.next(first));
+    CHECK_NEAR(first.x, 0, 1e-6);
+    CHECK_NEAR(first.y, 0, 1e-6);
+    CHECK_NEAR(first.theta, 0, 1e-6);
+    CHECK_NEAR(first.velocity, 0, 1e-6);
+
+    // The positions follow the velocities: what the deltas add up to each tick
+    // is the distance the profile says was covered, to within quantization
+    previous = first;
+    float dt = table->dt_ms / 1000.0f;
+    float worst_step = 0;
+    float fastest = 0;
+    int samples = 1;
+    while (stream.next(sample)) {
+        float step = std::hypot(sample.x - previous.x, sample.y - previous.y);
+        float expected = (sample.velocity + previous.velocity) / 2 * dt;
+        worst_step = std::fmax(worst_step, std::fabs(step - expected));
+        fastest = std::fmax(fastest, sample.velocity);
+        CHECK_EQ(sample.time, samples * table->dt_ms);
+        previous = sample;
+        samples++;
+    }
+    CHECK_EQ(samples, table->count);
+    CHECK(stream.finished());
+    CHECK_EQ(stream.duration(), (table->count - 1) * table->dt_ms);
+    CHECK(worst_step < 0.03f);
+    CHECK(fastest <= max_velocity + 1 / TRAJ_VELOCITY_SCALE);
+
+    CHECK_NEAR(sample.x, end_x, 1 / TRAJ_POSITION_SCALE);
+    CHECK_NEAR(sample.y, end_y, 1 / TRAJ_POSITION_SCALE);
+    CHECK_NEAR(sample.theta, end_theta, 1e-3);
+    CHECK_NEAR(sample.velocity, 0, 1e-6);
+}
+
+}  // namespace
+
+TEST(trajectory_decodes_its_deltas) {
+    TrajectoryStream stream;
+    CHECK(stream.finished());
+    CHECK_EQ(stream.duration(), 0);
+
+    stream.reset(hand_table());
+    CHECK_EQ(stream.duration(), 40);
+    TrajectorySample sample;
+    for (int i = 0; i < HAND_COUNT; i++) {
+        CHECK(stream.next(sample));
+        check_sample(sample, i);
+    }
+    CHECK(stream.finished());
+    CHECK(!stream.next(sample));
+
+    // reset() starts over from the first sample
+    stream.reset(hand_table());
+    CHECK(stream.next(sample));
+    check_sample(sample, 0);
+}
+
+TEST(trajectory_seek_matches_next) {
+    TrajectoryStream stream;
+    TrajectorySample sample;
+    CHECK(!stream.seek(0, sample));
+
+    stream.reset(hand_table());
+    CHECK(stream.seek(0, sample));
+    check_sample(sample, 0);
+    // Between samples it's the one before
+    CHECK(stream.seek(19, sample));
+    check_sample(sample, 1);
+    CHECK(stream.seek(20, sample));
+    check_sample(sample, 2);
+    // Back in time it stays put, forwards only
+    CHECK(stream.seek(5, sample));
+    check_sample(sample, 2);
+    // Past the end it holds the final sample
+    CHECK(stream.seek(1000, sample));
+    check_sample(sample, HAND_COUNT - 1);
+    CHECK(stream.finished());
+}
+
+TEST(trajectory_generated_tables_follow_their_paths) {
+    CHECK(find_trajectory("no_such_path") == nullptr);
+
+    // paths/left_qual_auton.path: 28 in straight ahead at up to 30 in/s
+    check_generated("left_qual_auton", 28, 0, 0, 30);
+    // paths/sample_s_curve.path: ends at (0, 84) facing 180 degrees, turned
+    // counter-clockwise the whole way so theta is unwrapped to +pi
+    check_generated("sample_s_curve", 0, 84, M_PI, 30);
+}
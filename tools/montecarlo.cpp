@@ -0,0 +1,373 @@
+// montecarlo: runs each auton thousands of times in the simulator, every run
+// with the robot set down a little off, the drive motors a little weak, the
+// battery somewhere between tired and fresh and noisy encoders, across every
+// core. Reports how often each auton still works, how far off it ends and how
+// long it takes at worst, to pick between auton variants with numbers.
+//
+//   montecarlo [-j threads] [-n runs] [--sim path] [--seed n] [--csv file]
+//              [--target n x y heading|-] [--tolerance in deg]
+//              [--start-error in deg] [--strength sd] [--battery low high]
+//              [--encoder-noise deg] [--set name=value...] [auton...]
+//
+// Every run is one sim process (run_sim.hpp) with the draws passed as sim.*
+// parameters. The draws are made up front from --seed, so the same seed gives
+// the same runs on any number of threads.
+//
+//   auton...         autons to run, numbered like the selector, default all of them
+//   -n               runs per auton, default 2000
+//   --target         where auton n should end, field inches and degrees, - for any
+//                    heading. Without one an auton's target is where the trajectory
+//                    in its registry entry ends. Autons with neither are measured
+//                    against where they end with nothing perturbed, which only says
+//                    how repeatable they are, so the report warns about those.
+//   --tolerance      a run succeeds if it finishes inside 15 s and ends this close
+//                    to the target, default 2 in and 5 deg
+//   --start-error    standard deviation of the start pose error, default 0.5 in and 1 deg
+//   --strength       standard deviation of each drive side's torque scale around 1, default 0.05
+//   --battery        open circuit battery voltage, uniform, default 11.8 to 12.8 V
+//   --encoder-noise  standard deviation on every encoder reading, default 0.5 deg
+//   --set            fixed for every run, robot code or physics, see sim --list-params
+//   --csv            every run's draws and result, one row each
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "run_sim.hpp"
+
+namespace {
+
+struct Target {
+    double x, y;
+    double heading = NAN;  // degrees counter-clockwise, NAN = don't care
+    std::string from;      // where it came from, for the report
+};
+
+struct Options {
+    unsigned threads = 0;
+    int runs = 2000;
+    std::string sim_path;
+    unsigned seed = 1;
+    std::string csv_path;
+    std::map<int, Target> targets;
+    double tolerance_in = 2, tolerance_deg = 5;
+    double start_error_in = 0.5, start_error_deg = 1;
+    double strength_sd = 0.05;
+    double battery_low = 11.8, battery_high = 12.8;
+    double encoder_noise = 0.5;
+    std::vector<std::string> fixed;  // name=value
+    std::vector<int> autons;
+} options;
+
+// One run's draws
+struct Draw {
+    unsigned seed;
+    double start_x, start_y, start_theta;  // in, in, deg
+    double left_strength, right_strength;
+    double battery;
+};
+
+struct Run {
+    int auton;
+    Draw draw;
+    SimResult result;
+    double error_in = INFINITY, error_deg = INFINITY;
+    bool success = false;
+};
+
+[[noreturn]] void fail(const std::string& message) {
+    std::fprintf(stderr, "montecarlo: %s\n", message.c_str());
+    std::exit(1);
+}
+
+std::string format_value(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+std::vector<std::string> sim_args(int auton, const Draw* draw) {
+    std::vector<std::string> args = {options.sim_path, "--auton", std::to_string(auton)};
+    for (const std::string& fixed : options.fixed) {
+        args.push_back("--set");
+        args.push_back(fixed);
+    }
+    if (draw == nullptr) return args;
+
+    auto set = [&](const char* name, double value) {
+        args.push_back("--set");
+        args.push_back(std::string("sim.") + name + "=" + format_value(value));
+    };
+    set("start_error_x", draw->start_x);
+    set("start_error_y", draw->start_y);
+    set("start_error_theta", draw->start_theta);
+    set("left_strength", draw->left_strength);
+    set("right_strength", draw->right_strength);
+    set("battery_voltage", draw->battery);
+    set("encoder_noise", options.encoder_noise);
+    args.push_back("--seed");
+    args.push_back(std::to_string(draw->seed));
+    return args;
+}
+
+double heading_error_deg(double target_deg, double theta) {
+    return std::fabs(std::remainder(target_deg - theta * 180 / M_PI, 360.0));
+}
+
+// Nearest rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return NAN;
+    std::size_t rank = std::size_t(std::ceil(p / 100 * sorted.size()));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void print_distribution(const char* name, std::vector<double> values, const char* format) {
+    std::sort(values.begin(), values.end());
+    std::printf("  %-18s", name);
+    if (values.empty()) {
+        std::printf(" none\n");
+        return;
+    }
+    double mean = 0;
+    for (double v : values) mean += v;
+    mean /= values.size();
+    const char* labels[] = {"mean", "p50", "p90", "p99", "max"};
+    double stats[] = {mean, percentile(values, 50), percentile(values, 90), percentile(values, 99), values.back()};
+    for (int i = 0; i < 5; i++) {
+        std::printf(" %s ", labels[i]);
+        std::printf(format, stats[i]);
+    }
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto usage = [] {
+        fail("usage: montecarlo [-j threads] [-n runs] [--sim path] [--seed n] [--csv file] "
+             "[--target n x y heading|-] [--tolerance in deg] [--start-error in deg] [--strength sd] "
+             "[--battery low high] [--encoder-noise deg] [--set name=value...] [auton...]");
+    };
+    auto number = [&](int& i) {
+        if (i + 1 >= argc) usage();
+        char* end;
+        double value = std::strtod(argv[++i], &end);
+        if (end == argv[i] || *end != '\0') usage();
+        return value;
+    };
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j") {
+            options.threads = number(i);
+        } else if (arg == "-n") {
+            options.runs = number(i);
+        } else if (arg == "--sim" && i + 1 < argc) {
+            options.sim_path = argv[++i];
+        } else if (arg == "--seed") {
+            options.seed = number(i);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csv_path = argv[++i];
+        } else if (arg == "--target") {
+            int auton = number(i);
+            Target target;
+            target.x = number(i);
+            target.y = number(i);
+            if (i + 1 < argc && std::string(argv[i + 1]) == "-") {
+                i++;
+            } else {
+                target.heading = number(i);
+            }
+            target.from = "--target";
+            options.targets[auton] = target;
+        } else if (arg == "--tolerance") {
+            options.tolerance_in = number(i);
+            options.tolerance_deg = number(i);
+        } else if (arg == "--start-error") {
+            options.start_error_in = number(i);
+            options.start_error_deg = number(i);
+        } else if (arg == "--strength") {
+            options.strength_sd = number(i);
+        } else if (arg == "--battery") {
+            options.battery_low = number(i);
+            options.battery_high = number(i);
+        } else if (arg == "--encoder-noise") {
+            options.encoder_noise = number(i);
+        } else if (arg == "--set" && i + 1 < argc) {
+            options.fixed.push_back(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.autons.push_back(std::atoi(arg.c_str()));
+        } else {
+            usage();
+        }
+    }
+    if (options.runs < 1 || options.battery_low > options.battery_high) usage();
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (options.sim_path.empty()) options.sim_path = default_sim_path();
+
+    // The registered autons, and a check that the sim runs at all
+    std::map<int, std::string> labels;
+    std::string listing;
+    if (!run_process({options.sim_path, "--list-autons"}, listing)) fail("can't run " + options.sim_path);
+    std::istringstream lines(listing);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::size_t space = line.find(' ');
+        if (space != std::string::npos) labels[std::atoi(line.c_str())] = line.substr(space + 1);
+    }
+    if (options.autons.empty()) {
+        for (const auto& [auton, label] : labels) options.autons.push_back(auton);
+    }
+    for (int auton : options.autons) {
+        if (!labels.count(auton)) fail("no auton " + std::to_string(auton) + ", see sim --list-autons");
+    }
+
+    // Targets the user didn't give are where the auton's trajectory ends, and
+    // failing that where the unperturbed run ends
+    std::map<int, Target> trajectory_targets;
+    std::string target_listing;
+    if (!run_process({options.sim_path, "--list-targets"}, target_listing)) fail("can't run " + options.sim_path);
+    lines = std::istringstream(target_listing);
+    while (std::getline(lines, line)) {
+        std::istringstream fields(line);
+        int auton;
+        Target target;
+        if (fields >> auton >> target.x >> target.y >> target.heading >> target.from) {
+            target.from = "trajectory " + target.from;
+            trajectory_targets[auton] = target;
+        }
+    }
+    std::vector<int> guessed;
+    for (int auton : options.autons) {
+        if (options.targets.count(auton)) continue;
+        if (trajectory_targets.count(auton)) {
+            options.targets[auton] = trajectory_targets[auton];
+            continue;
+        }
+        SimResult nominal = run_sim(sim_args(auton, nullptr));
+        if (!nominal.ok) fail("auton " + std::to_string(auton) + " doesn't run in the simulator");
+        if (!nominal.finished) std::fprintf(stderr, "montecarlo: auton %d doesn't finish even unperturbed\n", auton);
+        options.targets[auton] = {nominal.x, nominal.y, nominal.theta * 180 / M_PI, "unperturbed run"};
+        guessed.push_back(auton);
+    }
+
+    std::mt19937 rng(options.seed);
+    std::normal_distribution<double> start_in(0, options.start_error_in), start_deg(0, options.start_error_deg);
+    std::normal_distribution<double> strength(1, options.strength_sd);
+    std::uniform_real_distribution<double> battery(options.battery_low, options.battery_high);
+    std::vector<Run> runs;
+    for (int auton : options.autons) {
+        for (int i = 0; i < options.runs; i++) {
+            Draw draw;
+            draw.seed = rng();
+            draw.start_x = start_in(rng);
+            draw.start_y = start_in(rng);
+            draw.start_theta = start_deg(rng);
+            draw.left_strength = std::clamp(strength(rng), 0.3, 1.3);
+            draw.right_strength = std::clamp(strength(rng), 0.3, 1.3);
+            draw.battery = battery(rng);
+            runs.push_back({auton, draw, {}});
+        }
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> done{0};
+    parallel_for(runs.size(), options.threads, [&](std::size_t i) {
+        Run& run = runs[i];
+        run.result = run_sim(sim_args(run.auton, &run.draw));
+        const Target& target = options.targets[run.auton];
+        if (run.result.ok) {
+            run.error_in = std::hypot(run.result.x - target.x, run.result.y - target.y);
+            run.error_deg = std::isnan(target.heading) ? 0 : heading_error_deg(target.heading, run.result.theta);
+            run.success = run.result.finished && run.error_in <= options.tolerance_in &&
+                          run.error_deg <= options.tolerance_deg;
+        }
+        std::size_t count = ++done;
+        if (count % 100 == 0 || count == runs.size()) {
+            std::fprintf(stderr, "\rmontecarlo: %zu/%zu runs", count, runs.size());
+        }
+    });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::fprintf(stderr, "\n");
+
+    std::printf("%zu runs in %.1f s on %u threads (%.0f runs/s), seed %u\n", runs.size(), elapsed, options.threads,
+                runs.size() / elapsed, options.seed);
+    std::printf("start error sd %g in %g deg, strength sd %g, battery %g-%g V, encoder noise %g deg\n",
+                options.start_error_in, options.start_error_deg, options.strength_sd, options.battery_low,
+                options.battery_high, options.encoder_noise);
+    std::printf("success: finished and within %g in, %g deg of the target\n", options.tolerance_in,
+                options.tolerance_deg);
+    if (!guessed.empty()) {
+        std::printf("warning: no --target or trajectory for auton");
+        for (int auton : guessed) std::printf(" %d", auton);
+        std::printf(", its target is where it ends unperturbed, so it's only checked for\n"
+                    "repeatability, not for getting where it should\n");
+    }
+
+    for (int auton : options.autons) {
+        const Target& target = options.targets[auton];
+        std::vector<double> errors_in, errors_deg, times;
+        int successes = 0, unfinished = 0, crashed = 0;
+        const Run* worst = nullptr;
+        for (const Run& run : runs) {
+            if (run.auton != auton) continue;
+            if (!run.result.ok) {
+                crashed++;
+                continue;
+            }
+            errors_in.push_back(run.error_in);
+            if (!std::isnan(target.heading)) errors_deg.push_back(run.error_deg);
+            if (run.result.finished) {
+                times.push_back(run.result.time_ms);
+            } else {
+                unfinished++;
+            }
+            successes += run.success;
+
+            // Worst is an unfinished run if there is one, then the farthest off
+            auto badness = [](const Run& r) { return (r.result.finished ? 0 : 1e9) + r.error_in; };
+            if (worst == nullptr || badness(run) > badness(*worst)) worst = &run;
+        }
+
+        std::printf("\nauton %d %s, target (%.2f, %.2f", auton, labels[auton].c_str(), target.x, target.y);
+        if (!std::isnan(target.heading)) std::printf(", %.1f deg", target.heading);
+        std::printf(") from %s\n  success %.1f%% (%d of %d), %d didn't finish", target.from.c_str(),
+                    100.0 * successes / options.runs, successes, options.runs, unfinished);
+        if (crashed > 0) std::printf(", %d sim failures", crashed);
+        std::printf("\n");
+        print_distribution("endpoint error in", errors_in, "%.2f");
+        if (!errors_deg.empty()) print_distribution("heading error deg", errors_deg, "%.1f");
+        print_distribution("finish time ms", times, "%.0f");
+        if (worst != nullptr) {
+            std::printf("  worst run: %s %.2f in off, replay with\n   ", worst->result.finished ? "finished" : "didn't finish,",
+                        worst->error_in);
+            for (const std::string& arg : sim_args(auton, &worst->draw)) std::printf(" %s", arg.c_str());
+            std::printf("\n");
+        }
+    }
+
+    if (!options.csv_path.empty()) {
+        FILE* csv = std::fopen(options.csv_path.c_str(), "w");
+        if (csv == nullptr) fail("can't write " + options.csv_path);
+        std::fprintf(csv, "auton,seed,start_x,start_y,start_theta,left_strength,right_strength,battery,"
+                          "ok,finished,time_ms,x,y,theta,error_in,error_deg,success\n");
+        for (const Run& run : runs) {
+            const Draw& d = run.draw;
+            const SimResult& r = run.result;
+            std::fprintf(csv, "%d,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f,%d,%d,%.0f,%.3f,%.3f,%.5f,%.3f,%.2f,%d\n", run.auton,
+                         d.seed, d.start_x, d.start_y, d.start_theta, d.left_strength, d.right_strength, d.battery,
+                         r.ok, r.finished, r.time_ms, r.x, r.y, r.theta, run.error_in, run.error_deg, run.success);
+        }
+        std::fclose(csv);
+        std::printf("\nwrote %s\n", options.csv_path.c_str());
+    }
+    return 0;
+}
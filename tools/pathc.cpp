@@ -0,0 +1,287 @@
+// pathc: compiles auton path files into trajectory tables for the brain.
+//
+//   pathc -o trajectories.inc paths/*.path
+//
+// Runs on the build machine as part of `make`. Each path file becomes a
+// TrajectoryTable (see src/trajectory.hpp): the path is splined with the same
+// quintic splines the brain uses (src/path_geometry.hpp), given a
+// velocity profile, sampled once per control tick, quantized and delta encoded.
+//
+// Path file format, one directive per line, # starts a comment:
+//   name <identifier>               defaults to the file name
+//   dt <ms>                         sample period, default 10
+//   limits <max in/s> <max in/s^2>  default 48 80
+//   turn_speed <in/s per 1/in>      max speed in curves is turn_speed / curvature, default 4
+//   point <x> <y> <heading deg>     waypoint, heading counter-clockwise, at least two
+//   control <x> <y>                 cubic Bezier control point, instead of points: 3n + 1
+//                                   of them give n segments (end, handle, handle, end, ...)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "path_geometry.hpp"
+#include "trajectory.hpp"
+
+namespace {
+
+struct PathDef {
+    std::string name;
+    int dt_ms = 10;
+    double max_velocity = 48;
+    double max_acceleration = 80;
+    double turn_speed = 4;
+    std::vector<Waypoint> points;
+    std::vector<Vec2> controls;
+};
+
+// A point along the splined path
+struct Station {
+    double x, y, theta, curvature, s;
+    double v = 0;
+    double t = 0;
+};
+
+[[noreturn]] void fail(const std::string& message) {
+    std::fprintf(stderr, "pathc: %s\n", message.c_str());
+    std::exit(1);
+}
+
+PathDef parse(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) fail("can't open " + filename);
+
+    PathDef def;
+    std::string stem = filename.substr(filename.find_last_of('/') + 1);
+    def.name = stem.substr(0, stem.find('.'));
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string directive;
+        if (!(words >> directive)) continue;
+
+        bool ok = true;
+        if (directive == "name") {
+            ok = static_cast<bool>(words >> def.name);
+        } else if (directive == "dt") {
+            ok = static_cast<bool>(words >> def.dt_ms) && def.dt_ms > 0;
+        } else if (directive == "limits") {
+            ok = static_cast<bool>(words >> def.max_velocity >> def.max_acceleration);
+        } else if (directive == "turn_speed") {
+            ok = static_cast<bool>(words >> def.turn_speed);
+        } else if (directive == "point") {
+            Waypoint w;
+            ok = static_cast<bool>(words >> w.x >> w.y >> w.heading);
+            w.heading *= M_PI / 180;
+            def.points.push_back(w);
+        } else if (directive == "control") {
+            Vec2 c;
+            ok = static_cast<bool>(words >> c.x >> c.y);
+            def.controls.push_back(c);
+        } else {
+            ok = false;
+        }
+        if (!ok) fail(filename + ":" + std::to_string(line_number) + ": can't read '" + line + "'");
+    }
+
+    if (!def.controls.empty()) {
+        if (!def.points.empty()) fail(filename + ": has both points and Bezier control points");
+        if (def.controls.size() < 4 || (def.controls.size() - 1) % 3 != 0) {
+            fail(filename + ": needs 3n + 1 Bezier control points");
+        }
+    } else if (def.points.size() < 2) {
+        fail(filename + ": needs at least two points");
+    }
+    return def;
+}
+
+// Quintic spline through the waypoints, or the Bezier segments (src/path_geometry),
+// sampled finely by distance
+std::vector<Station> spline(const PathDef& def) {
+    SplinePath path;
+    if (!def.controls.empty()) {
+        if (!path.build_bezier(def.controls.data(), def.controls.size())) {
+            fail(def.name + ": too many Bezier segments, at most " + std::to_string(SplinePath::MAX_SEGMENTS));
+        }
+    } else if (!path.build(def.points.data(), def.points.size())) {
+        fail(def.name + ": too many points, at most " + std::to_string(SplinePath::MAX_SEGMENTS + 1));
+    }
+
+    std::vector<CurvePoint> points(static_cast<size_t>(path.length() / 0.25) + 2);
+    points.resize(path.inject_points(0.25, points.data(), points.size()));
+
+    std::vector<Station> stations;
+    for (const CurvePoint& p : points) {
+        Station st;
+        st.x = p.x;
+        st.y = p.y;
+        st.theta = p.heading;
+        st.curvature = p.curvature;
+        st.s = p.s;
+        stations.push_back(st);
+    }
+    return stations;
+}
+
+// Curvature and acceleration limited velocity, then the time at each station
+void time_parameterize(std::vector<Station>& stations, const PathDef& def) {
+    for (Station& st : stations) {
+        st.v = def.max_velocity;
+        if (std::fabs(st.curvature) > 1e-9) st.v = std::min(st.v, def.turn_speed / std::fabs(st.curvature));
+    }
+    stations.front().v = 0;
+    stations.back().v = 0;
+
+    for (size_t i = 1; i < stations.size(); i++) {
+        double ds = stations[i].s - stations[i - 1].s;
+        stations[i].v = std::min(stations[i].v, std::sqrt(stations[i - 1].v * stations[i - 1].v + 2 * def.max_acceleration * ds));
+    }
+    for (size_t i = stations.size() - 1; i-- > 0;) {
+        double ds = stations[i + 1].s - stations[i].s;
+        stations[i].v = std::min(stations[i].v, std::sqrt(stations[i + 1].v * stations[i + 1].v + 2 * def.max_acceleration * ds));
+    }
+
+    stations[0].t = 0;
+    for (size_t i = 1; i < stations.size(); i++) {
+        double ds = stations[i].s - stations[i - 1].s;
+        double v_avg = (stations[i].v + stations[i - 1].v) / 2;
+        stations[i].t = stations[i - 1].t + (v_avg > 1e-9 ? ds / v_avg : 0);
+    }
+}
+
+struct Quantized {
+    std::int32_t x, y, theta, v, omega;
+};
+
+std::int32_t quantize(double value, double scale) {
+    return static_cast<std::int32_t>(std::lround(value * scale));
+}
+
+// One sample per tick, interpolated between stations by time
+std::vector<Quantized> sample(const std::vector<Station>& stations, const PathDef& def) {
+    std::vector<Quantized> samples;
+    double dt = def.dt_ms / 1000.0;
+    double total = stations.back().t;
+    double unwrap = 0;
+    double last_theta = stations.front().theta;
+
+    size_t j = 0;
+    for (int tick = 0;; tick++) {
+        double t = std::min(tick * dt, total);
+        while (j + 2 < stations.size() && stations[j + 1].t < t) j++;
+
+        const Station& a = stations[j];
+        const Station& b = stations[j + 1];
+        double f = b.t > a.t ? std::clamp((t - a.t) / (b.t - a.t), 0.0, 1.0) : 1.0;
+        double theta = a.theta + std::remainder(b.theta - a.theta, 2 * M_PI) * f;
+
+        // Keep theta continuous so its deltas stay small
+        unwrap += std::remainder(theta - last_theta, 2 * M_PI);
+        last_theta = theta;
+
+        double v = a.v + (b.v - a.v) * f;
+        double curvature = a.curvature + (b.curvature - a.curvature) * f;
+        samples.push_back({quantize(a.x + (b.x - a.x) * f, TRAJ_POSITION_SCALE),
+                           quantize(a.y + (b.y - a.y) * f, TRAJ_POSITION_SCALE),
+                           quantize(stations.front().theta + unwrap, TRAJ_THETA_SCALE),
+                           quantize(v, TRAJ_VELOCITY_SCALE), quantize(v * curvature, TRAJ_OMEGA_SCALE)});
+
+        if (t >= total) break;
+    }
+    return samples;
+}
+
+template <typename T>
+T clamp_delta(std::int32_t target, std::int32_t& decoded) {
+    std::int32_t delta = std::clamp<std::int32_t>(target - decoded, std::numeric_limits<T>::min(),
+                                                  std::numeric_limits<T>::max());
+    decoded += delta;
+    return static_cast<T>(delta);
+}
+
+void emit(std::FILE* out, const PathDef& def, const std::vector<Quantized>& samples, int& clamped) {
+    if (samples.size() > 65535) fail(def.name + ": too long");
+
+    // Deltas are taken from what the decoder will have, so a clamped delta is
+    // caught up on the following ticks instead of drifting
+    Quantized decoded = samples.front();
+    std::fprintf(out, "static const TrajectoryDelta %s_deltas[] = {\n", def.name.c_str());
+    for (size_t i = 1; i < samples.size(); i++) {
+        const Quantized& q = samples[i];
+        Quantized before = decoded;
+        int dx = clamp_delta<std::int8_t>(q.x, decoded.x);
+        int dy = clamp_delta<std::int8_t>(q.y, decoded.y);
+        int dtheta = clamp_delta<std::int16_t>(q.theta, decoded.theta);
+        int dv = clamp_delta<std::int8_t>(q.v, decoded.v);
+        int domega = clamp_delta<std::int8_t>(q.omega, decoded.omega);
+        if (before.x + dx != q.x || before.y + dy != q.y || before.theta + dtheta != q.theta ||
+            before.v + dv != q.v || before.omega + domega != q.omega) {
+            clamped++;
+        }
+        std::fprintf(out, "    {%d, %d, %d, %d, %d},\n", dx, dy, dtheta, dv, domega);
+    }
+    if (samples.size() == 1) std::fprintf(out, "    {0, 0, 0, 0, 0},\n");
+    std::fprintf(out, "};\n\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (output.empty()) fail("usage: pathc -o <output.inc> <path files...>");
+
+    std::vector<PathDef> defs;
+    for (const std::string& input : inputs) {
+        defs.push_back(parse(input));
+    }
+
+    std::FILE* out = std::fopen(output.c_str(), "w");
+    if (out == nullptr) fail("can't write " + output);
+    std::fprintf(out, "// Generated by tools/pathc from paths/*.path, don't edit\n\n");
+
+    std::vector<std::vector<Quantized>> all_samples;
+    for (const PathDef& def : defs) {
+        std::vector<Station> stations = spline(def);
+        time_parameterize(stations, def);
+        std::vector<Quantized> samples = sample(stations, def);
+
+        int clamped = 0;
+        emit(out, def, samples, clamped);
+        std::printf("pathc: %s: %.1f in, %.2f s, %zu samples, %zu bytes\n", def.name.c_str(), stations.back().s,
+                    stations.back().t, samples.size(), (samples.size() - 1) * sizeof(TrajectoryDelta));
+        if (clamped) {
+            std::printf("pathc: %s: %d samples changed too fast to encode in one tick, they catch up over the next ones\n",
+                        def.name.c_str(), clamped);
+        }
+        all_samples.push_back(std::move(samples));
+    }
+
+    std::fprintf(out, "const TrajectoryTable trajectory_tables[] = {\n");
+    for (size_t i = 0; i < defs.size(); i++) {
+        const Quantized& first = all_samples[i].front();
+        std::fprintf(out, "    {\"%s\", %d, %zu, %d, %d, %d, %d, %d, %s_deltas},\n", defs[i].name.c_str(), defs[i].dt_ms,
+                     all_samples[i].size(), first.x, first.y, first.theta, first.v, first.omega, defs[i].name.c_str());
+    }
+    std::fprintf(out, "    {nullptr, 0, 0, 0, 0, 0, 0, 0, nullptr},\n};\n");
+    std::fclose(out);
+    return 0;
+}
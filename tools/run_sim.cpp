@@ -0,0 +1,100 @@
+#include "run_sim.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+bool run_process(const std::vector<std::string>& args, std::string& output) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return false;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, pipe_fds[0]);
+    posix_spawn_file_actions_addclose(&actions, pipe_fds[1]);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::vector<char*> argv;
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int spawned = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(pipe_fds[1]);
+    if (spawned != 0) {
+        close(pipe_fds[0]);
+        return false;
+    }
+
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) output.append(buffer, n);
+    close(pipe_fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0 || WEXITSTATUS(status) == 2);
+}
+
+SimResult run_sim(std::vector<std::string> args) {
+    SimResult result;
+    args.push_back("--result");
+    std::string output;
+    if (!run_process(args, output)) return result;
+
+    std::size_t start = output.rfind("\nresult ");
+    if (start == std::string::npos) return result;
+    start += 8;
+    std::istringstream fields(output.substr(start, output.find('\n', start) - start));
+    std::map<std::string, double> values;
+    std::string field;
+    while (fields >> field) {
+        std::size_t equals = field.find('=');
+        if (equals != std::string::npos) values[field.substr(0, equals)] = std::atof(field.c_str() + equals + 1);
+    }
+    if (!values.count("finished") || !values.count("time_ms") || !values.count("x")) return result;
+
+    result.ok = true;
+    result.finished = values["finished"] != 0;
+    result.time_ms = values["time_ms"];
+    result.x = values["x"];
+    result.y = values["y"];
+    result.theta = values["theta"];
+    result.odom_x = values["odom_x"];
+    result.odom_y = values["odom_y"];
+    result.odom_theta = values["odom_theta"];
+    result.max_slip = values["max_slip"];
+    result.min_battery = values["min_battery"];
+    return result;
+}
+
+std::string default_sim_path() {
+    char self[4096];
+    ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (n <= 0) return "bin/host/sim";
+    std::string path(self, n);
+    return path.substr(0, path.rfind('/') + 1) + "sim";
+}
+
+void parallel_for(std::size_t count, unsigned threads, const std::function<void(std::size_t)>& job) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        std::size_t i;
+        while ((i = next.fetch_add(1)) < count) job(i);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::min<std::size_t>(threads, count); t++) workers.emplace_back(worker);
+    for (std::thread& t : workers) t.join();
+}
@@ -0,0 +1,38 @@
+#ifndef RUN_SIM_HPP
+#define RUN_SIM_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Running bin/host/sim from the host tools that drive it (tune.cpp, montecarlo.cpp).
+//
+// The simulator keeps the whole robot program in process globals, so every
+// run is its own sim process. Workers share nothing but the job counter.
+
+// What sim --result prints, field inches and radians
+struct SimResult {
+    bool ok = false;  // the sim ran and printed a result line
+    bool finished = false;  // the auton returned inside 15 s
+    double time_ms = 0;
+    double x = 0, y = 0, theta = 0;  // true pose at auton end
+    double odom_x = 0, odom_y = 0, odom_theta = 0;
+    double max_slip = 0;  // in/s
+    double min_battery = 0;  // V
+};
+
+// Runs a program (argv[0] is its path) with stdout captured and stderr dropped.
+// False if it couldn't start or exited other than 0 or 2 (an auton that didn't finish).
+bool run_process(const std::vector<std::string>& args, std::string& output);
+
+// Runs the simulator with --result added, args[0] is its path
+SimResult run_sim(std::vector<std::string> args);
+
+// The sim binary next to the running tool's own
+std::string default_sim_path();
+
+// Calls job(0..count-1) across threads, each index exactly once
+void parallel_for(std::size_t count, unsigned threads, const std::function<void(std::size_t)>& job);
+
+#endif
@@ -0,0 +1,318 @@
+#include "sim_kernel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr std::uint64_t NEVER = ~0ull;
+
+enum TaskState { READY, BLOCKED, FINISHED, DELETED };
+
+}  // namespace
+
+struct Task {
+    std::string name;
+    std::uint32_t priority;
+    void (*fn)(void*);
+    void* arg;
+
+    TaskState state = READY;
+    std::uint64_t ready_order = 0;  // first come first served within a priority
+    std::uint64_t wake_us = NEVER;  // while BLOCKED
+
+    std::uint32_t notify_value = 0;
+    bool waiting_for_notify = false;
+    Mutex* waiting_for_mutex = nullptr;
+
+    std::condition_variable cv;
+};
+
+struct Mutex {
+    Task* owner = nullptr;
+    std::deque<Task*> waiters;
+};
+
+namespace {
+
+std::mutex kernel;
+std::vector<std::unique_ptr<Task>> tasks;
+std::vector<std::unique_ptr<Mutex>> mutexes;
+Task* running = nullptr;  // nullptr while the main thread has control
+std::condition_variable main_cv;
+std::uint64_t run_limit_us = 0;
+std::uint64_t ready_counter = 0;
+
+std::atomic<std::uint64_t> clock_us{0};
+std::function<void(std::uint64_t)> tick_hook;
+
+void make_ready(Task* task) {
+    task->state = READY;
+    task->wake_us = NEVER;
+    task->ready_order = ready_counter++;
+}
+
+Task* highest_ready() {
+    Task* best = nullptr;
+    for (auto& task : tasks) {
+        Task* t = task.get();
+        if (t->state != READY) continue;
+        if (best == nullptr || t->priority > best->priority ||
+            (t->priority == best->priority && t->ready_order < best->ready_order)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+// Wakes the tasks whose timeouts have come up
+void wake_due(std::uint64_t now) {
+    for (auto& task : tasks) {
+        Task* t = task.get();
+        if (t->state != BLOCKED || t->wake_us > now) continue;
+        if (t->waiting_for_mutex != nullptr) {
+            auto& waiters = t->waiting_for_mutex->waiters;
+            for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+                if (*it == t) {
+                    waiters.erase(it);
+                    break;
+                }
+            }
+        }
+        make_ready(t);
+    }
+}
+
+// Hands the CPU to the next task, advancing the clock while nothing is ready.
+// Gives it back to the main thread once the run limit is reached.
+void dispatch() {
+    while (true) {
+        Task* next = highest_ready();
+        if (next != nullptr) {
+            running = next;
+            next->cv.notify_one();
+            return;
+        }
+
+        std::uint64_t next_wake = NEVER;
+        for (auto& task : tasks) {
+            if (task->state == BLOCKED && task->wake_us < next_wake) next_wake = task->wake_us;
+        }
+        std::uint64_t target = next_wake < run_limit_us ? next_wake : run_limit_us;
+
+        std::uint64_t now = clock_us.load(std::memory_order_relaxed);
+        while (now < target) {
+            now += 1000;
+            clock_us.store(now, std::memory_order_relaxed);
+            if (tick_hook) tick_hook(now);
+        }
+        if (now >= run_limit_us && next_wake > now) {
+            running = nullptr;
+            main_cv.notify_one();
+            return;
+        }
+        wake_due(now);
+    }
+}
+
+// The running task gives up the CPU and waits until it's picked again
+void switch_away(std::unique_lock<std::mutex>& lock, Task* self) {
+    dispatch();
+    self->cv.wait(lock, [self] { return running == self; });
+}
+
+Task* self_or_die(const char* what) {
+    if (running == nullptr) {
+        std::fprintf(stderr, "sim: %s called outside a task\n", what);
+        std::abort();
+    }
+    return running;
+}
+
+void block(std::unique_lock<std::mutex>& lock, Task* self, std::uint32_t timeout_ms) {
+    self->state = BLOCKED;
+    self->wake_us = timeout_ms == WAIT_FOREVER ? NEVER : clock_us.load(std::memory_order_relaxed) + timeout_ms * 1000ull;
+    switch_away(lock, self);
+}
+
+// After waking a task, let it run straight away if it outranks us, like FreeRTOS would
+void maybe_preempt(std::unique_lock<std::mutex>& lock, Task* woken) {
+    Task* self = running;
+    if (self == nullptr || woken->priority <= self->priority) return;
+    make_ready(self);
+    switch_away(lock, self);
+}
+
+void task_entry(Task* self) {
+    {
+        std::unique_lock<std::mutex> lock(kernel);
+        self->cv.wait(lock, [self] { return running == self; });
+    }
+    self->fn(self->arg);
+
+    std::unique_lock<std::mutex> lock(kernel);
+    self->state = FINISHED;
+    dispatch();
+}
+
+}  // namespace
+
+std::uint64_t now_us() {
+    return clock_us.load(std::memory_order_relaxed);
+}
+
+void set_tick_hook(std::function<void(std::uint64_t)> hook) {
+    std::lock_guard<std::mutex> lock(kernel);
+    tick_hook = std::move(hook);
+}
+
+Task* create_task(void (*fn)(void*), void* arg, std::uint32_t priority, const char* name) {
+    std::unique_lock<std::mutex> lock(kernel);
+    auto task = std::make_unique<Task>();
+    task->name = name != nullptr ? name : "";
+    task->priority = priority;
+    task->fn = fn;
+    task->arg = arg;
+    make_ready(task.get());
+    Task* t = task.get();
+    tasks.push_back(std::move(task));
+
+    std::thread(task_entry, t).detach();
+    maybe_preempt(lock, t);
+    return t;
+}
+
+void delete_task(Task* task) {
+    std::unique_lock<std::mutex> lock(kernel);
+    if (task == nullptr) task = self_or_die("task_delete");
+    if (task->state == FINISHED) return;
+    task->state = DELETED;
+    if (task->waiting_for_mutex != nullptr) {
+        auto& waiters = task->waiting_for_mutex->waiters;
+        for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+            if (*it == task) {
+                waiters.erase(it);
+                break;
+            }
+        }
+    }
+    // Parks forever, nothing makes a deleted task ready again
+    if (task == running) switch_away(lock, task);
+}
+
+Task* current_task() {
+    std::lock_guard<std::mutex> lock(kernel);
+    return running;
+}
+
+const char* task_name(Task* task) {
+    return task->name.c_str();
+}
+
+void delay_ms(std::uint32_t ms) {
+    std::unique_lock<std::mutex> lock(kernel);
+    Task* self = self_or_die("delay");
+    if (ms == 0) {
+        make_ready(self);
+        switch_away(lock, self);
+        return;
+    }
+    block(lock, self, ms);
+}
+
+void delay_until_ms(std::uint32_t* prev_ms, std::uint32_t delta_ms) {
+    std::unique_lock<std::mutex> lock(kernel);
+    Task* self = self_or_die("delay_until");
+    std::uint32_t wake = *prev_ms + delta_ms;
+    *prev_ms = wake;
+    std::uint32_t now = clock_us.load(std::memory_order_relaxed) / 1000;
+    // Already late, FreeRTOS returns without blocking
+    if (static_cast<std::int32_t>(wake - now) <= 0) return;
+    block(lock, self, wake - now);
+}
+
+std::uint32_t notify(Task* task) {
+    std::unique_lock<std::mutex> lock(kernel);
+    if (task == nullptr || task->state == DELETED || task->state == FINISHED) return 0;
+    task->notify_value++;
+    if (task->state == BLOCKED && task->waiting_for_notify) {
+        make_ready(task);
+        maybe_preempt(lock, task);
+    }
+    return 1;
+}
+
+std::uint32_t notify_take(bool clear_on_exit, std::uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(kernel);
+    Task* self = self_or_die("task_notify_take");
+    if (self->notify_value == 0 && timeout_ms > 0) {
+        self->waiting_for_notify = true;
+        block(lock, self, timeout_ms);
+        self->waiting_for_notify = false;
+    }
+    std::uint32_t value = self->notify_value;
+    if (value > 0) self->notify_value = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+Mutex* create_mutex() {
+    std::lock_guard<std::mutex> lock(kernel);
+    mutexes.push_back(std::make_unique<Mutex>());
+    return mutexes.back().get();
+}
+
+bool take_mutex(Mutex* mutex, std::uint32_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(kernel);
+    Task* self = running;
+    if (mutex->owner == nullptr) {
+        // The main thread only ever takes one between runs, when no task can hold it
+        mutex->owner = self;
+        return true;
+    }
+    if (self == nullptr || timeout_ms == 0) return false;
+
+    mutex->waiters.push_back(self);
+    self->waiting_for_mutex = mutex;
+    block(lock, self, timeout_ms);
+    self->waiting_for_mutex = nullptr;
+    return mutex->owner == self;
+}
+
+bool give_mutex(Mutex* mutex) {
+    std::unique_lock<std::mutex> lock(kernel);
+    if (mutex->owner != running) return false;
+    if (mutex->waiters.empty()) {
+        mutex->owner = nullptr;
+        return true;
+    }
+    Task* next = mutex->waiters.front();
+    mutex->waiters.pop_front();
+    mutex->owner = next;
+    make_ready(next);
+    maybe_preempt(lock, next);
+    return true;
+}
+
+void run_until_us(std::uint64_t time_us) {
+    std::unique_lock<std::mutex> lock(kernel);
+    run_limit_us = time_us;
+    dispatch();
+    main_cv.wait(lock, [] { return running == nullptr; });
+}
+
+bool task_finished(Task* task) {
+    std::lock_guard<std::mutex> lock(kernel);
+    return task->state == FINISHED;
+}
+
+}  // namespace sim
@@ -0,0 +1,63 @@
+#ifndef SIM_KERNEL_HPP
+#define SIM_KERNEL_HPP
+
+#include <cstdint>
+#include <functional>
+
+// Virtual clock task scheduler for the simulator, standing in for FreeRTOS.
+//
+// Every PROS task is a host thread, but only one of them runs at a time, like
+// on the brain's single core: a task runs until it blocks (delay, notify_take,
+// a taken mutex), then the highest priority ready task runs. Code takes no
+// virtual time. When nothing is ready the clock jumps to the next wake time, in
+// 1 ms steps, calling the tick hook (the physics) on each one. So a run is
+// deterministic and goes as fast as the host can run the robot code.
+//
+// There's no time slicing, a task that spins without ever blocking hangs the
+// simulation. The robot code never does, everything waits with pros::delay or
+// a notification.
+
+namespace sim {
+
+struct Task;
+
+constexpr std::uint32_t WAIT_FOREVER = 0xffffffff;  // TIMEOUT_MAX
+
+// Virtual time since the simulation started
+std::uint64_t now_us();
+inline std::uint32_t now_ms() {
+    return now_us() / 1000;
+}
+
+// Called with the new time every virtual millisecond, with no task running
+void set_tick_hook(std::function<void(std::uint64_t now_us)> hook);
+
+// --- From the tasks (the PROS API layer) ---
+
+Task* create_task(void (*fn)(void*), void* arg, std::uint32_t priority, const char* name);
+// A deleted task never runs again. Like vTaskDelete its stack isn't unwound,
+// its thread just stays parked until the process exits.
+void delete_task(Task* task);
+Task* current_task();
+const char* task_name(Task* task);
+
+void delay_ms(std::uint32_t ms);
+void delay_until_ms(std::uint32_t* prev_ms, std::uint32_t delta_ms);
+
+std::uint32_t notify(Task* task);
+std::uint32_t notify_take(bool clear_on_exit, std::uint32_t timeout_ms);
+
+struct Mutex;
+Mutex* create_mutex();
+bool take_mutex(Mutex* mutex, std::uint32_t timeout_ms);
+bool give_mutex(Mutex* mutex);
+
+// --- From the simulator's main thread ---
+
+// Runs the tasks until the clock reaches the given time
+void run_until_us(std::uint64_t time_us);
+bool task_finished(Task* task);  // returned from its function
+
+}  // namespace sim
+
+#endif
@@ -0,0 +1,334 @@
+// sim: runs the robot code on Linux against a simulated robot.
+//
+//   sim [--auton n] [--driver script] [--driver-ms ms] [--usd dir] [--trace file.csv] [--seed n]
+//       [--set name=value...] [--list-params] [--list-autons] [--list-targets] [--result]
+//
+// src/ is compiled unchanged and linked against sim_pros.cpp in place of
+// libpros, so initialize(), autonomous() and opcontrol() are the ones that go
+// on the brain. They run on a virtual clock (sim_kernel.cpp) with the physics
+// (sim_world.cpp) stepped every millisecond, as fast as the host can go.
+//
+// The match goes like on the field: initialize, disabled with
+// competition_initialize, 15 s of autonomous, disabled, then driver control if
+// there's a driver script, and disabled at the end so the telemetry log is
+// flushed.
+//
+//   --auton      auton to run, numbered like the selector (src/autons.hpp), default 1
+//   --driver     controller script for driver control, one change per line:
+//                <ms since driver control started> <channel> <value>
+//                channels LEFT_X LEFT_Y RIGHT_X RIGHT_Y (-127..127),
+//                L1 L2 R1 R2 UP DOWN LEFT RIGHT X B Y A (0 or 1), # starts a comment
+//   --driver-ms  length of driver control, default 1 s past the script's last line
+//   --usd        directory that stands in for the SD card, telemetry logs go there
+//   --trace      CSV of the true and estimated pose every 10 ms
+//   --seed       IMU and encoder noise seed
+//   --set        changes a parameter before the run, robot code (drive_gains.kp=900) or
+//                physics (sim.mass=7.5), can be repeated
+//   --list-params  prints every parameter --set takes with its value, and exits
+//   --list-autons  prints the auton numbers and names, and exits
+//   --list-targets  prints <n> <x> <y> <heading deg> <trajectory> for each auton
+//                whose registry entry has a trajectory, where it ends, and exits
+//   --result     ends with one machine readable line for tools/tune.cpp and tools/montecarlo.cpp:
+//                result auton=<n> finished=<0|1> time_ms=<auton ms> x= y= theta= (true pose
+//                at auton end, in and rad) odom_x= odom_y= odom_theta= max_slip= min_battery=
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "main.h"
+#include "auton_select.hpp"
+#include "autons.hpp"
+#include "globals.hpp"
+#include "odometry.hpp"
+#include "sim_kernel.hpp"
+#include "sim_params.hpp"
+#include "sim_pros.hpp"
+#include "sim_world.hpp"
+#include "trajectory.hpp"
+
+using sim::world;
+
+namespace {
+
+constexpr double INCH = 0.0254;
+constexpr std::uint32_t PRE_AUTON_MS = 3000;  // on the field waiting to start, the IMU calibrates
+constexpr std::uint32_t AUTON_MS = 15000;
+constexpr std::uint32_t DISABLED_MS = 1000;
+
+struct ScriptLine {
+    std::uint32_t time_ms;
+    int channel;  // 0-3 analog, 4+ button bit + 4
+    int value;
+};
+
+struct Options {
+    int auton = 1;
+    std::string driver_path;
+    std::uint32_t driver_ms = 0;
+    std::string usd_dir;
+    std::string trace_path;
+    unsigned seed = 1;
+    bool result = false;
+} options;
+
+std::vector<ScriptLine> script;
+std::size_t script_next = 0;
+std::uint32_t driver_start_ms = 0;
+bool driver_running = false;
+FILE* trace = nullptr;
+
+[[noreturn]] void fail(const std::string& message) {
+    std::fprintf(stderr, "sim: %s\n", message.c_str());
+    std::exit(1);
+}
+
+int channel_index(const std::string& name) {
+    static const char* const channels[] = {"LEFT_X", "LEFT_Y", "RIGHT_X", "RIGHT_Y", "L1", "L2", "R1", "R2",
+                                           "UP",     "DOWN",   "LEFT",    "RIGHT",   "X",  "B",  "Y",  "A"};
+    for (int i = 0; i < 16; i++) {
+        if (name == channels[i]) return i;
+    }
+    return -1;
+}
+
+void load_script(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) fail("can't open " + path);
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::uint32_t time_ms;
+        std::string channel;
+        int value;
+        if (!(fields >> time_ms)) continue;
+        if (!(fields >> channel >> value) || channel_index(channel) < 0) {
+            fail(path + ":" + std::to_string(line_number) + ": expected <ms> <channel> <value>");
+        }
+        script.push_back({time_ms, channel_index(channel), value});
+    }
+    std::stable_sort(script.begin(), script.end(),
+                     [](const ScriptLine& a, const ScriptLine& b) { return a.time_ms < b.time_ms; });
+}
+
+void apply_script(std::uint32_t now_ms) {
+    if (!driver_running) return;
+    sim::SimController& pad = world().controllers[0];
+    while (script_next < script.size() && script[script_next].time_ms <= now_ms - driver_start_ms) {
+        const ScriptLine& line = script[script_next++];
+        if (line.channel < 4) {
+            pad.analog[line.channel] = std::clamp(line.value, -127, 127);
+        } else if (line.value) {
+            pad.buttons |= 1u << (line.channel - 4);
+        } else {
+            pad.buttons &= ~(1u << (line.channel - 4));
+        }
+    }
+}
+
+void write_trace(std::uint32_t now_ms) {
+    if (trace == nullptr || now_ms % 10 != 0) return;
+    const sim::World& w = world();
+    Pose odom = robot_pose.read();
+    std::fprintf(trace, "%u,%d,%.3f,%.3f,%.4f,%.3f,%.3f,%.4f,%.2f,%.2f,%.3f,%.3f,%.2f\n", now_ms, w.enabled,
+                 w.x / INCH, w.y / INCH, w.theta, odom.x, odom.y, odom.theta, w.velocity / INCH,
+                 w.angular_velocity, w.slip[0], w.slip[1], w.battery);
+}
+
+void tick(std::uint64_t now_us) {
+    std::uint32_t now_ms = now_us / 1000;
+    apply_script(now_ms);
+    world().step();
+    write_trace(now_ms);
+}
+
+// The robot's devices, as the robot code declares them
+void build_robot() {
+    sim::World& w = world();
+    for (std::int8_t port : left_mg.ports()) w.attach_motor(port, sim::ROLE_DRIVE_LEFT);
+    for (std::int8_t port : right_mg.ports()) w.attach_motor(port, sim::ROLE_DRIVE_RIGHT);
+    w.attach_motor(intake_motor.get_port(), sim::ROLE_INTAKE);
+    w.attach_motor(lift_motor.get_port(), sim::ROLE_LIFT);
+    w.imus[imu.get_port()].installed = true;
+    w.params.wheel_radius = drive_wheel_diameter / 2 * INCH;
+    w.params.track_width = drive_track_width * INCH;
+
+    auto tracker = [&](pros::Rotation& sensor, double offset, bool perpendicular) {
+        sim::SimRotation& r = w.rotations[sensor.get_port()];
+        r.installed = true;
+        r.perpendicular = perpendicular;
+        if (perpendicular) {
+            r.forward_offset = offset * INCH;
+        } else {
+            r.lateral_offset = offset * INCH;
+        }
+        r.wheel_diameter = tracking_config.wheel_diameter * INCH;
+    };
+    tracker(left_tracker, tracking_config.left_offset, false);
+    if (tracking_config.has_right) tracker(right_tracker, tracking_config.right_offset, false);
+    if (tracking_config.has_perp) tracker(perp_tracker, tracking_config.perp_offset, true);
+}
+
+// Competition modes run as tasks like the PROS runtime starts them
+void run_mode(void* mode) {
+    reinterpret_cast<void (*)()>(mode)();
+}
+
+sim::Task* start_mode(void (*mode)(), const char* name) {
+    return sim::create_task(run_mode, reinterpret_cast<void*>(mode), TASK_PRIORITY_DEFAULT, name);
+}
+
+// Runs a mode for up to duration_ms, or until it returns if stop_early.
+// Returns how long it ran.
+std::uint32_t run_mode_for(void (*mode)(), const char* name, std::uint32_t duration_ms, bool stop_early) {
+    std::uint32_t start = sim::now_ms();
+    sim::Task* task = start_mode(mode, name);
+    while (sim::now_ms() - start < duration_ms) {
+        sim::run_until_us((sim::now_ms() + 10) * 1000ull);
+        if (stop_early && sim::task_finished(task)) break;
+    }
+    std::uint32_t ran = sim::now_ms() - start;
+    if (!sim::task_finished(task)) sim::delete_task(task);
+    return ran;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--auton" && i + 1 < argc) {
+            options.auton = std::atoi(argv[++i]);
+        } else if (arg == "--driver" && i + 1 < argc) {
+            options.driver_path = argv[++i];
+        } else if (arg == "--driver-ms" && i + 1 < argc) {
+            options.driver_ms = std::atoi(argv[++i]);
+        } else if (arg == "--usd" && i + 1 < argc) {
+            options.usd_dir = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            options.trace_path = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::atoi(argv[++i]);
+        } else if (arg == "--set" && i + 1 < argc) {
+            if (!sim::set_param(argv[++i])) fail(std::string("can't set ") + argv[i] + ", see --list-params");
+        } else if (arg == "--list-params") {
+            for (const sim::Param& param : sim::params()) std::printf("%s %.9g\n", param.name, *param.value);
+            return 0;
+        } else if (arg == "--list-autons") {
+            for (int auton = 1; auton <= AUTON_COUNT; auton++) std::printf("%d %s\n", auton, auton_entry(auton)->label);
+            return 0;
+        } else if (arg == "--list-targets") {
+            for (int auton = 1; auton <= AUTON_COUNT; auton++) {
+                const char* name = auton_entry(auton)->trajectory;
+                const TrajectoryTable* table = name ? find_trajectory(name) : nullptr;
+                if (table == nullptr) continue;
+                TrajectoryStream stream;
+                TrajectorySample end;
+                stream.reset(*table);
+                stream.seek(stream.duration(), end);
+                std::printf("%d %.3f %.3f %.2f %s\n", auton, end.x, end.y, end.theta * 180 / M_PI, name);
+            }
+            return 0;
+        } else if (arg == "--result") {
+            options.result = true;
+        } else {
+            fail("usage: sim [--auton n] [--driver script] [--driver-ms ms] [--usd dir] [--trace file.csv] [--seed n] "
+                 "[--set name=value...] [--list-params] [--list-autons] [--list-targets] [--result]");
+        }
+    }
+    const AutonEntry* entry = auton_entry(options.auton);
+    if (entry == nullptr) fail("no auton " + std::to_string(options.auton) + ", there are " + std::to_string(AUTON_COUNT));
+    if (!options.driver_path.empty()) {
+        load_script(options.driver_path);
+        if (options.driver_ms == 0) options.driver_ms = (script.empty() ? 0 : script.back().time_ms) + 1000;
+    }
+    if (!options.usd_dir.empty()) sim::set_usd_dir(options.usd_dir.c_str());
+    if (!options.trace_path.empty()) {
+        trace = std::fopen(options.trace_path.c_str(), "w");
+        if (trace == nullptr) fail("can't write " + options.trace_path);
+        std::fprintf(trace, "time_ms,enabled,x,y,theta,odom_x,odom_y,odom_theta,velocity,angular_velocity,"
+                            "left_slip,right_slip,battery\n");
+    }
+
+    selected_auton = options.auton;
+    build_robot();
+    world().place(entry->start.x, entry->start.y, entry->start.theta);
+    world().rng.seed(options.seed);
+    sim::set_tick_hook(tick);
+
+    auto host_start = std::chrono::steady_clock::now();
+
+    // initialize() has to return before anything else runs
+    sim::Task* init = start_mode(initialize, "initialize");
+    while (!sim::task_finished(init)) sim::run_until_us((sim::now_ms() + 10) * 1000ull);
+
+    run_mode_for(competition_initialize, "competition_initialize", PRE_AUTON_MS, false);
+
+    world().enabled = true;
+    std::uint32_t auton_start = sim::now_ms();
+    std::uint32_t auton_ms = run_mode_for(autonomous, "autonomous", AUTON_MS, true);
+    bool auton_finished = auton_ms < AUTON_MS;
+    world().enabled = false;
+    Pose auton_odom = robot_pose.read();
+    double auton_x = world().x / INCH, auton_y = world().y / INCH, auton_theta = world().theta;
+
+    if (options.driver_ms > 0) {
+        run_mode_for(disabled, "disabled", DISABLED_MS, false);
+        world().enabled = true;
+        driver_start_ms = sim::now_ms();
+        driver_running = true;
+        run_mode_for(opcontrol, "opcontrol", options.driver_ms, false);
+        driver_running = false;
+        world().enabled = false;
+    }
+    run_mode_for(disabled, "disabled", DISABLED_MS, false);
+
+    double host_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - host_start).count();
+    double virtual_s = sim::now_us() / 1e6;
+    const sim::World& w = world();
+
+    std::printf("\n%s: ", entry->label);
+    if (auton_finished) {
+        std::printf("finished in %u ms\n", auton_ms);
+    } else {
+        std::printf("still running at %u ms\n", AUTON_MS);
+    }
+    std::printf("  at auton end  true (%.2f, %.2f, %.1f deg)  odometry (%.2f, %.2f, %.1f deg)  error %.2f in\n",
+                auton_x, auton_y, auton_theta * 180 / M_PI, auton_odom.x, auton_odom.y,
+                auton_odom.theta * 180 / M_PI, std::hypot(auton_odom.x - auton_x, auton_odom.y - auton_y));
+    if (options.driver_ms > 0) {
+        Pose odom = robot_pose.read();
+        std::printf("  at the end    true (%.2f, %.2f, %.1f deg)  odometry (%.2f, %.2f, %.1f deg)\n", w.x / INCH,
+                    w.y / INCH, w.theta * 180 / M_PI, odom.x, odom.y, odom.theta * 180 / M_PI);
+    }
+    std::printf("  max wheel slip %.2f in/s, battery down to %.2f V (%.0f mAh used)\n", w.max_slip / INCH,
+                w.min_battery, w.charge_used / 3.6);
+    std::printf("  motor temperatures:");
+    for (int port = 1; port <= sim::PORT_COUNT; port++) {
+        if (w.motors[port].installed) std::printf(" %d:%.0fC", port, w.motors[port].temperature);
+    }
+    std::printf("\n  %.1f s simulated in %.2f s (%.0fx real time), auton started at %u ms\n", virtual_s, host_s,
+                virtual_s / host_s, auton_start);
+
+    if (options.result) {
+        std::printf("result auton=%d finished=%d time_ms=%u x=%.3f y=%.3f theta=%.5f odom_x=%.3f odom_y=%.3f "
+                    "odom_theta=%.5f max_slip=%.3f min_battery=%.3f\n",
+                    options.auton, auton_finished, auton_ms, auton_x, auton_y, auton_theta, auton_odom.x,
+                    auton_odom.y, auton_odom.theta, w.max_slip / INCH, w.min_battery);
+    }
+
+    // Deleted tasks are still parked on their threads, don't wait for them
+    if (trace != nullptr) std::fclose(trace);
+    std::fflush(nullptr);
+    std::_Exit(auton_finished ? 0 : 2);
+}
@@ -0,0 +1,107 @@
+#include "sim_params.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+#include "motion.hpp"
+#include "motion_profile.hpp"
+#include "pure_pursuit.hpp"
+#include "ramsete.hpp"
+#include "sim_world.hpp"
+
+namespace sim {
+
+#define ROBOT(expr) {#expr, &(expr), true}
+#define PHYSICS(name, expr) {"sim." name, &(expr), false}
+
+const std::vector<Param>& params() {
+    static const std::vector<Param> all = [] {
+        World& w = world();
+        // Every tunable global, whether an auton reaches it today or not. tune
+        // warns about any a spec lists that its autons don't reach.
+        return std::vector<Param>{
+            ROBOT(drive_gains.kp),
+            ROBOT(drive_gains.ki),
+            ROBOT(drive_gains.kd),
+            ROBOT(drive_gains.integral_range),
+            ROBOT(heading_gains.kp),
+            ROBOT(heading_gains.ki),
+            ROBOT(heading_gains.kd),
+            ROBOT(turn_gains.kp),
+            ROBOT(turn_gains.ki),
+            ROBOT(turn_gains.kd),
+            ROBOT(turn_gains.integral_range),
+            ROBOT(profile_gains.kp),
+            ROBOT(profile_gains.ki),
+            ROBOT(profile_gains.kd),
+            ROBOT(drive_feedforward.kS),
+            ROBOT(drive_feedforward.kV),
+            ROBOT(drive_feedforward.kA),
+            ROBOT(drive_feedforward.kT),
+            ROBOT(ramsete_gains.b),
+            ROBOT(ramsete_gains.zeta),
+            ROBOT(ramsete_gains.min_k),
+            ROBOT(default_profile_limits.max_velocity),
+            ROBOT(default_profile_limits.max_acceleration),
+            ROBOT(default_profile_limits.max_jerk),
+            ROBOT(default_pursuit_params.min_lookahead),
+            ROBOT(default_pursuit_params.max_lookahead),
+            ROBOT(default_pursuit_params.lookahead_gain),
+            ROBOT(default_pursuit_params.curvature_shrink),
+            ROBOT(default_pursuit_params.max_acceleration),
+            ROBOT(default_drive_params.max_voltage),
+            ROBOT(default_drive_params.exit.small_error),
+            ROBOT(default_drive_params.exit.large_error),
+            ROBOT(default_drive_params.exit.max_velocity),
+            ROBOT(default_turn_params.max_voltage),
+            ROBOT(default_turn_params.exit.small_error),
+            ROBOT(default_turn_params.exit.large_error),
+            ROBOT(default_turn_params.exit.max_velocity),
+            PHYSICS("mass", w.params.mass),
+            PHYSICS("inertia", w.params.inertia),
+            PHYSICS("traction", w.params.traction),
+            PHYSICS("slip_stiffness", w.params.slip_stiffness),
+            PHYSICS("rolling_resistance", w.params.rolling_resistance),
+            PHYSICS("turn_scrub", w.params.turn_scrub),
+            PHYSICS("left_strength", w.params.left_strength),
+            PHYSICS("right_strength", w.params.right_strength),
+            PHYSICS("battery_voltage", w.params.battery_voltage),
+            PHYSICS("battery_resistance", w.params.battery_resistance),
+            PHYSICS("imu_drift", w.params.imu_drift),
+            PHYSICS("imu_noise", w.params.imu_noise),
+            PHYSICS("encoder_noise", w.params.encoder_noise),
+            PHYSICS("start_error_x", w.params.start_error_x),
+            PHYSICS("start_error_y", w.params.start_error_y),
+            PHYSICS("start_error_theta", w.params.start_error_theta),
+            PHYSICS("motor_resistance", w.motor_constants.resistance),
+            PHYSICS("motor_kt", w.motor_constants.kt),
+            PHYSICS("motor_current_limit", w.motor_constants.current_limit),
+        };
+    }();
+    return all;
+}
+
+#undef ROBOT
+#undef PHYSICS
+
+const Param* find_param(const std::string& name) {
+    for (const Param& param : params()) {
+        if (name == param.name) return &param;
+    }
+    return nullptr;
+}
+
+bool set_param(const std::string& assignment) {
+    std::size_t equals = assignment.find('=');
+    if (equals == std::string::npos) return false;
+    const Param* param = find_param(assignment.substr(0, equals));
+    if (param == nullptr) return false;
+    const char* text = assignment.c_str() + equals + 1;
+    char* end;
+    double value = std::strtod(text, &end);
+    if (end == text || *end != '\0') return false;
+    *param->value = value;
+    return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,31 @@
+#ifndef SIM_PARAMS_HPP
+#define SIM_PARAMS_HPP
+
+#include <string>
+#include <vector>
+
+// Named numbers the simulator can change before a run, for tuning and what-ifs.
+//
+// Robot code parameters are named by the C++ expression that holds them
+// (drive_gains.kp), so a tuned value can be written straight back as code.
+// The simulated robot's physics are named sim.* (sim.mass).
+
+namespace sim {
+
+struct Param {
+    const char* name;
+    double* value;
+    bool robot_code;  // false for sim.* physics
+};
+
+// Every parameter, in a fixed order
+const std::vector<Param>& params();
+
+const Param* find_param(const std::string& name);
+
+// Applies "name=value". Returns false if there's no such parameter or the value isn't a number.
+bool set_param(const std::string& assignment);
+
+}  // namespace sim
+
+#endif
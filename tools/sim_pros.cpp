@@ -0,0 +1,1260 @@
+#include "api.h"
+#include "sim_kernel.hpp"
+#include "sim_pros.hpp"
+#include "sim_world.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+// Link-time stand-ins for the parts of PROS the robot code uses. The C API does
+// the work against the simulated world, the C++ classes forward to it the way
+// the real library does. Every device is there: a port is installed the first
+// time something talks to it.
+
+using sim::world;
+
+namespace {
+
+std::string usd_dir;
+
+// --- Motors ---
+
+sim::SimMotor* motor_at(std::int8_t port) {
+    int p = std::abs(port);
+    if (p < 1 || p > sim::PORT_COUNT) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    sim::SimMotor& m = world().motors[p];
+    m.installed = true;
+    return &m;
+}
+
+int direction(std::int8_t port) {
+    return port < 0 ? -1 : 1;
+}
+
+double counts_per_rev(const sim::SimMotor& m) {
+    return m.gearset == 0 ? 1800 : m.gearset == 2 ? 300 : 900;
+}
+
+// Output shaft radians to and from the motor's encoder units
+double to_units(const sim::SimMotor& m, double rad) {
+    switch (m.encoder_units) {
+        case 1: return rad / (2 * M_PI);
+        case 2: return rad / (2 * M_PI) * counts_per_rev(m);
+        default: return rad * 180 / M_PI;
+    }
+}
+
+double from_units(const sim::SimMotor& m, double position) {
+    switch (m.encoder_units) {
+        case 1: return position * 2 * M_PI;
+        case 2: return position / counts_per_rev(m) * 2 * M_PI;
+        default: return position * M_PI / 180;
+    }
+}
+
+double rpm(double omega) {
+    return omega * 60 / (2 * M_PI);
+}
+
+void command(sim::SimMotor& m, sim::MotorMode mode) {
+    if (m.mode != mode) m.velocity_integral = 0;
+    m.mode = mode;
+}
+
+// --- Other devices ---
+
+sim::SimImu* imu_at(std::uint8_t port) {
+    if (port < 1 || port > sim::PORT_COUNT) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    sim::SimImu& imu = world().imus[port];
+    imu.installed = true;
+    if (sim::now_ms() < imu.calibrated_at) {
+        errno = EAGAIN;
+        return nullptr;
+    }
+    return &imu;
+}
+
+sim::SimRotation* rotation_at(std::uint8_t port) {
+    if (port < 1 || port > sim::PORT_COUNT) {
+        errno = ENXIO;
+        return nullptr;
+    }
+    sim::SimRotation& r = world().rotations[port];
+    r.installed = true;
+    return &r;
+}
+
+std::int32_t rotation_reading(const sim::SimRotation& r) {
+    return (r.reversed ? -r.report_position : r.report_position) - r.zero;
+}
+
+}  // namespace
+
+void sim::set_usd_dir(const char* dir) {
+    usd_dir = dir != nullptr ? dir : "";
+}
+
+// --- RTOS ---
+
+namespace pros::c {
+
+std::uint32_t millis(void) {
+    return sim::now_ms();
+}
+
+std::uint64_t micros(void) {
+    return sim::now_us();
+}
+
+void delay(const std::uint32_t milliseconds) {
+    sim::delay_ms(milliseconds);
+}
+
+void task_delay(const std::uint32_t milliseconds) {
+    sim::delay_ms(milliseconds);
+}
+
+void task_delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    sim::delay_until_ms(prev_time, delta);
+}
+
+task_t task_create(task_fn_t function, void* const parameters, std::uint32_t prio, const std::uint16_t stack_depth,
+                   const char* const name) {
+    return sim::create_task(function, parameters, prio, name);
+}
+
+void task_delete(task_t task) {
+    sim::delete_task(static_cast<sim::Task*>(task));
+}
+
+task_t task_get_current() {
+    return sim::current_task();
+}
+
+char* task_get_name(task_t task) {
+    return const_cast<char*>(sim::task_name(static_cast<sim::Task*>(task)));
+}
+
+std::uint32_t task_notify(task_t task) {
+    return sim::notify(static_cast<sim::Task*>(task));
+}
+
+std::uint32_t task_notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    return sim::notify_take(clear_on_exit, timeout);
+}
+
+mutex_t mutex_create(void) {
+    return sim::create_mutex();
+}
+
+bool mutex_take(mutex_t mutex, std::uint32_t timeout) {
+    return sim::take_mutex(static_cast<sim::Mutex*>(mutex), timeout);
+}
+
+bool mutex_give(mutex_t mutex) {
+    return sim::give_mutex(static_cast<sim::Mutex*>(mutex));
+}
+
+void mutex_delete(mutex_t mutex) {
+    // Kept for the life of the simulation, the kernel owns it
+}
+
+}  // namespace pros::c
+
+namespace pros::rtos {
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name) {
+    task = c::task_create(function, parameters, prio, stack_depth, name);
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    c::task_delay_until(prev_time, delta);
+}
+
+mutex_t Mutex::lazy_init() {
+    mutex_t existing = mutex.load();
+    if (existing != nullptr) return existing;
+    mutex_t created = c::mutex_create();
+    if (mutex.compare_exchange_strong(existing, created)) return created;
+    return existing;
+}
+
+Mutex::~Mutex() {
+    // Kernel mutexes live as long as the simulation
+}
+
+bool Mutex::take() {
+    return c::mutex_take(lazy_init(), TIMEOUT_MAX);
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+    return c::mutex_take(lazy_init(), timeout);
+}
+
+bool Mutex::give() {
+    return c::mutex_give(lazy_init());
+}
+
+void Mutex::lock() {
+    if (!take(TIMEOUT_MAX)) throw std::system_error(errno, std::system_category(), "Cannot obtain lock!");
+}
+
+void Mutex::unlock() {
+    give();
+}
+
+bool Mutex::try_lock() {
+    return take(0);
+}
+
+}  // namespace pros::rtos
+
+// --- Motors, C API ---
+
+namespace pros::c {
+
+std::int32_t motor_move_voltage(std::int8_t port, const std::int32_t voltage) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    // 0 V stops the motor the way its brake mode says, like on the brain
+    if (voltage == 0) return motor_brake(port);
+    command(*m, sim::MODE_VOLTAGE);
+    m->target_voltage = direction(port) * std::clamp(voltage, -12000, 12000) / 1000.0;
+    return 1;
+}
+
+std::int32_t motor_move(std::int8_t port, std::int32_t voltage) {
+    return motor_move_voltage(port, std::clamp(voltage, -127, 127) * 12000 / 127);
+}
+
+std::int32_t motor_brake(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    if (m->mode != sim::MODE_BRAKE) m->hold_position = m->angle;
+    command(*m, sim::MODE_BRAKE);
+    return 1;
+}
+
+std::int32_t motor_move_velocity(std::int8_t port, const std::int32_t velocity) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    command(*m, sim::MODE_VELOCITY);
+    m->target_velocity = direction(port) * std::clamp<double>(velocity, -m->free_rpm(), m->free_rpm());
+    return 1;
+}
+
+std::int32_t motor_move_absolute(std::int8_t port, double position, const std::int32_t velocity) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    command(*m, sim::MODE_POSITION);
+    m->target_position = m->zero + direction(port) * from_units(*m, position);
+    m->profile_velocity = velocity;
+    return 1;
+}
+
+std::int32_t motor_move_relative(std::int8_t port, double position, const std::int32_t velocity) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    // Relative to the last target if there is one, so repeated moves don't accumulate error
+    double from = m->mode == sim::MODE_POSITION ? m->target_position : m->angle;
+    command(*m, sim::MODE_POSITION);
+    m->target_position = from + direction(port) * from_units(*m, position);
+    m->profile_velocity = velocity;
+    return 1;
+}
+
+std::int32_t motor_modify_profiled_velocity(std::int8_t port, const std::int32_t velocity) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->profile_velocity = velocity;
+    return 1;
+}
+
+double motor_get_target_position(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return direction(port) * to_units(*m, m->target_position - m->zero);
+}
+
+std::int32_t motor_get_target_velocity(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return direction(port) * std::lround(m->target_velocity);
+}
+
+double motor_get_actual_velocity(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return direction(port) * rpm(m->report_omega);
+}
+
+std::int32_t motor_get_current_draw(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return std::lround(std::fabs(m->report_current) * 1000);
+}
+
+std::int32_t motor_get_direction(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return direction(port) * m->report_omega < 0 ? -1 : 1;
+}
+
+double motor_get_efficiency(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    double in = std::fabs(m->report_voltage * m->report_current);
+    if (in < 1e-6) return 0;
+    return std::clamp(std::fabs(m->report_torque * m->report_omega) / in * 100, 0.0, 100.0);
+}
+
+std::int32_t motor_is_over_current(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return std::fabs(m->report_current) >= std::min(m->current_limit, world().motor_constants.current_limit) - 1e-3;
+}
+
+std::int32_t motor_is_over_temp(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return m->temperature >= 55;
+}
+
+std::uint32_t motor_get_faults(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    std::uint32_t faults = 0;
+    if (m->temperature >= 55) faults |= E_MOTOR_FAULT_MOTOR_OVER_TEMP;
+    if (motor_is_over_current(port)) faults |= E_MOTOR_FAULT_OVER_CURRENT;
+    return faults;
+}
+
+std::uint32_t motor_get_flags(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return std::fabs(m->report_omega) < 1e-3 ? E_MOTOR_FLAGS_ZERO_VELOCITY : E_MOTOR_FLAGS_NONE;
+}
+
+std::int32_t motor_get_raw_position(std::int8_t port, std::uint32_t* const timestamp) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    if (timestamp != nullptr) *timestamp = m->report_time;
+    return direction(port) * std::lround(m->report_angle / (2 * M_PI) * counts_per_rev(*m));
+}
+
+double motor_get_position(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return direction(port) * to_units(*m, m->report_angle - m->zero);
+}
+
+double motor_get_power(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return std::fabs(m->report_voltage * m->report_current);
+}
+
+double motor_get_temperature(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return m->temperature;
+}
+
+double motor_get_torque(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR_F;
+    return direction(port) * m->report_torque;
+}
+
+std::int32_t motor_get_voltage(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return direction(port) * std::lround(m->report_voltage * 1000);
+}
+
+std::int32_t motor_set_zero_position(std::int8_t port, const double position) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->zero = m->angle - direction(port) * from_units(*m, position);
+    return 1;
+}
+
+std::int32_t motor_tare_position(std::int8_t port) {
+    return motor_set_zero_position(port, 0);
+}
+
+std::int32_t motor_set_brake_mode(std::int8_t port, const motor_brake_mode_e_t mode) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->brake_mode = mode;
+    return 1;
+}
+
+std::int32_t motor_set_current_limit(std::int8_t port, const std::int32_t limit) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->current_limit = std::clamp(limit, 0, 2500) / 1000.0;
+    return 1;
+}
+
+std::int32_t motor_set_encoder_units(std::int8_t port, const motor_encoder_units_e_t units) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->encoder_units = units;
+    return 1;
+}
+
+std::int32_t motor_set_gearing(std::int8_t port, const motor_gearset_e_t gearset) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->gearset = gearset;
+    return 1;
+}
+
+std::int32_t motor_set_voltage_limit(std::int8_t port, const std::int32_t limit) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    m->voltage_limit = std::clamp(limit, 0, 12000) / 1000.0;
+    return 1;
+}
+
+motor_brake_mode_e_t motor_get_brake_mode(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return E_MOTOR_BRAKE_INVALID;
+    return static_cast<motor_brake_mode_e_t>(m->brake_mode);
+}
+
+std::int32_t motor_get_current_limit(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return std::lround(m->current_limit * 1000);
+}
+
+motor_encoder_units_e_t motor_get_encoder_units(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return E_MOTOR_ENCODER_INVALID;
+    return static_cast<motor_encoder_units_e_t>(m->encoder_units);
+}
+
+motor_gearset_e_t motor_get_gearing(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return E_MOTOR_GEARSET_INVALID;
+    return static_cast<motor_gearset_e_t>(m->gearset);
+}
+
+std::int32_t motor_get_voltage_limit(std::int8_t port) {
+    sim::SimMotor* m = motor_at(port);
+    if (m == nullptr) return PROS_ERR;
+    return std::lround(m->voltage_limit * 1000);
+}
+
+motor_type_e_t motor_get_type(std::int8_t port) {
+    return E_MOTOR_TYPE_V5;
+}
+
+}  // namespace pros::c
+
+// --- Motors, C++ API ---
+// One motor per object here, so index is ignored and the _all functions return one value
+
+namespace pros::v5 {
+
+Motor::Motor(const std::int8_t port, const MotorGears gearset, const MotorUnits encoder_units)
+    : Device(std::abs(port), DeviceType::motor), _port(port) {
+    if (gearset != MotorGears::invalid) set_gearing(gearset);
+    if (encoder_units != MotorUnits::invalid) set_encoder_units(encoder_units);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const {
+    return c::motor_move(_port, voltage);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+    return c::motor_move_absolute(_port, position, velocity);
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+    return c::motor_move_relative(_port, position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const {
+    return c::motor_move_velocity(_port, velocity);
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const {
+    return c::motor_move_voltage(_port, voltage);
+}
+
+std::int32_t Motor::brake(void) const {
+    return c::motor_brake(_port);
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const {
+    return c::motor_modify_profiled_velocity(_port, velocity);
+}
+
+double Motor::get_target_position(const std::uint8_t index) const {
+    return c::motor_get_target_position(_port);
+}
+
+std::int32_t Motor::get_target_velocity(const std::uint8_t index) const {
+    return c::motor_get_target_velocity(_port);
+}
+
+double Motor::get_actual_velocity(const std::uint8_t index) const {
+    return c::motor_get_actual_velocity(_port);
+}
+
+std::int32_t Motor::get_current_draw(const std::uint8_t index) const {
+    return c::motor_get_current_draw(_port);
+}
+
+std::int32_t Motor::get_direction(const std::uint8_t index) const {
+    return c::motor_get_direction(_port);
+}
+
+double Motor::get_efficiency(const std::uint8_t index) const {
+    return c::motor_get_efficiency(_port);
+}
+
+std::uint32_t Motor::get_faults(const std::uint8_t index) const {
+    return c::motor_get_faults(_port);
+}
+
+std::uint32_t Motor::get_flags(const std::uint8_t index) const {
+    return c::motor_get_flags(_port);
+}
+
+double Motor::get_position(const std::uint8_t index) const {
+    return c::motor_get_position(_port);
+}
+
+double Motor::get_power(const std::uint8_t index) const {
+    return c::motor_get_power(_port);
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp, const std::uint8_t index) const {
+    return c::motor_get_raw_position(_port, timestamp);
+}
+
+double Motor::get_temperature(const std::uint8_t index) const {
+    return c::motor_get_temperature(_port);
+}
+
+double Motor::get_torque(const std::uint8_t index) const {
+    return c::motor_get_torque(_port);
+}
+
+std::int32_t Motor::get_voltage(const std::uint8_t index) const {
+    return c::motor_get_voltage(_port);
+}
+
+std::int32_t Motor::is_over_current(const std::uint8_t index) const {
+    return c::motor_is_over_current(_port);
+}
+
+std::int32_t Motor::is_over_temp(const std::uint8_t index) const {
+    return c::motor_is_over_temp(_port);
+}
+
+MotorBrake Motor::get_brake_mode(const std::uint8_t index) const {
+    return static_cast<MotorBrake>(c::motor_get_brake_mode(_port));
+}
+
+std::int32_t Motor::get_current_limit(const std::uint8_t index) const {
+    return c::motor_get_current_limit(_port);
+}
+
+MotorUnits Motor::get_encoder_units(const std::uint8_t index) const {
+    return static_cast<MotorUnits>(c::motor_get_encoder_units(_port));
+}
+
+MotorGears Motor::get_gearing(const std::uint8_t index) const {
+    return static_cast<MotorGears>(c::motor_get_gearing(_port));
+}
+
+std::int32_t Motor::get_voltage_limit(const std::uint8_t index) const {
+    return c::motor_get_voltage_limit(_port);
+}
+
+std::int32_t Motor::is_reversed(const std::uint8_t index) const {
+    return _port < 0;
+}
+
+MotorType Motor::get_type(const std::uint8_t index) const {
+    return MotorType::v5;
+}
+
+std::int32_t Motor::set_brake_mode(const MotorBrake mode, const std::uint8_t index) const {
+    return c::motor_set_brake_mode(_port, static_cast<motor_brake_mode_e_t>(mode));
+}
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode, const std::uint8_t index) const {
+    return c::motor_set_brake_mode(_port, mode);
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit, const std::uint8_t index) const {
+    return c::motor_set_current_limit(_port, limit);
+}
+
+std::int32_t Motor::set_encoder_units(const MotorUnits units, const std::uint8_t index) const {
+    return c::motor_set_encoder_units(_port, static_cast<motor_encoder_units_e_t>(units));
+}
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units, const std::uint8_t index) const {
+    return c::motor_set_encoder_units(_port, units);
+}
+
+std::int32_t Motor::set_gearing(const MotorGears gearset, const std::uint8_t index) const {
+    return c::motor_set_gearing(_port, static_cast<motor_gearset_e_t>(gearset));
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset, const std::uint8_t index) const {
+    return c::motor_set_gearing(_port, gearset);
+}
+
+std::int32_t Motor::set_reversed(const bool reverse, const std::uint8_t index) {
+    _port = reverse ? -std::abs(_port) : std::abs(_port);
+    return 1;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit, const std::uint8_t index) const {
+    return c::motor_set_voltage_limit(_port, limit);
+}
+
+std::int32_t Motor::set_zero_position(const double position, const std::uint8_t index) const {
+    return c::motor_set_zero_position(_port, position);
+}
+
+std::int32_t Motor::tare_position(const std::uint8_t index) const {
+    return c::motor_tare_position(_port);
+}
+
+std::int8_t Motor::size(void) const {
+    return 1;
+}
+
+std::int8_t Motor::get_port(const std::uint8_t index) const {
+    return _port;
+}
+
+std::vector<double> Motor::get_target_position_all(void) const {
+    return {get_target_position()};
+}
+
+std::vector<std::int32_t> Motor::get_target_velocity_all(void) const {
+    return {get_target_velocity()};
+}
+
+std::vector<double> Motor::get_actual_velocity_all(void) const {
+    return {get_actual_velocity()};
+}
+
+std::vector<std::int32_t> Motor::get_current_draw_all(void) const {
+    return {get_current_draw()};
+}
+
+std::vector<std::int32_t> Motor::get_direction_all(void) const {
+    return {get_direction()};
+}
+
+std::vector<double> Motor::get_efficiency_all(void) const {
+    return {get_efficiency()};
+}
+
+std::vector<std::uint32_t> Motor::get_faults_all(void) const {
+    return {get_faults()};
+}
+
+std::vector<std::uint32_t> Motor::get_flags_all(void) const {
+    return {get_flags()};
+}
+
+std::vector<double> Motor::get_position_all(void) const {
+    return {get_position()};
+}
+
+std::vector<double> Motor::get_power_all(void) const {
+    return {get_power()};
+}
+
+std::vector<std::int32_t> Motor::get_raw_position_all(std::uint32_t* const timestamp) const {
+    return {get_raw_position(timestamp)};
+}
+
+std::vector<double> Motor::get_temperature_all(void) const {
+    return {get_temperature()};
+}
+
+std::vector<double> Motor::get_torque_all(void) const {
+    return {get_torque()};
+}
+
+std::vector<std::int32_t> Motor::get_voltage_all(void) const {
+    return {get_voltage()};
+}
+
+std::vector<std::int32_t> Motor::is_over_current_all(void) const {
+    return {is_over_current()};
+}
+
+std::vector<std::int32_t> Motor::is_over_temp_all(void) const {
+    return {is_over_temp()};
+}
+
+std::vector<MotorBrake> Motor::get_brake_mode_all(void) const {
+    return {get_brake_mode()};
+}
+
+std::vector<std::int32_t> Motor::get_current_limit_all(void) const {
+    return {get_current_limit()};
+}
+
+std::vector<MotorUnits> Motor::get_encoder_units_all(void) const {
+    return {get_encoder_units()};
+}
+
+std::vector<MotorGears> Motor::get_gearing_all(void) const {
+    return {get_gearing()};
+}
+
+std::vector<std::int8_t> Motor::get_port_all(void) const {
+    return {_port};
+}
+
+std::vector<std::int32_t> Motor::get_voltage_limit_all(void) const {
+    return {get_voltage_limit()};
+}
+
+std::vector<std::int32_t> Motor::is_reversed_all(void) const {
+    return {is_reversed()};
+}
+
+std::vector<MotorType> Motor::get_type_all(void) const {
+    return {get_type()};
+}
+
+std::int32_t Motor::set_brake_mode_all(const MotorBrake mode) const {
+    return set_brake_mode(mode);
+}
+
+std::int32_t Motor::set_brake_mode_all(const motor_brake_mode_e_t mode) const {
+    return set_brake_mode(mode);
+}
+
+std::int32_t Motor::set_current_limit_all(const std::int32_t limit) const {
+    return set_current_limit(limit);
+}
+
+std::int32_t Motor::set_encoder_units_all(const MotorUnits units) const {
+    return set_encoder_units(units);
+}
+
+std::int32_t Motor::set_encoder_units_all(const motor_encoder_units_e_t units) const {
+    return set_encoder_units(units);
+}
+
+std::int32_t Motor::set_gearing_all(const MotorGears gearset) const {
+    return set_gearing(gearset);
+}
+
+std::int32_t Motor::set_gearing_all(const motor_gearset_e_t gearset) const {
+    return set_gearing(gearset);
+}
+
+std::int32_t Motor::set_reversed_all(const bool reverse) {
+    return set_reversed(reverse);
+}
+
+std::int32_t Motor::set_voltage_limit_all(const std::int32_t limit) const {
+    return set_voltage_limit(limit);
+}
+
+std::int32_t Motor::set_zero_position_all(const double position) const {
+    return set_zero_position(position);
+}
+
+std::int32_t Motor::tare_position_all(void) const {
+    return tare_position();
+}
+
+// --- Devices ---
+
+Device::Device(const std::uint8_t port) : _port(port) {}
+
+std::uint8_t Device::get_port(void) const {
+    return _port;
+}
+
+bool Device::is_installed() {
+    return true;
+}
+
+}  // namespace pros::v5
+
+// --- IMU ---
+// Heading comes from the world's true heading plus drift and noise. It reads
+// PROS_ERR_F for the 2 s after a reset, like a calibrating IMU.
+
+namespace pros::c {
+
+std::int32_t imu_reset(std::uint8_t port) {
+    if (port < 1 || port > sim::PORT_COUNT) {
+        errno = ENXIO;
+        return PROS_ERR;
+    }
+    sim::SimImu& imu = world().imus[port];
+    imu.installed = true;
+    imu.calibrated_at = sim::now_ms() + 2000;
+    imu.drift = 0;
+    imu.offset = 0;
+    imu.offset = -world().imu_rotation(imu);
+    return 1;
+}
+
+std::int32_t imu_reset_blocking(std::uint8_t port) {
+    if (imu_reset(port) == PROS_ERR) return PROS_ERR;
+    sim::delay_ms(2000);
+    return 1;
+}
+
+std::int32_t imu_set_data_rate(std::uint8_t port, std::uint32_t rate) {
+    return imu_at(port) != nullptr ? 1 : PROS_ERR;
+}
+
+double imu_get_rotation(std::uint8_t port) {
+    sim::SimImu* imu = imu_at(port);
+    if (imu == nullptr) return PROS_ERR_F;
+    return world().imu_rotation(*imu);
+}
+
+double imu_get_heading(std::uint8_t port) {
+    double rotation = imu_get_rotation(port);
+    if (rotation == PROS_ERR_F) return PROS_ERR_F;
+    double heading = std::fmod(rotation, 360);
+    return heading < 0 ? heading + 360 : heading;
+}
+
+double imu_get_yaw(std::uint8_t port) {
+    double heading = imu_get_heading(port);
+    if (heading == PROS_ERR_F) return PROS_ERR_F;
+    return heading > 180 ? heading - 360 : heading;
+}
+
+// The field is flat
+double imu_get_pitch(std::uint8_t port) {
+    return imu_at(port) != nullptr ? 0 : PROS_ERR_F;
+}
+
+double imu_get_roll(std::uint8_t port) {
+    return imu_at(port) != nullptr ? 0 : PROS_ERR_F;
+}
+
+euler_s_t imu_get_euler(std::uint8_t port) {
+    double yaw = imu_get_yaw(port);
+    if (yaw == PROS_ERR_F) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, yaw};
+}
+
+quaternion_s_t imu_get_quaternion(std::uint8_t port) {
+    double yaw = imu_get_yaw(port);
+    if (yaw == PROS_ERR_F) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    double half = yaw * M_PI / 360;
+    return {0, 0, std::sin(half), std::cos(half)};
+}
+
+imu_gyro_s_t imu_get_gyro_rate(std::uint8_t port) {
+    if (imu_at(port) == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, -world().angular_velocity * 180 / M_PI};
+}
+
+imu_accel_s_t imu_get_accel(std::uint8_t port) {
+    if (imu_at(port) == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, 1};
+}
+
+imu_status_e_t imu_get_status(std::uint8_t port) {
+    if (port < 1 || port > sim::PORT_COUNT) return E_IMU_STATUS_ERROR;
+    return sim::now_ms() < world().imus[port].calibrated_at ? E_IMU_STATUS_CALIBRATING : E_IMU_STATUS_READY;
+}
+
+imu_orientation_e_t imu_get_physical_orientation(std::uint8_t port) {
+    return E_IMU_Z_UP;
+}
+
+std::int32_t imu_set_rotation(std::uint8_t port, double target) {
+    sim::SimImu* imu = imu_at(port);
+    if (imu == nullptr) return PROS_ERR;
+    imu->offset += target - world().imu_rotation(*imu);
+    return 1;
+}
+
+std::int32_t imu_set_heading(std::uint8_t port, double target) {
+    double heading = imu_get_heading(port);
+    if (heading == PROS_ERR_F) return PROS_ERR;
+    world().imus[port].offset += target - heading;
+    return 1;
+}
+
+std::int32_t imu_set_yaw(std::uint8_t port, double target) {
+    return imu_set_heading(port, target);
+}
+
+std::int32_t imu_set_pitch(std::uint8_t port, double target) {
+    return imu_at(port) != nullptr ? 1 : PROS_ERR;
+}
+
+std::int32_t imu_set_roll(std::uint8_t port, double target) {
+    return imu_at(port) != nullptr ? 1 : PROS_ERR;
+}
+
+std::int32_t imu_set_euler(std::uint8_t port, euler_s_t target) {
+    return imu_set_yaw(port, target.yaw);
+}
+
+std::int32_t imu_tare_rotation(std::uint8_t port) {
+    return imu_set_rotation(port, 0);
+}
+
+std::int32_t imu_tare_heading(std::uint8_t port) {
+    return imu_set_heading(port, 0);
+}
+
+std::int32_t imu_tare_yaw(std::uint8_t port) {
+    return imu_set_yaw(port, 0);
+}
+
+std::int32_t imu_tare_pitch(std::uint8_t port) {
+    return imu_set_pitch(port, 0);
+}
+
+std::int32_t imu_tare_roll(std::uint8_t port) {
+    return imu_set_roll(port, 0);
+}
+
+std::int32_t imu_tare_euler(std::uint8_t port) {
+    return imu_tare_yaw(port);
+}
+
+std::int32_t imu_tare(std::uint8_t port) {
+    if (imu_tare_rotation(port) == PROS_ERR) return PROS_ERR;
+    return 1;
+}
+
+}  // namespace pros::c
+
+namespace pros::v5 {
+
+std::int32_t Imu::reset(bool blocking) const {
+    return blocking ? c::imu_reset_blocking(_port) : c::imu_reset(_port);
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const {
+    return c::imu_set_data_rate(_port, rate);
+}
+
+double Imu::get_rotation() const {
+    return c::imu_get_rotation(_port);
+}
+
+double Imu::get_heading() const {
+    return c::imu_get_heading(_port);
+}
+
+quaternion_s_t Imu::get_quaternion() const {
+    return c::imu_get_quaternion(_port);
+}
+
+euler_s_t Imu::get_euler() const {
+    return c::imu_get_euler(_port);
+}
+
+double Imu::get_pitch() const {
+    return c::imu_get_pitch(_port);
+}
+
+double Imu::get_roll() const {
+    return c::imu_get_roll(_port);
+}
+
+double Imu::get_yaw() const {
+    return c::imu_get_yaw(_port);
+}
+
+imu_gyro_s_t Imu::get_gyro_rate() const {
+    return c::imu_get_gyro_rate(_port);
+}
+
+std::int32_t Imu::tare_rotation() const {
+    return c::imu_tare_rotation(_port);
+}
+
+std::int32_t Imu::tare_heading() const {
+    return c::imu_tare_heading(_port);
+}
+
+std::int32_t Imu::tare_pitch() const {
+    return c::imu_tare_pitch(_port);
+}
+
+std::int32_t Imu::tare_yaw() const {
+    return c::imu_tare_yaw(_port);
+}
+
+std::int32_t Imu::tare_roll() const {
+    return c::imu_tare_roll(_port);
+}
+
+std::int32_t Imu::tare() const {
+    return c::imu_tare(_port);
+}
+
+std::int32_t Imu::tare_euler() const {
+    return c::imu_tare_euler(_port);
+}
+
+std::int32_t Imu::set_heading(const double target) const {
+    return c::imu_set_heading(_port, target);
+}
+
+std::int32_t Imu::set_rotation(const double target) const {
+    return c::imu_set_rotation(_port, target);
+}
+
+std::int32_t Imu::set_yaw(const double target) const {
+    return c::imu_set_yaw(_port, target);
+}
+
+std::int32_t Imu::set_pitch(const double target) const {
+    return c::imu_set_pitch(_port, target);
+}
+
+std::int32_t Imu::set_roll(const double target) const {
+    return c::imu_set_roll(_port, target);
+}
+
+std::int32_t Imu::set_euler(const euler_s_t target) const {
+    return c::imu_set_euler(_port, target);
+}
+
+imu_accel_s_t Imu::get_accel() const {
+    return c::imu_get_accel(_port);
+}
+
+ImuStatus Imu::get_status() const {
+    imu_status_e_t status = c::imu_get_status(_port);
+    if (status == E_IMU_STATUS_CALIBRATING) return ImuStatus::calibrating;
+    if (status == E_IMU_STATUS_ERROR) return ImuStatus::error;
+    return ImuStatus::ready;
+}
+
+bool Imu::is_calibrating() const {
+    return c::imu_get_status(_port) == E_IMU_STATUS_CALIBRATING;
+}
+
+imu_orientation_e_t Imu::get_physical_orientation() const {
+    return c::imu_get_physical_orientation(_port);
+}
+
+}  // namespace pros::v5
+
+// --- Rotation sensors ---
+// Centidegrees of wheel travel, refreshed at the sensor's data rate
+
+namespace pros::c {
+
+std::int32_t rotation_set_position(std::uint8_t port, std::int32_t position) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    r->zero += rotation_reading(*r) - position;
+    return 1;
+}
+
+std::int32_t rotation_reset_position(std::uint8_t port) {
+    return rotation_set_position(port, 0);
+}
+
+std::int32_t rotation_reset(std::uint8_t port) {
+    std::int32_t angle = rotation_get_angle(port);
+    if (angle == PROS_ERR) return PROS_ERR;
+    return rotation_set_position(port, angle);
+}
+
+std::int32_t rotation_set_data_rate(std::uint8_t port, std::uint32_t rate) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    // 5 ms at the fastest, in steps of 5
+    r->data_rate = std::max<std::uint32_t>(5, rate / 5 * 5);
+    return 1;
+}
+
+std::int32_t rotation_get_position(std::uint8_t port) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    return rotation_reading(*r);
+}
+
+std::int32_t rotation_get_velocity(std::uint8_t port) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    const sim::World& w = world();
+    double speed = r->perpendicular ? r->forward_offset * w.angular_velocity
+                                    : w.velocity - r->lateral_offset * w.angular_velocity;
+    double centidegrees = speed / (M_PI * r->wheel_diameter) * 36000;
+    return std::lround(r->reversed ? -centidegrees : centidegrees);
+}
+
+std::int32_t rotation_get_angle(std::uint8_t port) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    std::int32_t angle = rotation_reading(*r) % 36000;
+    return angle < 0 ? angle + 36000 : angle;
+}
+
+std::int32_t rotation_set_reversed(std::uint8_t port, bool value) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    // Keeps reading the same position, counting the other way from here
+    std::int32_t position = rotation_reading(*r);
+    r->reversed = value;
+    r->zero = 0;
+    r->zero = rotation_reading(*r) - position;
+    return 1;
+}
+
+std::int32_t rotation_reverse(std::uint8_t port) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    return rotation_set_reversed(port, !r->reversed);
+}
+
+std::int32_t rotation_init_reverse(std::uint8_t port, bool reverse_flag) {
+    return rotation_set_reversed(port, reverse_flag);
+}
+
+std::int32_t rotation_get_reversed(std::uint8_t port) {
+    sim::SimRotation* r = rotation_at(port);
+    if (r == nullptr) return PROS_ERR;
+    return r->reversed;
+}
+
+}  // namespace pros::c
+
+namespace pros::v5 {
+
+Rotation::Rotation(const std::int8_t port) : Device(std::abs(port), DeviceType::rotation) {
+    if (port < 0) c::rotation_set_reversed(std::abs(port), true);
+}
+
+std::int32_t Rotation::reset() {
+    return c::rotation_reset(_port);
+}
+
+std::int32_t Rotation::set_data_rate(std::uint32_t rate) const {
+    return c::rotation_set_data_rate(_port, rate);
+}
+
+std::int32_t Rotation::set_position(std::int32_t position) const {
+    return c::rotation_set_position(_port, position);
+}
+
+std::int32_t Rotation::reset_position(void) const {
+    return c::rotation_reset_position(_port);
+}
+
+std::int32_t Rotation::get_position() const {
+    return c::rotation_get_position(_port);
+}
+
+std::int32_t Rotation::get_velocity() const {
+    return c::rotation_get_velocity(_port);
+}
+
+std::int32_t Rotation::get_angle() const {
+    return c::rotation_get_angle(_port);
+}
+
+std::int32_t Rotation::set_reversed(bool value) const {
+    return c::rotation_set_reversed(_port, value);
+}
+
+std::int32_t Rotation::reverse() const {
+    return c::rotation_reverse(_port);
+}
+
+std::int32_t Rotation::get_reversed() const {
+    return c::rotation_get_reversed(_port);
+}
+
+}  // namespace pros::v5
+
+// --- Controller, battery, SD card ---
+
+namespace pros::c {
+
+std::int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) {
+    if (id < 0 || id > 1 || channel < 0 || channel > 3) {
+        errno = EINVAL;
+        return 0;
+    }
+    return world().controllers[id].analog[channel];
+}
+
+std::int32_t controller_get_digital(controller_id_e_t id, controller_digital_e_t button) {
+    int bit = button - E_CONTROLLER_DIGITAL_L1;
+    if (id < 0 || id > 1 || bit < 0 || bit > 11) {
+        errno = EINVAL;
+        return 0;
+    }
+    return (world().controllers[id].buttons >> bit) & 1;
+}
+
+std::int32_t battery_get_voltage(void) {
+    return std::lround(world().battery * 1000);
+}
+
+std::int32_t battery_get_current(void) {
+    return std::lround(world().battery_current * 1000);
+}
+
+double battery_get_temperature(void) {
+    return 30;
+}
+
+double battery_get_capacity(void) {
+    const sim::World& w = world();
+    return std::max(0.0, 100 * (1 - w.charge_used / w.params.battery_capacity));
+}
+
+std::int32_t usd_is_installed(void) {
+    return !usd_dir.empty();
+}
+
+}  // namespace pros::c
+
+std::int32_t pros::usd::is_installed(void) {
+    return c::usd_is_installed();
+}
+
+// Linked with --wrap=fopen: paths on the card go to the --usd directory instead
+extern "C" FILE* __real_fopen(const char* path, const char* mode);
+
+extern "C" FILE* __wrap_fopen(const char* path, const char* mode) {
+    if (std::strncmp(path, "/usd/", 5) != 0) return __real_fopen(path, mode);
+    if (usd_dir.empty()) {
+        errno = ENOENT;
+        return nullptr;
+    }
+    std::string host_path = usd_dir + "/" + (path + 5);
+    return __real_fopen(host_path.c_str(), mode);
+}
@@ -0,0 +1,14 @@
+#ifndef SIM_PROS_HPP
+#define SIM_PROS_HPP
+
+// Setup for the PROS API layer (sim_pros.cpp), from the simulator's main
+
+namespace sim {
+
+// Directory that stands in for the SD card. Without one usd::is_installed()
+// is false, like a brain with no card in it.
+void set_usd_dir(const char* dir);
+
+}  // namespace sim
+
+#endif
@@ -0,0 +1,9 @@
+// Stand-in for src/auton_select.cpp, which needs the brain's screen. The sim's
+// main sets selected_auton from --auton, the host tests set it themselves.
+
+#include "main.h"
+#include "auton_select.hpp"
+
+int selected_auton = 1;
+
+void create_auton_selector() {}
@@ -0,0 +1,243 @@
+#include "sim_world.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+World& world() {
+    static World instance;
+    return instance;
+}
+
+namespace {
+
+constexpr int SUBSTEPS = 4;  // per ms, the tire model is stiff
+constexpr double GRAVITY = 9.81;
+constexpr double INCH = 0.0254;
+
+double rpm_of(double omega) {
+    return omega * 60 / (2 * M_PI);
+}
+
+// The motor's own velocity controller, a feedforward plus PI on the output rpm
+double velocity_control(SimMotor& m, double target_rpm, double dt) {
+    double error = target_rpm - rpm_of(m.omega);
+    m.velocity_integral = std::clamp(m.velocity_integral + error * dt, -40.0, 40.0);
+    return 12 * target_rpm / m.free_rpm() + 0.04 * error + 0.3 * m.velocity_integral;
+}
+
+double position_control(SimMotor& m, double target, double max_rpm, double dt) {
+    double error_deg = (target - m.angle) * 180 / M_PI;
+    double rpm = std::clamp(error_deg * 2.0, -max_rpm, max_rpm);
+    return velocity_control(m, rpm, dt);
+}
+
+// Torque at the cartridge output for the motor's current command and speed.
+// Updates the electrical state and temperature as it goes.
+double motor_torque(SimMotor& m, const MotorConstants& k, double battery, bool enabled, double dt) {
+    double ratio = m.ratio();
+    double motor_omega = m.omega * ratio;
+
+    bool open_circuit = !enabled;
+    double voltage = 0;
+    switch (m.mode) {
+        case MODE_VOLTAGE:
+            voltage = m.target_voltage;
+            break;
+        case MODE_VELOCITY:
+            voltage = velocity_control(m, m.target_velocity, dt);
+            break;
+        case MODE_POSITION:
+            voltage = position_control(m, m.target_position, std::fabs(m.profile_velocity), dt);
+            break;
+        case MODE_BRAKE:
+            // Coast leaves the windings open, brake shorts them, hold servos to where it stopped
+            if (m.brake_mode == 0) open_circuit = true;
+            if (m.brake_mode == 2) voltage = position_control(m, m.hold_position, m.free_rpm(), dt);
+            break;
+    }
+
+    double limit = std::min(m.voltage_limit, battery);
+    voltage = std::clamp(voltage, -limit, limit);
+    double current = 0;
+    if (!open_circuit) {
+        double current_limit = std::min(m.current_limit, k.current_limit);
+        current = std::clamp((voltage - k.ke * motor_omega) / k.resistance, -current_limit, current_limit);
+    } else {
+        voltage = 0;
+    }
+
+    double torque = (k.kt * current - k.friction * std::tanh(motor_omega / 2.0)) * ratio;
+    m.voltage = voltage;
+    m.current = current;
+    m.torque = torque;
+    m.temperature += (current * current * k.resistance - k.cooling * (m.temperature - 25)) / k.thermal_mass * dt;
+    return torque;
+}
+
+double reflected_inertia(const SimMotor& m, const MotorConstants& k) {
+    return k.rotor_inertia * m.ratio() * m.ratio();
+}
+
+}  // namespace
+
+double SimMotor::ratio() const {
+    return gearset == 0 ? 36 : gearset == 2 ? 6 : 18;
+}
+
+void World::attach_motor(int port, MotorRole role) {
+    int p = std::abs(port);
+    if (p < 1 || p > PORT_COUNT) return;
+    roles[p] = role;
+    role_sign[p] = port < 0 ? -1 : 1;
+}
+
+void World::place(double x_in, double y_in, double theta_rad) {
+    x = (x_in + params.start_error_x) * INCH;
+    y = (y_in + params.start_error_y) * INCH;
+    theta = theta_rad + params.start_error_theta * M_PI / 180;
+    velocity = angular_velocity = 0;
+    wheel_omega[0] = wheel_omega[1] = 0;
+}
+
+double World::imu_rotation(const SimImu& imu) const {
+    return -theta * 180 / M_PI + imu.offset + imu.drift + imu.noise;
+}
+
+void World::step() {
+    const RobotParams& p = params;
+    const double dt = 0.001 / SUBSTEPS;
+    const double side_normal = p.mass * GRAVITY / 2;
+
+    for (int sub = 0; sub < SUBSTEPS; sub++) {
+        double power = 0;
+        double drive_torque[2] = {}, drive_inertia[2] = {p.wheel_inertia, p.wheel_inertia};
+        double intake_torque = 0, intake_inertia = p.intake_inertia;
+        double lift_torque = 0, lift_inertia = p.lift_arm_mass * p.lift_arm_length * p.lift_arm_length;
+
+        for (int port = 1; port <= PORT_COUNT; port++) {
+            SimMotor& m = motors[port];
+            if (!m.installed) continue;
+            double torque = motor_torque(m, motor_constants, battery, enabled, dt);
+            double inertia = reflected_inertia(m, motor_constants);
+            power += std::fabs(m.voltage * m.current);
+
+            int sign = role_sign[port];
+            switch (roles[port]) {
+                case ROLE_DRIVE_LEFT:
+                case ROLE_DRIVE_RIGHT: {
+                    int side = roles[port] == ROLE_DRIVE_LEFT ? 0 : 1;
+                    double strength = side == 0 ? p.left_strength : p.right_strength;
+                    drive_torque[side] += sign * torque * strength * p.wheel_ratio;
+                    drive_inertia[side] += inertia * p.wheel_ratio * p.wheel_ratio;
+                    break;
+                }
+                case ROLE_INTAKE:
+                    intake_torque += sign * torque;
+                    intake_inertia += inertia;
+                    break;
+                case ROLE_LIFT:
+                    lift_torque += sign * torque * p.lift_ratio;
+                    lift_inertia += inertia * p.lift_ratio * p.lift_ratio;
+                    break;
+                case ROLE_FREE:
+                    m.omega += torque / (inertia + 1e-4) * dt;
+                    break;
+            }
+        }
+
+        // Drivetrain: each side's wheels push on the floor through the tire,
+        // which grips up to its friction limit and slips past it
+        double ground[2] = {velocity - angular_velocity * p.track_width / 2,
+                            velocity + angular_velocity * p.track_width / 2};
+        double force[2];
+        for (int side = 0; side < 2; side++) {
+            slip[side] = wheel_omega[side] * p.wheel_radius - ground[side];
+            double grip = p.traction * side_normal;
+            force[side] = std::clamp(p.slip_stiffness * slip[side], -grip, grip);
+            wheel_omega[side] += (drive_torque[side] - force[side] * p.wheel_radius) / drive_inertia[side] * dt;
+            max_slip = std::max(max_slip, std::fabs(slip[side]));
+        }
+        double accel = (force[0] + force[1] - p.rolling_resistance * std::tanh(velocity / 0.01)) / p.mass;
+        double alpha = ((force[1] - force[0]) * p.track_width / 2 - p.turn_scrub * std::tanh(angular_velocity / 0.05)) /
+                       p.inertia;
+        velocity += accel * dt;
+        angular_velocity += alpha * dt;
+        double mid_theta = theta + angular_velocity * dt / 2;
+        x += velocity * std::cos(mid_theta) * dt;
+        y += velocity * std::sin(mid_theta) * dt;
+        theta += angular_velocity * dt;
+
+        // Tracking wheels roll with the floor
+        for (SimRotation& r : rotations) {
+            if (!r.installed) continue;
+            r.travel += r.perpendicular ? r.forward_offset * angular_velocity * dt
+                                        : (velocity - r.lateral_offset * angular_velocity) * dt;
+        }
+
+        intake_omega += (intake_torque - p.intake_drag * intake_omega) / intake_inertia * dt;
+
+        // The arm against gravity, stopped hard at either end
+        double gravity = p.lift_arm_mass * GRAVITY * p.lift_arm_length * std::cos(lift_angle);
+        lift_omega += (lift_torque - gravity) / lift_inertia * dt;
+        lift_angle += lift_omega * dt;
+        if (lift_angle < p.lift_min) {
+            lift_angle = p.lift_min;
+            lift_omega = std::max(lift_omega, 0.0);
+        } else if (lift_angle > p.lift_max) {
+            lift_angle = p.lift_max;
+            lift_omega = std::min(lift_omega, 0.0);
+        }
+
+        // Motors turn with whatever they're geared to
+        for (int port = 1; port <= PORT_COUNT; port++) {
+            SimMotor& m = motors[port];
+            if (!m.installed) continue;
+            int sign = role_sign[port];
+            switch (roles[port]) {
+                case ROLE_DRIVE_LEFT: m.omega = sign * wheel_omega[0] * p.wheel_ratio; break;
+                case ROLE_DRIVE_RIGHT: m.omega = sign * wheel_omega[1] * p.wheel_ratio; break;
+                case ROLE_INTAKE: m.omega = sign * intake_omega; break;
+                case ROLE_LIFT: m.omega = sign * lift_omega * p.lift_ratio; break;
+                case ROLE_FREE: break;
+            }
+            m.angle += m.omega * dt;
+        }
+
+        // Battery sags with the current it supplies, and runs down slowly
+        double open_voltage = p.battery_voltage - 0.8 * charge_used / p.battery_capacity;
+        battery_current = power / std::max(battery, 1.0) + 0.2;
+        battery = open_voltage - p.battery_resistance * battery_current;
+        charge_used += battery_current * dt;
+        min_battery = std::min(min_battery, battery);
+    }
+
+    time_ms++;
+
+    for (SimImu& imu : imus) {
+        if (!imu.installed) continue;
+        imu.drift += p.imu_drift / 60000.0;
+        imu.noise = std::normal_distribution<double>(0, p.imu_noise)(rng);
+    }
+
+    // Motors report every 10 ms, rotation sensors at their data rate
+    std::normal_distribution<double> encoder_noise(0, p.encoder_noise * M_PI / 180);
+    for (SimMotor& m : motors) {
+        if (!m.installed || time_ms % 10 != 0) continue;
+        m.report_time = time_ms;
+        m.report_angle = m.angle + (p.encoder_noise > 0 ? encoder_noise(rng) : 0);
+        m.report_omega = m.omega;
+        m.report_current = m.current;
+        m.report_voltage = m.voltage;
+        m.report_torque = m.torque;
+    }
+    for (SimRotation& r : rotations) {
+        if (!r.installed || time_ms % r.data_rate != 0) continue;
+        r.report_time = time_ms;
+        double noise = p.encoder_noise > 0 ? encoder_noise(rng) * 18000 / M_PI : 0;
+        r.report_position = std::lround(r.travel / (M_PI * r.wheel_diameter) * 36000 + noise);
+    }
+}
+
+}  // namespace sim
@@ -0,0 +1,195 @@
+#ifndef SIM_WORLD_HPP
+#define SIM_WORLD_HPP
+
+#include <cstdint>
+#include <random>
+
+// The simulated robot: V5 motors, the drivetrain on the floor, the mechanisms,
+// the battery and the sensors. The PROS API layer (sim_pros.cpp) reads and
+// commands the devices, step() moves everything forward 1 ms.
+//
+// Units are SI inside (m, rad, s, N, A, V), the API layer converts to what
+// PROS reports.
+
+namespace sim {
+
+constexpr int PORT_COUNT = 21;
+
+// --- Motors ---
+// A brushed DC motor behind a cartridge: V = I R + ke w at the motor,
+// torque = kt I less friction, current limited by the motor's controller.
+// Constants are for the 11 W motor at the 3600 rpm motor shaft.
+
+struct MotorConstants {
+    double resistance = 2.4;     // ohm
+    double ke = 12.0 / 377.0;    // V per rad/s, 3600 rpm free speed at 12 V
+    double kt = 0.0233;          // Nm per A, ~1.05 Nm at 2.5 A out of a green cartridge
+    double friction = 0.0015;    // Nm, coulomb
+    double rotor_inertia = 4e-6;  // kg m^2
+    double current_limit = 2.5;  // A
+    double thermal_mass = 60;    // J per C
+    double cooling = 0.25;       // W per C
+};
+
+enum MotorMode { MODE_VOLTAGE, MODE_VELOCITY, MODE_POSITION, MODE_BRAKE };
+
+struct SimMotor {
+    bool installed = false;
+    // Configuration, as set through the API
+    int gearset = 1;        // motor_gearset_e_t
+    int encoder_units = 0;  // motor_encoder_units_e_t
+    int brake_mode = 0;     // motor_brake_mode_e_t
+    double current_limit = 2.5;
+    double voltage_limit = 12;
+
+    // Command, in the motor's own direction (the API layer applies port reversal)
+    MotorMode mode = MODE_BRAKE;
+    double target_voltage = 0;   // V
+    double target_velocity = 0;  // rpm at the output
+    double target_position = 0;  // output rad
+    double profile_velocity = 0;  // rpm, for position moves
+    double hold_position = 0;    // output rad, for brake mode hold
+    double velocity_integral = 0;
+
+    // State, at the cartridge output
+    double angle = 0;  // rad
+    double omega = 0;  // rad/s
+    double current = 0;  // A
+    double voltage = 0;  // V actually applied
+    double torque = 0;   // Nm
+    double temperature = 25;  // C
+    double zero = 0;     // angle at the last tare, rad
+
+    // What the motor reports, refreshed every 10 ms like the real thing
+    std::uint32_t report_time = 0;
+    double report_angle = 0;
+    double report_omega = 0;
+    double report_current = 0;
+    double report_voltage = 0;
+    double report_torque = 0;
+
+    double ratio() const;  // cartridge reduction, 36, 18 or 6
+    double free_rpm() const { return 3600 / ratio(); }
+};
+
+// --- Devices other than motors ---
+
+struct SimImu {
+    bool installed = false;
+    std::uint32_t calibrated_at = 0;  // ms, is_calibrating until then
+    double offset = 0;  // deg, from tare/set_rotation
+    double drift = 0;   // deg accumulated
+    double noise = 0;   // deg, this millisecond's
+};
+
+struct SimRotation {
+    bool installed = false;
+    double lateral_offset = 0;  // m, left of center, for a forward facing wheel
+    bool perpendicular = false;
+    double forward_offset = 0;  // m, for a perpendicular wheel
+    double wheel_diameter = 0.0508;  // m
+    double travel = 0;  // m along the wheel
+    std::int32_t zero = 0;  // centidegrees
+    bool reversed = false;
+    std::uint32_t data_rate = 10;  // ms
+    std::uint32_t report_time = 0;
+    std::int32_t report_position = 0;  // centidegrees
+};
+
+struct SimController {
+    std::int8_t analog[4] = {};  // LEFT_X, LEFT_Y, RIGHT_X, RIGHT_Y
+    std::uint16_t buttons = 0;   // bit i is E_CONTROLLER_DIGITAL_L1 + i
+};
+
+// --- The robot ---
+
+struct RobotParams {
+    double mass = 6.8;            // kg
+    double inertia = 0.25;        // kg m^2 about the center
+    double wheel_radius = 0.0413;  // m
+    double track_width = 0.305;   // m
+    double wheel_ratio = 1.0;     // cartridge output turns per wheel turn
+    double wheel_inertia = 2.5e-4;  // kg m^2 per side, wheels and gears
+    double traction = 0.9;        // tire friction coefficient
+    double slip_stiffness = 2000;  // N per m/s of slip, before the friction limit
+    double rolling_resistance = 2.0;  // N
+    double turn_scrub = 1.2;      // Nm resisting rotation, wheels dragging sideways
+    double left_strength = 1.0;   // drive torque scale per side, worn motors and binding gears
+    double right_strength = 1.0;
+
+    double intake_inertia = 5e-4;  // kg m^2 at the motor output
+    double intake_drag = 0.02;     // Nm per rad/s
+    double lift_ratio = 5.0;       // motor output turns per arm turn
+    double lift_arm_mass = 0.8;    // kg
+    double lift_arm_length = 0.25;  // m to the center of mass
+    double lift_min = 0;           // rad, arm hard stops
+    double lift_max = 1.9;
+
+    double battery_voltage = 12.8;  // V open circuit, full
+    double battery_resistance = 0.12;  // ohm, cells and wiring
+    double battery_capacity = 1.1 * 3600;  // As
+
+    double imu_drift = 0.5;   // deg per minute
+    double imu_noise = 0.02;  // deg
+    double encoder_noise = 0;  // deg at the sensor, on every motor and rotation sensor reading
+
+    // How far off the robot is set down from the auton's start pose, field
+    // frame. The robot code still thinks it's at the start pose.
+    double start_error_x = 0;  // in
+    double start_error_y = 0;  // in
+    double start_error_theta = 0;  // deg
+};
+
+enum MotorRole { ROLE_FREE, ROLE_DRIVE_LEFT, ROLE_DRIVE_RIGHT, ROLE_INTAKE, ROLE_LIFT };
+
+struct World {
+    RobotParams params;
+    MotorConstants motor_constants;
+    SimMotor motors[PORT_COUNT + 1];  // by port, 0 unused
+    MotorRole roles[PORT_COUNT + 1] = {};
+    int role_sign[PORT_COUNT + 1] = {};  // motor direction relative to its mechanism
+    SimImu imus[PORT_COUNT + 1];
+    SimRotation rotations[PORT_COUNT + 1];
+    SimController controllers[2];
+
+    bool enabled = false;  // disabled robots get no motor power, like on the field
+    std::uint32_t time_ms = 0;
+
+    // Drivetrain, the truth the robot code is trying to estimate
+    double x = 0, y = 0, theta = 0;  // m, rad counter-clockwise
+    double velocity = 0;  // m/s forward
+    double angular_velocity = 0;  // rad/s
+    double wheel_omega[2] = {};   // left, right, rad/s
+    double slip[2] = {};          // m/s, wheel surface minus ground
+    double max_slip = 0;
+
+    // Mechanisms
+    double intake_omega = 0;
+    double lift_angle = 0, lift_omega = 0;  // arm, rad
+
+    // Battery
+    double battery = 12.8;  // V at the terminals
+    double battery_current = 0;  // A
+    double charge_used = 0;  // As
+    double min_battery = 12.8;
+
+    std::mt19937 rng{1};
+
+    // Assigns a motor to a mechanism. sign is -1 for a reversed port, so that
+    // the robot code's idea of forward matches.
+    void attach_motor(int port, MotorRole role);
+    // Starts the robot at a pose, in inches and radians like the robot code's Pose,
+    // off by the params' start error
+    void place(double x_in, double y_in, double theta_rad);
+
+    void step();  // 1 ms
+
+    double imu_rotation(const SimImu& imu) const;  // deg, clockwise like the V5 IMU
+};
+
+// Function local so the robot code's global devices can use it from their constructors
+World& world();
+
+}  // namespace sim
+
+#endif
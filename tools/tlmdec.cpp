@@ -0,0 +1,786 @@
+// tlmdec: decodes the telemetry logs the brain writes to the SD card.
+//
+//   tlmdec [-j threads] [-t from_ms:to_ms] [--csv dir] [--columns dir] <logs or directories...>
+//
+// Runs on a Linux machine with the card's tlm_NNN.v5l files (directories are
+// searched for them). Each log is memory mapped and its blocks are decoded in
+// parallel, then it's summarized and exported while later logs are still
+// decoding. The record layout and file format come from src/telemetry.hpp and
+// the decompressor from src/lz4_block.cpp, the same code the brain logs with.
+//
+//   -j           worker threads, default one per core
+//   -t           only records with from_ms <= time_ms <= to_ms (brain time),
+//                blocks outside the range are skipped using the .idx files
+//   --csv        one CSV per log and record type, <dir>/<log>_<type>.csv
+//   --columns    one raw little endian array per column, <dir>/<log>/<type>.<column>.<dtype>,
+//                listed in <dir>/<log>/columns.txt (numpy.fromfile reads them as is)
+//
+// Without --csv or --columns it only prints the summaries: record counts and
+// gaps, peak currents, drive and lift settle times, and the loop jitter histogram.
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lz4_block.hpp"
+#include "telemetry.hpp"
+
+namespace {
+
+// --- Columns ---
+
+enum ColumnKind { U32, U16, I16, F32 };
+
+struct Column {
+    const char* name;
+    ColumnKind kind;
+    std::size_t offset;  // in TelemetryRecord
+};
+
+const char* const KIND_NAMES[] = {"u32", "u16", "i16", "f32"};
+
+constexpr Column DRIVE_COLUMNS[] = {
+    {"time_ms", U32, offsetof(TelemetryRecord, time_ms)},
+    {"seq", U16, offsetof(TelemetryRecord, seq)},
+    {"x", F32, offsetof(TelemetryRecord, drive.x)},
+    {"y", F32, offsetof(TelemetryRecord, drive.y)},
+    {"theta", F32, offsetof(TelemetryRecord, drive.theta)},
+    {"left_mv", I16, offsetof(TelemetryRecord, drive.left_mv)},
+    {"right_mv", I16, offsetof(TelemetryRecord, drive.right_mv)},
+    {"left_rpm", I16, offsetof(TelemetryRecord, drive.left_rpm)},
+    {"right_rpm", I16, offsetof(TelemetryRecord, drive.right_rpm)},
+    {"left_ma", I16, offsetof(TelemetryRecord, drive.left_ma)},
+    {"right_ma", I16, offsetof(TelemetryRecord, drive.right_ma)},
+};
+
+constexpr Column MECHANISM_COLUMNS[] = {
+    {"time_ms", U32, offsetof(TelemetryRecord, time_ms)},
+    {"seq", U16, offsetof(TelemetryRecord, seq)},
+    {"intake_mv", I16, offsetof(TelemetryRecord, mechanisms.intake_mv)},
+    {"lift_mv", I16, offsetof(TelemetryRecord, mechanisms.lift_mv)},
+    {"intake_rpm", I16, offsetof(TelemetryRecord, mechanisms.intake_rpm)},
+    {"lift_rpm", I16, offsetof(TelemetryRecord, mechanisms.lift_rpm)},
+    {"intake_ma", I16, offsetof(TelemetryRecord, mechanisms.intake_ma)},
+    {"lift_ma", I16, offsetof(TelemetryRecord, mechanisms.lift_ma)},
+    {"lift_position", F32, offsetof(TelemetryRecord, mechanisms.lift_position)},
+};
+
+constexpr Column LOOP_COLUMNS[] = {
+    {"time_ms", U32, offsetof(TelemetryRecord, time_ms)},
+    {"seq", U16, offsetof(TelemetryRecord, seq)},
+    {"exec_us", U32, offsetof(TelemetryRecord, loop.exec_us)},
+    {"jitter_us", U32, offsetof(TelemetryRecord, loop.jitter_us)},
+    {"overruns", U32, offsetof(TelemetryRecord, loop.overruns)},
+    {"skipped_ticks", U32, offsetof(TelemetryRecord, loop.skipped_ticks)},
+};
+
+struct RecordTypeInfo {
+    TelemetryType type;
+    const char* name;
+    const Column* columns;
+    std::size_t column_count;
+};
+
+constexpr RecordTypeInfo RECORD_TYPES[] = {
+    {TELEMETRY_DRIVE, "drive", DRIVE_COLUMNS, std::size(DRIVE_COLUMNS)},
+    {TELEMETRY_MECHANISMS, "mechanisms", MECHANISM_COLUMNS, std::size(MECHANISM_COLUMNS)},
+    {TELEMETRY_LOOP, "loop", LOOP_COLUMNS, std::size(LOOP_COLUMNS)},
+};
+
+// Appends one field of a record as text
+char* format_field(char* out, char* end, const TelemetryRecord& record, const Column& column) {
+    const auto* field = reinterpret_cast<const std::uint8_t*>(&record) + column.offset;
+    switch (column.kind) {
+        case U32: {
+            std::uint32_t value;
+            std::memcpy(&value, field, sizeof(value));
+            return std::to_chars(out, end, value).ptr;
+        }
+        case U16: {
+            std::uint16_t value;
+            std::memcpy(&value, field, sizeof(value));
+            return std::to_chars(out, end, value).ptr;
+        }
+        case I16: {
+            std::int16_t value;
+            std::memcpy(&value, field, sizeof(value));
+            return std::to_chars(out, end, value).ptr;
+        }
+        case F32: {
+            float value;
+            std::memcpy(&value, field, sizeof(value));
+            return std::to_chars(out, end, value).ptr;
+        }
+    }
+    return out;
+}
+
+std::size_t kind_size(ColumnKind kind) {
+    return kind == U32 || kind == F32 ? 4 : 2;
+}
+
+// --- Summaries ---
+
+// Moves are found from the commanded voltage: one starts when a side goes over
+// MOVE_MV and ends once everything has been under it for IDLE_MS. The settle
+// time is from the start of the move to the last time it was outside the
+// tolerance of where it ended up.
+constexpr int MOVE_MV = 1000;
+constexpr std::uint32_t IDLE_MS = 200;
+constexpr double DRIVE_SETTLE_IN = 0.5;
+constexpr double DRIVE_SETTLE_RAD = 1.0 * M_PI / 180;
+constexpr double LIFT_SETTLE_DEG = 2.0;
+
+// Upper bounds of the jitter histogram buckets, the last bucket is everything above
+constexpr std::uint32_t JITTER_BUCKETS_US[] = {50, 100, 250, 500, 1000, 2000, 5000};
+constexpr std::size_t JITTER_BUCKET_COUNT = std::size(JITTER_BUCKETS_US) + 1;
+
+enum PeakSignal { PEAK_LEFT, PEAK_RIGHT, PEAK_INTAKE, PEAK_LIFT, PEAK_COUNT };
+const char* const PEAK_NAMES[] = {"drive left", "drive right", "intake", "lift"};
+
+struct Peak {
+    int ma = 0;
+    std::uint32_t time_ms = 0;
+    std::string log;
+};
+
+struct Summary {
+    std::uint64_t records = 0;
+    std::uint64_t by_type[4] = {};  // unknown, drive, mechanisms, loop
+    std::uint64_t seq_gaps = 0;     // records missing between those we have
+    std::uint64_t ring_dropped = 0;
+    std::uint64_t bad_blocks = 0;
+    double seconds = 0;
+
+    Peak peaks[PEAK_COUNT];
+    std::vector<float> drive_settle_ms;
+    std::vector<float> lift_settle_ms;
+
+    std::uint64_t jitter[JITTER_BUCKET_COUNT] = {};
+    std::uint32_t max_jitter_us = 0;
+    std::uint32_t max_exec_us = 0;
+    std::uint64_t total_exec_us = 0;
+    std::uint64_t overruns = 0;
+    std::uint64_t skipped_ticks = 0;
+
+    void merge(const Summary& other) {
+        records += other.records;
+        for (int i = 0; i < 4; i++) by_type[i] += other.by_type[i];
+        seq_gaps += other.seq_gaps;
+        ring_dropped += other.ring_dropped;
+        bad_blocks += other.bad_blocks;
+        seconds += other.seconds;
+        for (int i = 0; i < PEAK_COUNT; i++) {
+            if (std::abs(other.peaks[i].ma) > std::abs(peaks[i].ma)) peaks[i] = other.peaks[i];
+        }
+        drive_settle_ms.insert(drive_settle_ms.end(), other.drive_settle_ms.begin(), other.drive_settle_ms.end());
+        lift_settle_ms.insert(lift_settle_ms.end(), other.lift_settle_ms.begin(), other.lift_settle_ms.end());
+        for (std::size_t i = 0; i < JITTER_BUCKET_COUNT; i++) jitter[i] += other.jitter[i];
+        max_jitter_us = std::max(max_jitter_us, other.max_jitter_us);
+        max_exec_us = std::max(max_exec_us, other.max_exec_us);
+        total_exec_us += other.total_exec_us;
+        overruns += other.overruns;
+        skipped_ticks += other.skipped_ticks;
+    }
+};
+
+// Counters that only go up until the loop's stats are reset, summed across resets
+std::uint64_t counter_increase(std::uint32_t previous, std::uint32_t current) {
+    return current >= previous ? current - previous : current;
+}
+
+template <typename Active, typename Outside>
+void find_settles(const std::vector<const TelemetryRecord*>& samples, Active active, Outside outside,
+                  std::vector<float>& settle_ms) {
+    std::size_t start = 0, last_active = 0;
+    bool moving = false;
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        if (active(*samples[i])) {
+            if (!moving) start = i;
+            moving = true;
+            last_active = i;
+            continue;
+        }
+        if (!moving || samples[i]->time_ms - samples[last_active]->time_ms < IDLE_MS) continue;
+
+        moving = false;
+        const TelemetryRecord& final = *samples[i];
+        std::size_t settled = start;
+        for (std::size_t j = i; j > start; j--) {
+            if (outside(*samples[j - 1], final)) {
+                settled = j;
+                break;
+            }
+        }
+        settle_ms.push_back(samples[settled]->time_ms - samples[start]->time_ms);
+    }
+}
+
+void note_peak(Peak& peak, int ma, std::uint32_t time_ms, const std::string& log) {
+    if (std::abs(ma) <= std::abs(peak.ma)) return;
+    peak.ma = ma;
+    peak.time_ms = time_ms;
+    peak.log = log;
+}
+
+// --- Logs ---
+
+struct BlockRef {
+    std::size_t offset;  // of the block header
+    std::uint32_t record_count;
+};
+
+struct LogFile {
+    std::string path;
+    std::string name;  // file name without the extension
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    TelemetryFileHeader header = {};
+
+    std::vector<BlockRef> blocks;      // the ones to decode
+    std::vector<std::size_t> first;    // first record of each block in records
+    std::size_t record_count = 0;
+    std::uint32_t ring_dropped = 0;
+    std::vector<TelemetryRecord> records;  // allocated by the first job to start on it
+    std::once_flag allocated;
+    std::atomic<std::size_t> jobs_left{0};
+    std::atomic<std::uint32_t> bad_blocks{0};
+
+    Summary summary;
+    bool ok = false;
+};
+
+struct Options {
+    unsigned threads = 0;
+    bool time_range = false;
+    std::uint32_t from_ms = 0, to_ms = 0;
+    std::string csv_dir;
+    std::string columns_dir;
+};
+
+Options options;
+std::mutex print_mutex;
+
+void warn(const std::string& message) {
+    std::lock_guard<std::mutex> lock(print_mutex);
+    std::fprintf(stderr, "tlmdec: %s\n", message.c_str());
+}
+
+[[noreturn]] void fail(const std::string& message) {
+    std::fprintf(stderr, "tlmdec: %s\n", message.c_str());
+    std::exit(1);
+}
+
+bool in_range(std::uint32_t first_ms, std::uint32_t last_ms) {
+    return !options.time_range || (last_ms >= options.from_ms && first_ms <= options.to_ms);
+}
+
+TelemetryBlockHeader block_header_at(const LogFile& log, std::size_t offset) {
+    TelemetryBlockHeader header;
+    std::memcpy(&header, log.data + offset, sizeof(header));
+    return header;
+}
+
+// Payload bytes after a block header. v1 blocks were always a full block.
+std::size_t stored_size(const LogFile& log, const TelemetryBlockHeader& header) {
+    if (log.header.format_version < 2) return TELEMETRY_BLOCK_SIZE - sizeof(TelemetryBlockHeader);
+    return header.stored_size;
+}
+
+bool block_fits(const LogFile& log, std::size_t offset, const TelemetryBlockHeader& header) {
+    return header.magic == TELEMETRY_BLOCK_MAGIC && header.record_count <= TELEMETRY_RECORDS_PER_BLOCK &&
+           stored_size(log, header) <= log.size - offset - sizeof(header);
+}
+
+void select_block(LogFile& log, std::size_t offset, const TelemetryBlockHeader& header) {
+    log.ring_dropped = std::max(log.ring_dropped, header.dropped);
+    if (!in_range(header.first_time_ms, header.last_time_ms) || header.record_count == 0) return;
+    log.blocks.push_back({offset, header.record_count});
+}
+
+// Block list from the .idx next to the log. Any entry that doesn't point at a
+// good block means the index can't be trusted, the caller walks the log instead.
+bool read_index(LogFile& log) {
+    std::string index_path = log.path.substr(0, log.path.rfind('.')) + ".idx";
+    std::FILE* in = std::fopen(index_path.c_str(), "rb");
+    if (in == nullptr) return false;
+
+    std::vector<TelemetryIndexEntry> entries;
+    TelemetryIndexEntry entry;
+    while (std::fread(&entry, sizeof(entry), 1, in) == 1) entries.push_back(entry);
+    std::fclose(in);
+
+    for (const TelemetryIndexEntry& e : entries) {
+        if (e.offset < TELEMETRY_FILE_HEADER_SIZE || e.offset > log.size - sizeof(TelemetryBlockHeader)) return false;
+        TelemetryBlockHeader header = block_header_at(log, e.offset);
+        if (!block_fits(log, e.offset, header) || header.index != e.block) return false;
+    }
+
+    // Only the headers of the blocks in range get touched
+    for (const TelemetryIndexEntry& e : entries) {
+        if (!in_range(e.first_time_ms, e.last_time_ms)) continue;
+        select_block(log, e.offset, block_header_at(log, e.offset));
+    }
+    return true;
+}
+
+void walk_blocks(LogFile& log) {
+    std::size_t offset = TELEMETRY_FILE_HEADER_SIZE;
+    while (offset + sizeof(TelemetryBlockHeader) <= log.size) {
+        TelemetryBlockHeader header = block_header_at(log, offset);
+        if (!block_fits(log, offset, header)) {
+            // Usually the brain lost power partway through a write
+            warn(log.path + ": no good block at offset " + std::to_string(offset) + ", ignoring the rest");
+            return;
+        }
+        select_block(log, offset, header);
+        offset += sizeof(header) + stored_size(log, header);
+    }
+}
+
+bool open_log(LogFile& log) {
+    int fd = ::open(log.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        warn("can't open " + log.path);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < TELEMETRY_FILE_HEADER_SIZE) {
+        ::close(fd);
+        warn(log.path + ": too short to be a log");
+        return false;
+    }
+    log.size = st.st_size;
+    void* mapped = ::mmap(nullptr, log.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        warn("can't map " + log.path);
+        return false;
+    }
+    log.data = static_cast<const std::uint8_t*>(mapped);
+    ::madvise(mapped, log.size, MADV_WILLNEED);
+
+    std::memcpy(&log.header, log.data, sizeof(log.header));
+    if (log.header.magic != TELEMETRY_FILE_MAGIC) {
+        warn(log.path + ": not a telemetry log");
+        return false;
+    }
+    // Records are read straight into TelemetryRecord, so the writer's schema has to be ours
+    if (log.header.schema_version != TELEMETRY_SCHEMA_VERSION || log.header.record_size != sizeof(TelemetryRecord)) {
+        warn(log.path + ": schema v" + std::to_string(log.header.schema_version) + ", this tlmdec reads v" +
+             std::to_string(TELEMETRY_SCHEMA_VERSION));
+        return false;
+    }
+    if (log.header.format_version > TELEMETRY_FORMAT_VERSION) {
+        warn(log.path + ": format v" + std::to_string(log.header.format_version) + " is newer than this tlmdec");
+        return false;
+    }
+
+    if (!read_index(log)) {
+        log.blocks.clear();
+        log.ring_dropped = 0;
+        walk_blocks(log);
+    }
+
+    log.first.reserve(log.blocks.size());
+    for (const BlockRef& block : log.blocks) {
+        log.first.push_back(log.record_count);
+        log.record_count += block.record_count;
+    }
+    return true;
+}
+
+void close_log(LogFile& log) {
+    if (log.data != nullptr) ::munmap(const_cast<std::uint8_t*>(log.data), log.size);
+    log.data = nullptr;
+    std::vector<TelemetryRecord>().swap(log.records);
+}
+
+// Decodes one block into out. A bad block leaves its records zeroed (type 0),
+// the summaries and exports skip those.
+bool decode_block(const LogFile& log, const BlockRef& block, TelemetryRecord* out) {
+    TelemetryBlockHeader header = block_header_at(log, block.offset);
+    const std::uint8_t* payload = log.data + block.offset + sizeof(header);
+    std::size_t stored = stored_size(log, header);
+    std::size_t raw = header.record_count * sizeof(TelemetryRecord);
+
+    thread_local std::uint8_t unpacked[TELEMETRY_BLOCK_SIZE];
+    const std::uint8_t* records = payload;
+    if (header.flags & TELEMETRY_BLOCK_LZ4) {
+        if (raw > sizeof(unpacked) || lz4_decompress(payload, stored, unpacked, raw) < 0) return false;
+        records = unpacked;
+    } else if (stored < raw) {
+        return false;
+    }
+
+    if (header.flags & TELEMETRY_BLOCK_SHUFFLED) {
+        telemetry_unshuffle(records, out, header.record_count);
+    } else {
+        std::memcpy(static_cast<void*>(out), records, raw);
+    }
+    return true;
+}
+
+void summarize(LogFile& log) {
+    Summary& s = log.summary;
+    s.ring_dropped = log.ring_dropped;
+    s.bad_blocks = log.bad_blocks;
+
+    std::vector<const TelemetryRecord*> drive, mechanisms;
+    const TelemetryRecord* previous_loop = nullptr;
+    // First and last records of a known type, set together so both are null or neither
+    const TelemetryRecord* first = nullptr;
+    const TelemetryRecord* previous = nullptr;
+    // Each producer (driver control loop, autonomous sampler) numbers its records on its own
+    const TelemetryRecord* previous_of[2] = {};
+    for (const TelemetryRecord& r : log.records) {
+        if (r.type < TELEMETRY_DRIVE || r.type > TELEMETRY_LOOP) {
+            s.by_type[0]++;
+            continue;
+        }
+        s.records++;
+        s.by_type[r.type]++;
+        const TelemetryRecord*& previous_same = previous_of[(r.flags & TELEMETRY_FLAG_AUTON) ? 1 : 0];
+        if (previous_same != nullptr) s.seq_gaps += static_cast<std::uint16_t>(r.seq - previous_same->seq - 1);
+        previous_same = &r;
+        if (first == nullptr) first = &r;
+        previous = &r;
+
+        switch (r.type) {
+            case TELEMETRY_DRIVE:
+                drive.push_back(&r);
+                note_peak(s.peaks[PEAK_LEFT], r.drive.left_ma, r.time_ms, log.name);
+                note_peak(s.peaks[PEAK_RIGHT], r.drive.right_ma, r.time_ms, log.name);
+                break;
+            case TELEMETRY_MECHANISMS:
+                mechanisms.push_back(&r);
+                note_peak(s.peaks[PEAK_INTAKE], r.mechanisms.intake_ma, r.time_ms, log.name);
+                note_peak(s.peaks[PEAK_LIFT], r.mechanisms.lift_ma, r.time_ms, log.name);
+                break;
+            case TELEMETRY_LOOP: {
+                std::size_t bucket = 0;
+                while (bucket < std::size(JITTER_BUCKETS_US) && r.loop.jitter_us > JITTER_BUCKETS_US[bucket]) bucket++;
+                s.jitter[bucket]++;
+                s.max_jitter_us = std::max(s.max_jitter_us, r.loop.jitter_us);
+                s.max_exec_us = std::max(s.max_exec_us, r.loop.exec_us);
+                s.total_exec_us += r.loop.exec_us;
+                if (previous_loop != nullptr) {
+                    s.overruns += counter_increase(previous_loop->loop.overruns, r.loop.overruns);
+                    s.skipped_ticks += counter_increase(previous_loop->loop.skipped_ticks, r.loop.skipped_ticks);
+                }
+                previous_loop = &r;
+                break;
+            }
+        }
+    }
+
+    if (first != nullptr) s.seconds = (previous->time_ms - first->time_ms) / 1000.0;
+
+    find_settles(
+        drive,
+        [](const TelemetryRecord& r) { return std::abs(r.drive.left_mv) > MOVE_MV || std::abs(r.drive.right_mv) > MOVE_MV; },
+        [](const TelemetryRecord& r, const TelemetryRecord& final) {
+            return std::hypot(r.drive.x - final.drive.x, r.drive.y - final.drive.y) > DRIVE_SETTLE_IN ||
+                   std::fabs(std::remainder(r.drive.theta - final.drive.theta, 2 * M_PI)) > DRIVE_SETTLE_RAD;
+        },
+        s.drive_settle_ms);
+    find_settles(
+        mechanisms, [](const TelemetryRecord& r) { return std::abs(r.mechanisms.lift_mv) > MOVE_MV; },
+        [](const TelemetryRecord& r, const TelemetryRecord& final) {
+            return std::fabs(r.mechanisms.lift_position - final.mechanisms.lift_position) > LIFT_SETTLE_DEG;
+        },
+        s.lift_settle_ms);
+}
+
+// --- Exports ---
+
+void write_csv(const LogFile& log, const RecordTypeInfo& type) {
+    std::string path = options.csv_dir + "/" + log.name + "_" + type.name + ".csv";
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        warn("can't write " + path);
+        return;
+    }
+
+    for (std::size_t c = 0; c < type.column_count; c++) {
+        std::fprintf(out, "%s%s", c ? "," : "", type.columns[c].name);
+    }
+    std::fputc('\n', out);
+
+    // Formatted into a big buffer with to_chars, printf would be most of the run time
+    std::vector<char> buffer(1 << 20);
+    char* end = buffer.data() + buffer.size();
+    char* p = buffer.data();
+    for (const TelemetryRecord& r : log.records) {
+        if (r.type != type.type) continue;
+        if (end - p < 512) {
+            std::fwrite(buffer.data(), 1, p - buffer.data(), out);
+            p = buffer.data();
+        }
+        for (std::size_t c = 0; c < type.column_count; c++) {
+            if (c) *p++ = ',';
+            p = format_field(p, end, r, type.columns[c]);
+        }
+        *p++ = '\n';
+    }
+    std::fwrite(buffer.data(), 1, p - buffer.data(), out);
+    if (std::fclose(out) != 0) warn("error writing " + path);
+}
+
+void write_columns(const LogFile& log) {
+    std::string dir = options.columns_dir + "/" + log.name;
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    std::FILE* listing = std::fopen((dir + "/columns.txt").c_str(), "w");
+    if (listing == nullptr) {
+        warn("can't write " + dir + "/columns.txt");
+        return;
+    }
+    std::fprintf(listing, "# type column dtype rows, one little endian array per file\n");
+
+    std::vector<std::uint8_t> column;
+    for (const RecordTypeInfo& type : RECORD_TYPES) {
+        std::size_t rows = 0;
+        for (const TelemetryRecord& r : log.records) rows += r.type == type.type;
+
+        for (std::size_t c = 0; c < type.column_count; c++) {
+            const Column& col = type.columns[c];
+            std::size_t size = kind_size(col.kind);
+            column.resize(rows * size);
+            std::uint8_t* p = column.data();
+            for (const TelemetryRecord& r : log.records) {
+                if (r.type != type.type) continue;
+                std::memcpy(p, reinterpret_cast<const std::uint8_t*>(&r) + col.offset, size);
+                p += size;
+            }
+
+            std::string file = std::string(type.name) + "." + col.name + "." + KIND_NAMES[col.kind];
+            std::FILE* out = std::fopen((dir + "/" + file).c_str(), "wb");
+            if (out == nullptr || std::fwrite(column.data(), 1, column.size(), out) != column.size()) {
+                warn("can't write " + dir + "/" + file);
+            }
+            if (out != nullptr) std::fclose(out);
+            std::fprintf(listing, "%s %s %s %zu\n", type.name, col.name, KIND_NAMES[col.kind], rows);
+        }
+    }
+    std::fclose(listing);
+}
+
+// Done by whichever worker decodes the log's last chunk
+void finish_log(LogFile& log) {
+    // The logger drains the autonomous and driver rings one after the other, so
+    // a block can hold both out of order. Each producer's own records are in order.
+    std::stable_sort(log.records.begin(), log.records.end(),
+                     [](const TelemetryRecord& a, const TelemetryRecord& b) { return a.time_ms < b.time_ms; });
+    if (options.time_range) {
+        std::erase_if(log.records, [](const TelemetryRecord& r) {
+            return r.time_ms < options.from_ms || r.time_ms > options.to_ms;
+        });
+    }
+    summarize(log);
+    if (!options.csv_dir.empty()) {
+        for (const RecordTypeInfo& type : RECORD_TYPES) write_csv(log, type);
+    }
+    if (!options.columns_dir.empty()) write_columns(log);
+    close_log(log);
+}
+
+// --- Parallel decode ---
+// Work is handed out in chunks of blocks, in log order, so the first logs are
+// finished and freed while the later ones are still decoding.
+
+constexpr std::size_t BLOCKS_PER_JOB = 64;
+
+struct Job {
+    LogFile* log;
+    std::size_t first_block, end_block;
+};
+
+std::vector<Job> jobs;
+std::atomic<std::size_t> next_job{0};
+
+void worker() {
+    while (true) {
+        std::size_t j = next_job.fetch_add(1);
+        if (j >= jobs.size()) return;
+        Job& job = jobs[j];
+        LogFile& log = *job.log;
+        std::call_once(log.allocated, [&] { log.records.resize(log.record_count); });
+
+        for (std::size_t b = job.first_block; b < job.end_block; b++) {
+            if (!decode_block(log, log.blocks[b], &log.records[log.first[b]])) {
+                log.bad_blocks++;
+                warn(log.path + ": block at offset " + std::to_string(log.blocks[b].offset) + " doesn't decode");
+            }
+        }
+        if (log.jobs_left.fetch_sub(1) == 1) finish_log(log);
+    }
+}
+
+// --- Output ---
+
+void print_settles(const char* name, std::vector<float> settles) {
+    if (settles.empty()) {
+        std::printf("%s settle: no moves\n", name);
+        return;
+    }
+    auto percentile = [&](double p) {
+        std::size_t k = static_cast<std::size_t>(p * (settles.size() - 1));
+        std::nth_element(settles.begin(), settles.begin() + k, settles.end());
+        return settles[k];
+    };
+    std::printf("%s settle: %zu moves, median %.0f ms, p90 %.0f ms, max %.0f ms\n", name, settles.size(),
+                percentile(0.5), percentile(0.9), percentile(1.0));
+}
+
+void print_summary(const Summary& s, std::size_t log_count) {
+    std::printf("\n%zu logs, %.1f min, %llu records (%llu drive, %llu mechanisms, %llu loop)\n", log_count,
+                s.seconds / 60, (unsigned long long)s.records, (unsigned long long)s.by_type[TELEMETRY_DRIVE],
+                (unsigned long long)s.by_type[TELEMETRY_MECHANISMS], (unsigned long long)s.by_type[TELEMETRY_LOOP]);
+    std::printf("missing: %llu records by sequence gaps, %llu dropped from the ring, %llu bad blocks\n",
+                (unsigned long long)s.seq_gaps, (unsigned long long)s.ring_dropped, (unsigned long long)s.bad_blocks);
+
+    std::printf("peak current:\n");
+    for (int i = 0; i < PEAK_COUNT; i++) {
+        const Peak& peak = s.peaks[i];
+        if (peak.log.empty()) continue;
+        std::printf("  %-12s %6d mA  (%s at %.2f s)\n", PEAK_NAMES[i], peak.ma, peak.log.c_str(), peak.time_ms / 1000.0);
+    }
+
+    print_settles("drive", s.drive_settle_ms);
+    print_settles("lift", s.lift_settle_ms);
+
+    std::uint64_t ticks = s.by_type[TELEMETRY_LOOP];
+    if (ticks == 0) return;
+    std::printf("loop: exec avg %.0f us max %u us, jitter max %u us, %llu overruns, %llu skipped ticks\n",
+                (double)s.total_exec_us / ticks, s.max_exec_us, s.max_jitter_us,
+                (unsigned long long)s.overruns, (unsigned long long)s.skipped_ticks);
+    std::printf("loop jitter:\n");
+    for (std::size_t i = 0; i < JITTER_BUCKET_COUNT; i++) {
+        char label[32];
+        if (i < std::size(JITTER_BUCKETS_US)) {
+            std::snprintf(label, sizeof(label), "<= %u us", JITTER_BUCKETS_US[i]);
+        } else {
+            std::snprintf(label, sizeof(label), "> %u us", JITTER_BUCKETS_US[i - 1]);
+        }
+        double share = (double)s.jitter[i] / ticks;
+        std::printf("  %-10s %6.2f%% %-40s %llu\n", label, share * 100, std::string(std::lround(share * 40), '#').c_str(),
+                    (unsigned long long)s.jitter[i]);
+    }
+}
+
+void add_logs(const std::string& arg, std::vector<std::string>& paths) {
+    std::error_code error;
+    if (!std::filesystem::is_directory(arg, error)) {
+        // So tlm_* works, the index files are found from their logs
+        if (std::filesystem::path(arg).extension() != ".idx") paths.push_back(arg);
+        return;
+    }
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(arg, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".v5l") paths.push_back(entry.path().string());
+    }
+}
+
+bool parse_range(const std::string& text) {
+    std::size_t colon = text.find(':');
+    if (colon == std::string::npos) return false;
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    return std::from_chars(begin, begin + colon, options.from_ms).ec == std::errc() &&
+           std::from_chars(begin + colon + 1, end, options.to_ms).ec == std::errc();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            if (!parse_range(argv[++i])) fail("-t wants from_ms:to_ms");
+            options.time_range = true;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csv_dir = argv[++i];
+        } else if (arg == "--columns" && i + 1 < argc) {
+            options.columns_dir = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            fail("usage: tlmdec [-j threads] [-t from_ms:to_ms] [--csv dir] [--columns dir] <logs or directories...>");
+        } else {
+            add_logs(arg, paths);
+        }
+    }
+    if (paths.empty()) fail("no logs given");
+    std::sort(paths.begin(), paths.end());
+    if (!options.csv_dir.empty()) std::filesystem::create_directories(options.csv_dir);
+    if (!options.columns_dir.empty()) std::filesystem::create_directories(options.columns_dir);
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<LogFile> logs(paths.size());
+    std::uint64_t stored_bytes = 0;
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        LogFile& log = logs[i];
+        log.path = paths[i];
+        std::string file = std::filesystem::path(log.path).filename().string();
+        log.name = file.substr(0, file.rfind('.'));
+        log.ok = open_log(log);
+        if (!log.ok) {
+            close_log(log);
+            continue;
+        }
+        stored_bytes += log.size;
+
+        std::size_t job_count = (log.blocks.size() + BLOCKS_PER_JOB - 1) / BLOCKS_PER_JOB;
+        log.jobs_left = job_count;
+        for (std::size_t b = 0; b < log.blocks.size(); b += BLOCKS_PER_JOB) {
+            jobs.push_back({&log, b, std::min(b + BLOCKS_PER_JOB, log.blocks.size())});
+        }
+        if (job_count == 0) {
+            summarize(log);
+            close_log(log);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < options.threads; t++) threads.emplace_back(worker);
+    for (std::thread& t : threads) t.join();
+
+    Summary total;
+    std::size_t good_logs = 0;
+    for (const LogFile& log : logs) {
+        if (!log.ok) continue;
+        good_logs++;
+        const Summary& s = log.summary;
+        std::printf("%s: %.1f s, %llu records, %llu missing, %llu bad blocks, %zu drive moves\n", log.name.c_str(),
+                    s.seconds, (unsigned long long)s.records, (unsigned long long)s.seq_gaps,
+                    (unsigned long long)s.bad_blocks, s.drive_settle_ms.size());
+        total.merge(s);
+    }
+    print_summary(total, good_logs);
+
+    double took = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double unpacked = (double)(total.records + total.by_type[0]) * sizeof(TelemetryRecord);
+    std::fprintf(stderr, "tlmdec: %.1f MB of logs (%.1f MB unpacked) in %.2f s on %u threads\n", stored_bytes / 1e6,
+                 unpacked / 1e6, took, options.threads);
+    return 0;
+}
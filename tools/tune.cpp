@@ -0,0 +1,579 @@
+// tune: searches robot code parameters by running autons in the simulator on every core.
+//
+//   tune [-j threads] [--sim path] [-o header] <spec.tune>
+//
+// Each candidate setting runs every auton in the spec through bin/host/sim
+// (tools/sim_main.cpp) with --set, one sim process per run (run_sim.hpp).
+// Candidates are ranked by cost, lower is better:
+//
+//   per auton  seconds * time weight + inches off the target * distance weight
+//              (+ degrees off the target heading * heading weight, if given)
+//   an auton that doesn't finish in 15 s costs 25 s plus its distance
+//
+// Before searching, each param is tried at both ends of its range on its own, and
+// tune warns about any that leaves the cost where it was.
+//
+// The best setting is written as a header of assignments; include it once and
+// call apply_tuned_params() at the top of initialize().
+//
+// Spec format, one directive per line, # starts a comment:
+//   auton <n> <x> <y> [heading deg]   auton (selector number) and where it should end, in field inches
+//   param <name> <low> <high>         parameter to search, see sim --list-params
+//   set <name> <value>                fixed for every run, e.g. set sim.mass 7.5
+//   search grid <points per param>    every combination
+//   search random <candidates>        uniform in the box
+//   search cmaes <candidates>         CMA-ES from the current values, the default (1000)
+//   score <per s> <per in> [<per deg>]  cost weights, default 1 0.5 0.05
+//   seed <n>
+//
+//   -j     worker threads, default one per core
+//   --sim  simulator binary, default sim next to this one
+//   -o     header to write, default src/tuned_params.hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "run_sim.hpp"
+
+namespace {
+
+constexpr double DNF_SECONDS = 25;
+
+struct AutonTarget {
+    int auton;
+    double x, y;
+    double heading = NAN;  // degrees counter-clockwise, NAN = don't care
+};
+
+struct ParamRange {
+    std::string name;
+    double low, high;
+    double current = NAN;  // the robot code's value now, from sim --list-params
+};
+
+struct Spec {
+    std::vector<AutonTarget> autons;
+    std::vector<ParamRange> params;
+    std::vector<std::string> fixed;  // name=value
+    std::string search = "cmaes";
+    int budget = 1000;               // candidates, or grid points per param
+    double time_weight = 1, distance_weight = 0.5, heading_weight = 0.05;
+    unsigned seed = 1;
+};
+
+struct Options {
+    unsigned threads = 0;
+    std::string sim_path;
+    std::string out_path = "src/tuned_params.hpp";
+    std::string spec_path;
+} options;
+
+struct Candidate {
+    std::vector<double> values;  // one per spec param, in real units
+    std::vector<SimResult> runs;  // one per spec auton
+    double cost = INFINITY;
+};
+
+Spec spec;
+
+[[noreturn]] void fail(const std::string& message) {
+    std::fprintf(stderr, "tune: %s\n", message.c_str());
+    std::exit(1);
+}
+
+Spec parse(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) fail("can't open " + filename);
+
+    Spec def;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string directive;
+        if (!(fields >> directive)) continue;
+        auto bad = [&](const char* what) {
+            fail(filename + ":" + std::to_string(line_number) + ": " + what);
+        };
+
+        if (directive == "auton") {
+            AutonTarget target;
+            if (!(fields >> target.auton >> target.x >> target.y)) bad("auton wants <n> <x> <y> [heading]");
+            double heading;
+            if (fields >> heading) target.heading = heading;
+            def.autons.push_back(target);
+        } else if (directive == "param") {
+            ParamRange range;
+            if (!(fields >> range.name >> range.low >> range.high) || range.low >= range.high) {
+                bad("param wants <name> <low> <high>, low below high");
+            }
+            if (range.name.starts_with("sim.")) bad("sim.* parameters are physics, fix them with set instead");
+            def.params.push_back(range);
+        } else if (directive == "set") {
+            std::string name, value;
+            if (!(fields >> name >> value)) bad("set wants <name> <value>");
+            def.fixed.push_back(name + "=" + value);
+        } else if (directive == "search") {
+            if (!(fields >> def.search >> def.budget) || def.budget < 1) bad("search wants grid|random|cmaes <count>");
+            if (def.search != "grid" && def.search != "random" && def.search != "cmaes") bad("unknown search");
+        } else if (directive == "score") {
+            if (!(fields >> def.time_weight >> def.distance_weight)) bad("score wants <per s> <per in> [<per deg>]");
+            fields >> def.heading_weight;
+        } else if (directive == "seed") {
+            if (!(fields >> def.seed)) bad("seed wants a number");
+        } else {
+            bad("unknown directive");
+        }
+    }
+    if (def.autons.empty()) fail(filename + ": no autons to run");
+    if (def.params.empty()) fail(filename + ": no params to search");
+    return def;
+}
+
+// --- Running the simulator ---
+
+std::string format_value(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    return text;
+}
+
+SimResult simulate(const AutonTarget& target, const std::vector<double>& values) {
+    std::vector<std::string> args = {options.sim_path, "--auton", std::to_string(target.auton)};
+    for (const std::string& fixed : spec.fixed) {
+        args.push_back("--set");
+        args.push_back(fixed);
+    }
+    for (std::size_t i = 0; i < spec.params.size(); i++) {
+        args.push_back("--set");
+        args.push_back(spec.params[i].name + "=" + format_value(values[i]));
+    }
+    return run_sim(args);
+}
+
+double heading_error_deg(double target_deg, double theta) {
+    double error = std::remainder(target_deg - theta * 180 / M_PI, 360.0);
+    return std::fabs(error);
+}
+
+double run_cost(const AutonTarget& target, const SimResult& run) {
+    if (!run.ok) return INFINITY;
+    double seconds = run.finished ? run.time_ms / 1000 : DNF_SECONDS;
+    double cost = spec.time_weight * seconds + spec.distance_weight * std::hypot(run.x - target.x, run.y - target.y);
+    if (!std::isnan(target.heading)) cost += spec.heading_weight * heading_error_deg(target.heading, run.theta);
+    return cost;
+}
+
+// Runs every candidate's autons across the worker threads, each job writes only its own slot
+void evaluate(std::vector<Candidate>& batch) {
+    std::size_t auton_count = spec.autons.size();
+    for (Candidate& candidate : batch) candidate.runs.assign(auton_count, SimResult{});
+    parallel_for(batch.size() * auton_count, options.threads, [&](std::size_t job) {
+        Candidate& candidate = batch[job / auton_count];
+        candidate.runs[job % auton_count] = simulate(spec.autons[job % auton_count], candidate.values);
+    });
+
+    for (Candidate& candidate : batch) {
+        candidate.cost = 0;
+        for (std::size_t a = 0; a < auton_count; a++) candidate.cost += run_cost(spec.autons[a], candidate.runs[a]);
+    }
+}
+
+// --- Searches ---
+// All of them work in the unit box, 0..1 across each param's range
+
+std::vector<double> to_values(const std::vector<double>& unit) {
+    std::vector<double> values(unit.size());
+    for (std::size_t i = 0; i < unit.size(); i++) {
+        const ParamRange& p = spec.params[i];
+        values[i] = p.low + std::clamp(unit[i], 0.0, 1.0) * (p.high - p.low);
+    }
+    return values;
+}
+
+std::vector<Candidate> all_candidates;
+std::size_t runs_done = 0;
+std::chrono::steady_clock::time_point start_time;
+
+void run_batch(std::vector<Candidate>& batch) {
+    evaluate(batch);
+    runs_done += batch.size() * spec.autons.size();
+    all_candidates.insert(all_candidates.end(), batch.begin(), batch.end());
+    double best = INFINITY;
+    for (const Candidate& c : all_candidates) best = std::min(best, c.cost);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::fprintf(stderr, "\rtune: %zu candidates, %zu runs, %.1f runs/s, best cost %.3f   ", all_candidates.size(),
+                 runs_done, runs_done / elapsed, best);
+}
+
+void grid_search() {
+    std::size_t dims = spec.params.size();
+    int points = std::max(2, spec.budget);
+    double total = std::pow(points, dims);
+    if (total > 1e6) fail("grid of " + std::to_string(points) + "^" + std::to_string(dims) + " is too big");
+
+    std::vector<int> index(dims, 0);
+    std::vector<Candidate> batch;
+    while (true) {
+        std::vector<double> unit(dims);
+        for (std::size_t i = 0; i < dims; i++) unit[i] = index[i] / double(points - 1);
+        batch.push_back({to_values(unit), {}, INFINITY});
+        if (batch.size() == 256) {
+            run_batch(batch);
+            batch.clear();
+        }
+
+        std::size_t d = 0;
+        while (d < dims && ++index[d] == points) index[d++] = 0;
+        if (d == dims) break;
+    }
+    if (!batch.empty()) run_batch(batch);
+}
+
+void random_search(std::mt19937& rng) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    int left = spec.budget;
+    while (left > 0) {
+        std::vector<Candidate> batch;
+        for (int i = 0; i < std::min(left, 256); i++) {
+            std::vector<double> unit(spec.params.size());
+            for (double& u : unit) u = uniform(rng);
+            batch.push_back({to_values(unit), {}, INFINITY});
+        }
+        left -= batch.size();
+        run_batch(batch);
+    }
+}
+
+using Matrix = std::vector<std::vector<double>>;
+
+// Eigen decomposition of a small symmetric matrix by Jacobi rotations:
+// a = v diag(eigenvalues) v^T, eigenvectors in v's columns
+void symmetric_eigen(Matrix a, Matrix& v, std::vector<double>& eigenvalues) {
+    std::size_t n = a.size();
+    v.assign(n, std::vector<double>(n, 0));
+    for (std::size_t i = 0; i < n; i++) v[i][i] = 1;
+
+    for (int sweep = 0; sweep < 100; sweep++) {
+        double off = 0;
+        for (std::size_t p = 0; p < n; p++) {
+            for (std::size_t q = p + 1; q < n; q++) off += a[p][q] * a[p][q];
+        }
+        if (off < 1e-30) break;
+
+        for (std::size_t p = 0; p < n; p++) {
+            for (std::size_t q = p + 1; q < n; q++) {
+                if (std::fabs(a[p][q]) < 1e-300) continue;
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (theta >= 0 ? 1 : -1) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1), s = t * c;
+                for (std::size_t k = 0; k < n; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (std::size_t k = 0; k < n; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (std::size_t k = 0; k < n; k++) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    eigenvalues.resize(n);
+    for (std::size_t i = 0; i < n; i++) eigenvalues[i] = a[i][i];
+}
+
+// CMA-ES (Hansen's (mu/mu_w, lambda) with rank-one and rank-mu updates), starting
+// at the robot code's current values. The population is at least one per worker
+// so every generation keeps all the cores busy.
+void cmaes_search(std::mt19937& rng) {
+    const std::size_t n = spec.params.size();
+    const int lambda = std::max<int>(4 + int(3 * std::log(double(n))), options.threads);
+    const int mu = lambda / 2;
+
+    std::vector<double> weights(mu);
+    for (int i = 0; i < mu; i++) weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+    double weight_sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    for (double& w : weights) w /= weight_sum;
+    double mueff = 0;
+    for (double w : weights) mueff += w * w;
+    mueff = 1 / mueff;
+
+    const double cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+    const double cs = (mueff + 2) / (n + mueff + 5);
+    const double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+    const double cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) / ((n + 2) * (n + 2) + mueff));
+    const double damps = 1 + 2 * std::max(0.0, std::sqrt((mueff - 1) / (n + 1)) - 1) + cs;
+    const double chi_n = std::sqrt(double(n)) * (1 - 1.0 / (4 * n) + 1.0 / (21.0 * n * n));
+
+    std::vector<double> mean(n);
+    for (std::size_t i = 0; i < n; i++) {
+        const ParamRange& p = spec.params[i];
+        mean[i] = std::isnan(p.current) ? 0.5 : std::clamp((p.current - p.low) / (p.high - p.low), 0.0, 1.0);
+    }
+    double sigma = 0.3;
+    std::vector<double> pc(n, 0), ps(n, 0), scale(n, 1);
+    Matrix cov(n, std::vector<double>(n, 0)), basis(n, std::vector<double>(n, 0));
+    for (std::size_t i = 0; i < n; i++) cov[i][i] = basis[i][i] = 1;
+
+    std::normal_distribution<double> normal(0, 1);
+    int left = spec.budget;
+    for (int generation = 0; left > 0; generation++) {
+        std::vector<std::vector<double>> samples(lambda, std::vector<double>(n));
+        std::vector<Candidate> batch(lambda);
+        for (int k = 0; k < lambda; k++) {
+            std::vector<double> z(n);
+            for (double& zi : z) zi = normal(rng);
+            for (std::size_t i = 0; i < n; i++) {
+                double y = 0;
+                for (std::size_t j = 0; j < n; j++) y += basis[i][j] * scale[j] * z[j];
+                samples[k][i] = mean[i] + sigma * y;
+            }
+            batch[k].values = to_values(samples[k]);
+        }
+        left -= lambda;
+        run_batch(batch);
+
+        // Out of the box samples ran clamped to it, charge them for how far out they were
+        std::vector<double> fitness(lambda);
+        for (int k = 0; k < lambda; k++) {
+            double outside = 0;
+            for (double u : samples[k]) outside += std::pow(std::max({0.0, -u, u - 1}), 2);
+            fitness[k] = batch[k].cost + 100 * outside;
+        }
+        std::vector<int> order(lambda);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return fitness[a] < fitness[b]; });
+
+        std::vector<double> old_mean = mean;
+        for (std::size_t i = 0; i < n; i++) {
+            mean[i] = 0;
+            for (int k = 0; k < mu; k++) mean[i] += weights[k] * samples[order[k]][i];
+        }
+
+        // Step in the whitened space: C^-1/2 (mean - old_mean) / sigma
+        std::vector<double> step(n), whitened(n, 0);
+        for (std::size_t i = 0; i < n; i++) step[i] = (mean[i] - old_mean[i]) / sigma;
+        for (std::size_t j = 0; j < n; j++) {
+            double projection = 0;
+            for (std::size_t i = 0; i < n; i++) projection += basis[i][j] * step[i];
+            projection /= scale[j];
+            for (std::size_t i = 0; i < n; i++) whitened[i] += basis[i][j] * projection;
+        }
+
+        double ps_norm = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            ps[i] = (1 - cs) * ps[i] + std::sqrt(cs * (2 - cs) * mueff) * whitened[i];
+            ps_norm += ps[i] * ps[i];
+        }
+        ps_norm = std::sqrt(ps_norm);
+        bool hsig = ps_norm / std::sqrt(1 - std::pow(1 - cs, 2.0 * (generation + 1))) / chi_n < 1.4 + 2.0 / (n + 1);
+        for (std::size_t i = 0; i < n; i++) {
+            pc[i] = (1 - cc) * pc[i] + (hsig ? std::sqrt(cc * (2 - cc) * mueff) : 0) * step[i];
+        }
+
+        for (std::size_t i = 0; i < n; i++) {
+            for (std::size_t j = 0; j <= i; j++) {
+                double rank_mu = 0;
+                for (int k = 0; k < mu; k++) {
+                    const std::vector<double>& x = samples[order[k]];
+                    rank_mu += weights[k] * (x[i] - old_mean[i]) / sigma * (x[j] - old_mean[j]) / sigma;
+                }
+                double rank_one = pc[i] * pc[j] + (hsig ? 0 : cc * (2 - cc) * cov[i][j]);
+                cov[i][j] = (1 - c1 - cmu) * cov[i][j] + c1 * rank_one + cmu * rank_mu;
+                cov[j][i] = cov[i][j];
+            }
+        }
+        sigma *= std::exp(cs / damps * (ps_norm / chi_n - 1));
+        sigma = std::min(sigma, 1.0);
+
+        std::vector<double> eigenvalues;
+        symmetric_eigen(cov, basis, eigenvalues);
+        for (std::size_t i = 0; i < n; i++) scale[i] = std::sqrt(std::max(eigenvalues[i], 1e-20));
+    }
+}
+
+// Runs each param at both ends of its range with the rest at their current
+// values, and warns about any that doesn't change the cost either way. That's
+// a param none of the spec's autons reach, searching it only adds noise.
+void warn_flat_params(const Candidate& baseline) {
+    std::vector<Candidate> probes;
+    for (std::size_t i = 0; i < spec.params.size(); i++) {
+        for (double end : {spec.params[i].low, spec.params[i].high}) {
+            Candidate probe{baseline.values, {}, INFINITY};
+            probe.values[i] = end;
+            probes.push_back(probe);
+        }
+    }
+    evaluate(probes);
+    runs_done += probes.size() * spec.autons.size();
+
+    for (std::size_t i = 0; i < spec.params.size(); i++) {
+        if (probes[2 * i].cost == baseline.cost && probes[2 * i + 1].cost == baseline.cost) {
+            const ParamRange& p = spec.params[i];
+            std::fprintf(stderr, "tune: warning: %s from %s to %s doesn't change the cost, do these autons use it?\n",
+                         p.name.c_str(), format_value(p.low).c_str(), format_value(p.high).c_str());
+        }
+    }
+}
+
+// --- Output ---
+
+void print_candidate(const char* label, const Candidate& c) {
+    std::printf("%-8s cost %7.3f ", label, c.cost);
+    for (std::size_t a = 0; a < spec.autons.size(); a++) {
+        const AutonTarget& target = spec.autons[a];
+        const SimResult& run = c.runs[a];
+        if (!run.ok) {
+            std::printf(" | auton %d: sim failed", target.auton);
+            continue;
+        }
+        std::printf(" | auton %d: ", target.auton);
+        if (run.finished) {
+            std::printf("%5.0f ms", run.time_ms);
+        } else {
+            std::printf("     DNF");
+        }
+        std::printf(" %5.2f in", std::hypot(run.x - target.x, run.y - target.y));
+        if (!std::isnan(target.heading)) std::printf(" %5.1f deg", heading_error_deg(target.heading, run.theta));
+    }
+    std::printf("\n        ");
+    for (std::size_t i = 0; i < spec.params.size(); i++) {
+        std::printf(" %s=%s", spec.params[i].name.c_str(), format_value(c.values[i]).c_str());
+    }
+    std::printf("\n");
+}
+
+void write_header(const Candidate& best, const Candidate& baseline) {
+    FILE* out = std::fopen(options.out_path.c_str(), "w");
+    if (out == nullptr) fail("can't write " + options.out_path);
+
+    std::fprintf(out, "// Generated by tools/tune.cpp from %s, don't edit.\n", options.spec_path.c_str());
+    std::fprintf(out, "// Best of %zu candidates (%zu simulated runs): cost %.3f, was %.3f.\n", all_candidates.size(),
+                 runs_done, best.cost, baseline.cost);
+    for (std::size_t a = 0; a < spec.autons.size(); a++) {
+        const AutonTarget& target = spec.autons[a];
+        const SimResult& run = best.runs[a];
+        std::fprintf(out, "//   auton %d: %s, %.2f in from (%g, %g)\n", target.auton,
+                     run.finished ? (std::to_string(int(run.time_ms)) + " ms").c_str() : "did not finish",
+                     std::hypot(run.x - target.x, run.y - target.y), target.x, target.y);
+    }
+    for (const std::string& fixed : spec.fixed) std::fprintf(out, "// With %s\n", fixed.c_str());
+    std::fprintf(out, "// Include it once and call apply_tuned_params() at the top of initialize().\n\n");
+
+    std::fprintf(out, "#ifndef TUNED_PARAMS_HPP\n#define TUNED_PARAMS_HPP\n\n");
+    std::fprintf(out, "#include \"motion.hpp\"\n#include \"motion_profile.hpp\"\n");
+    std::fprintf(out, "#include \"pure_pursuit.hpp\"\n#include \"ramsete.hpp\"\n\n");
+    std::fprintf(out, "inline void apply_tuned_params() {\n");
+    for (std::size_t i = 0; i < spec.params.size(); i++) {
+        std::fprintf(out, "    %s = %s;  // was %s\n", spec.params[i].name.c_str(), format_value(best.values[i]).c_str(),
+                     format_value(spec.params[i].current).c_str());
+    }
+    std::fprintf(out, "}\n\n#endif\n");
+    std::fclose(out);
+}
+
+// The values the robot code has now, and a check that the sim knows every name
+void read_current_values() {
+    std::string output;
+    if (!run_process({options.sim_path, "--list-params"}, output)) fail("can't run " + options.sim_path);
+    std::map<std::string, double> current;
+    std::istringstream lines(output);
+    std::string name;
+    double value;
+    while (lines >> name >> value) current[name] = value;
+
+    for (ParamRange& p : spec.params) {
+        if (!current.count(p.name)) fail("the simulator has no parameter " + p.name + ", see sim --list-params");
+        p.current = current[p.name];
+    }
+    for (const std::string& fixed : spec.fixed) {
+        std::string fixed_name = fixed.substr(0, fixed.find('='));
+        if (!current.count(fixed_name)) fail("the simulator has no parameter " + fixed_name);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--sim" && i + 1 < argc) {
+            options.sim_path = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.out_path = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            fail("usage: tune [-j threads] [--sim path] [-o header] <spec.tune>");
+        } else {
+            options.spec_path = arg;
+        }
+    }
+    if (options.spec_path.empty()) fail("usage: tune [-j threads] [--sim path] [-o header] <spec.tune>");
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (options.sim_path.empty()) options.sim_path = default_sim_path();
+
+    spec = parse(options.spec_path);
+    read_current_values();
+    start_time = std::chrono::steady_clock::now();
+
+    // What the robot code does now, to compare against
+    std::vector<Candidate> baseline(1);
+    for (const ParamRange& p : spec.params) baseline[0].values.push_back(p.current);
+    evaluate(baseline);
+    runs_done += spec.autons.size();
+    warn_flat_params(baseline[0]);
+
+    std::mt19937 rng(spec.seed);
+    if (spec.search == "grid") {
+        grid_search();
+    } else if (spec.search == "random") {
+        random_search(rng);
+    } else {
+        cmaes_search(rng);
+    }
+    std::fprintf(stderr, "\n");
+
+    std::vector<const Candidate*> ranked;
+    for (const Candidate& c : all_candidates) ranked.push_back(&c);
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const Candidate* a, const Candidate* b) { return a->cost < b->cost; });
+    if (ranked.empty() || std::isinf(ranked[0]->cost)) fail("no candidate ran, is the simulator working?");
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::printf("%zu candidates, %zu sim runs in %.1f s on %u threads\n\n", all_candidates.size(), runs_done, elapsed,
+                options.threads);
+    print_candidate("now", baseline[0]);
+    for (std::size_t i = 0; i < std::min<std::size_t>(10, ranked.size()); i++) {
+        print_candidate(("#" + std::to_string(i + 1)).c_str(), *ranked[i]);
+    }
+
+    if (ranked[0]->cost < baseline[0].cost) {
+        write_header(*ranked[0], baseline[0]);
+        std::printf("\nwrote %s\n", options.out_path.c_str());
+    } else {
+        std::printf("\nnothing beat the current values, %s not written\n", options.out_path.c_str());
+    }
+    return 0;
+}